@@ -0,0 +1,332 @@
+/**
+ * @file codec_bench.cpp
+ * @brief Microbenchmarks and regression check for the RESP codec hot paths.
+ *
+ * Each case reports ns/op, allocated bytes/op and allocations/op. Counts
+ * come from the global operator new replaced below, so they cover every
+ * allocation made by the code under test.
+ *
+ * Usage:
+ *   bench [--filter <substr>] [--min-time <ms>]
+ *         [--baseline <file> [--threshold <percent>]]
+ *         [--write-baseline <file>]
+ *
+ * With --baseline the run fails (exit 1) if any case is slower than its
+ * baseline by more than the threshold (default 25%), or allocates more.
+ */
+
+#include <fcntl.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <new>
+
+#include "include/render.hpp"
+#include "include/resp_tree.hpp"
+#include "include/resp.hpp"
+#include "include/resp_reader.hpp"
+#include "include/resp_scan.hpp"
+#include "include/utils.hpp"
+
+// --------------------------------------------------
+// @INFO Allocation accounting
+// --------------------------------------------------
+
+static std::atomic<uint64_t> g_allocations(0);
+static std::atomic<uint64_t> g_allocated_bytes(0);
+
+void* operator new(size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+namespace {
+
+/** @brief Keeps the compiler from discarding a benchmark result. */
+template <typename T>
+void keep(T&& value) {
+  asm volatile("" : : "g"(&value) : "memory");
+}
+
+/** @brief Measurement of one case. */
+struct Result {
+  double nsPerOp;
+  double bytesPerOp;
+  double allocsPerOp;
+};
+
+/** @brief A named operation to measure. */
+struct Case {
+  std::string name;
+  std::function<void()> body;
+};
+
+/** @brief Run `iterations` calls and return per-op figures. */
+Result run(const Case& c, uint64_t iterations, std::chrono::nanoseconds& elapsed) {
+  uint64_t allocs_before = g_allocations.load();
+  uint64_t bytes_before = g_allocated_bytes.load();
+  auto start = std::chrono::steady_clock::now();
+
+  for (uint64_t i = 0; i < iterations; ++i) c.body();
+
+  elapsed = std::chrono::steady_clock::now() - start;
+  double ops = static_cast<double>(iterations);
+  return {static_cast<double>(elapsed.count()) / ops, (g_allocated_bytes.load() - bytes_before) / ops, (g_allocations.load() - allocs_before) / ops};
+}
+
+/**
+ * @brief Time a case.
+ *
+ * Doubles the iteration count until one run takes min_time, then keeps the
+ * fastest of three runs at that count to damp scheduler noise.
+ */
+Result measure(const Case& c, std::chrono::milliseconds min_time) {
+  c.body();  // warm up caches and lazily built state
+
+  uint64_t iterations = 1;
+  std::chrono::nanoseconds elapsed;
+  Result best = run(c, iterations, elapsed);
+  while (elapsed < min_time && iterations < (1ULL << 30)) {
+    iterations *= 2;
+    best = run(c, iterations, elapsed);
+  }
+
+  for (int repeat = 0; repeat < 2; ++repeat) {
+    Result again = run(c, iterations, elapsed);
+    if (again.nsPerOp < best.nsPerOp) best = again;
+  }
+  return best;
+}
+
+/** @brief Builds a whitespace-separated line of `count` short words. */
+std::string words(size_t count) {
+  std::string line = "MSET";
+  for (size_t i = 0; i < count; ++i) line += " key" + std::to_string(i);
+  return line;
+}
+
+/** @brief Builds a `[a, b, ...]` array literal with `count` elements. */
+std::string array_literal(size_t count) {
+  std::string literal = "[";
+  for (size_t i = 0; i < count; ++i) literal += (i ? ", item" : "item") + std::to_string(i);
+  return literal + "]";
+}
+
+/** @brief Builds a RESP array reply of `count` bulk strings. */
+std::string array_reply(size_t count) {
+  std::vector<std::string> elements;
+  for (size_t i = 0; i < count; ++i) elements.push_back("value:" + std::to_string(i));
+  return resp::encode_array(elements);
+}
+
+/** @brief All benchmark cases; payloads are built once, outside the timing. */
+std::vector<Case> make_cases() {
+  static const std::string small_line = "SET user:1000 hello";
+  static const std::string mb_value(1 << 20, 'v');
+  static const std::string mb_line = "SET blob " + mb_value;
+  static const std::string wide_line = words(10000);
+  static const std::string small_array = "[1, 2, \"three\"]";
+  static const std::string wide_array = array_literal(10000);
+  static const std::vector<std::string> small_args = {"user:1000", "hello"};
+  static const std::vector<std::string> mb_args = {"blob", mb_value};
+  static const std::vector<std::string> wide_args = cmd::split(wide_line.substr(5), ' ');
+  static const std::string ok_reply = "+OK\r\n";
+  static const std::string mb_reply = resp::encode_bulk_string(mb_value);
+  static const std::string wide_reply = array_reply(10000);
+  static const std::string pipelined = [] {
+    std::string replies;
+    for (int i = 0; i < 1000; ++i) replies += ":" + std::to_string(i) + "\r\n";
+    return replies;
+  }();
+
+  std::vector<Case> cases;
+  auto add = [&](const std::string& name, std::function<void()> body) { cases.push_back({name, std::move(body)}); };
+
+  add("encode/small", [] { keep(resp::encode(small_line)); });
+  add("encode/1mb", [] { keep(resp::encode(mb_line)); });
+  add("encode/10k-words", [] { keep(resp::encode(wide_line)); });
+  add("encode/10k-array", [] { keep(resp::encode("RPUSH list " + wide_array)); });
+  add("append_encoded/small-reused", [] {
+    static std::string out;
+    out.clear();
+    resp::append_encoded(out, small_line);
+    keep(out);
+  });
+
+  add("encode_command/small", [] { keep(resp::encode_command("SET", small_args)); });
+  add("encode_command/1mb", [] { keep(resp::encode_command("SET", mb_args)); });
+  add("encode_command/10k-args", [] { keep(resp::encode_command("MSET", wide_args)); });
+
+  add("tokenize/small", [] { keep(resp::tokenize(small_line)); });
+  add("tokenize/1mb", [] { keep(resp::tokenize(mb_line)); });
+  add("tokenize/10k-words", [] { keep(resp::tokenize(wide_line)); });
+
+  add("parse_array/small", [] { keep(resp::parse_array(small_array)); });
+  add("parse_array/10k", [] { keep(resp::parse_array(wide_array)); });
+
+  add("decode/simple", [] { keep(resp::decode(ok_reply)); });
+  add("decode/1mb-bulk", [] { keep(resp::decode(mb_reply)); });
+  add("decode_array/10k", [] { keep(resp::decode_array(wide_reply)); });
+
+  // Rendering into a sink on /dev/null; the decode cases above build a string instead.
+  static resp::OutputSink null_sink(open("/dev/null", O_WRONLY));
+  static resp::Renderer human(null_sink, resp::Format::HUMAN);
+  static resp::Renderer json(null_sink, resp::Format::JSON);
+  static resp::Renderer csv(null_sink, resp::Format::CSV);
+  add("render/simple", [] { human.render(ok_reply); });
+  add("render/1mb-bulk", [] { human.render(mb_reply); });
+  add("render/10k-array", [] { human.render(wide_reply); });
+  add("render_json/10k-array", [] { json.render(wide_reply); });
+  add("render_csv/10k-array", [] { csv.render(wide_reply); });
+
+  // SAX walk and a reused arena tree; neither should allocate once warm.
+  add("visit/10k-array", [] {
+    struct Counter : resp::Visitor {
+      size_t bytes = 0;
+      void onString(resp::Type, std::string_view value) { bytes += value.size(); }
+    } counter;
+    size_t length = 0;
+    resp::visit(wide_reply, counter, length);
+    keep(counter.bytes);
+  });
+  add("document/10k-array", [] {
+    static resp::Document document;
+    document.parse(wide_reply);
+    keep(document.root().count);
+  });
+
+  add("reader/1k-pipelined", [] {
+    static resp::Reader reader;
+    reader.feed(pipelined.data(), pipelined.size());
+    std::string_view frame;
+    while (reader.next(frame) == resp::Reader::Status::COMPLETE) keep(frame);
+  });
+  add("reader/10k-array", [] {
+    static resp::Reader reader;
+    reader.feed(wide_reply.data(), wide_reply.size());
+    std::string_view frame;
+    while (reader.next(frame) == resp::Reader::Status::COMPLETE) keep(frame);
+  });
+
+  add("command_to_lowercase/small", [] {
+    std::string input = small_line;
+    keep(cmd::command_to_lowercase(input));
+  });
+  add("command_to_lowercase/10k-words", [] {
+    std::string input = wide_line;
+    keep(cmd::command_to_lowercase(input));
+  });
+
+  return cases;
+}
+
+/** @brief Reads `name ns_per_op allocs_per_op` lines. */
+std::map<std::string, Result> load_baseline(const std::string& path) {
+  std::map<std::string, Result> baseline;
+  std::ifstream file(path);
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream iss(line);
+    std::string name;
+    Result result{};
+    if (iss >> name >> result.nsPerOp >> result.bytesPerOp >> result.allocsPerOp) baseline[name] = result;
+  }
+  return baseline;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::string filter;
+  std::string baseline_path;
+  std::string write_path;
+  double threshold = 25.0;
+  std::chrono::milliseconds min_time(200);
+
+  for (int arg = 1; arg < argc; ++arg) {
+    std::string flag = argv[arg];
+    if (arg + 1 >= argc) {
+      std::cerr << "Missing value after " << flag << std::endl;
+      return 2;
+    }
+    if (flag == "--filter") {
+      filter = argv[++arg];
+    } else if (flag == "--baseline") {
+      baseline_path = argv[++arg];
+    } else if (flag == "--write-baseline") {
+      write_path = argv[++arg];
+    } else if (flag == "--threshold") {
+      threshold = std::atof(argv[++arg]);
+    } else if (flag == "--min-time") {
+      min_time = std::chrono::milliseconds(std::atoi(argv[++arg]));
+    } else {
+      std::cerr << "Unknown flag " << flag << std::endl;
+      return 2;
+    }
+  }
+
+  std::map<std::string, Result> baseline;
+  if (!baseline_path.empty()) {
+    baseline = load_baseline(baseline_path);
+    if (baseline.empty()) {
+      std::cerr << "No baseline entries in " << baseline_path << std::endl;
+      return 2;
+    }
+  }
+
+  std::ofstream out;
+  if (!write_path.empty()) {
+    out.open(write_path);
+    out << "# name ns/op bytes/op allocs/op (regenerate with: bench --write-baseline bench/baseline.txt)\n";
+  }
+
+  std::cout << "crlf kernel: " << resp::scan_kernel() << '\n';
+  std::cout << std::left << std::setw(34) << "case" << std::right << std::setw(14) << "ns/op" << std::setw(14) << "bytes/op" << std::setw(12)
+            << "allocs/op" << std::setw(10) << "vs base" << '\n';
+
+  int regressions = 0;
+  for (const Case& c : make_cases()) {
+    if (!filter.empty() && c.name.find(filter) == std::string::npos) continue;
+
+    Result result = measure(c, min_time);
+    std::cout << std::left << std::setw(34) << c.name << std::right << std::fixed << std::setprecision(1) << std::setw(14) << result.nsPerOp
+              << std::setw(14) << result.bytesPerOp << std::setw(12) << result.allocsPerOp;
+
+    auto base = baseline.find(c.name);
+    if (base != baseline.end()) {
+      double change = (result.nsPerOp / base->second.nsPerOp - 1.0) * 100.0;
+      bool slower = change > threshold;
+      bool more_allocs = result.allocsPerOp > base->second.allocsPerOp + 0.5;
+      std::cout << std::setw(9) << std::showpos << change << std::noshowpos << '%';
+      if (slower || more_allocs) {
+        std::cout << (slower ? "  REGRESSION (time)" : "  REGRESSION (allocs)");
+        ++regressions;
+      }
+    }
+    std::cout << '\n';
+
+    if (out.is_open()) out << c.name << ' ' << result.nsPerOp << ' ' << result.bytesPerOp << ' ' << result.allocsPerOp << '\n';
+  }
+
+  if (regressions > 0) {
+    std::cout << regressions << " case(s) regressed past " << threshold << "%" << std::endl;
+    return 1;
+  }
+  return 0;
+}
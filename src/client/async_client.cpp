@@ -0,0 +1,561 @@
+/**
+ * @file async_client.cpp
+ * @brief KvEventLoop and KvAsyncClient method implementations.
+ */
+
+#include "include/async_client.hpp"
+
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include <algorithm>
+
+#include "include/dial.hpp"
+#include "include/logger.hpp"
+#include "include/resp.hpp"
+
+// --------------------------------------------------
+// @INFO KvEventLoop
+// --------------------------------------------------
+
+// Constructor
+KvEventLoop::KvEventLoop() : epollFd(epoll_create1(EPOLL_CLOEXEC)), wakeFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)), running(false) {
+  if (epollFd < 0 || wakeFd < 0) {
+    Logger::error("Event loop setup failed: " + std::string(strerror(errno)));
+    return;
+  }
+
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.ptr = nullptr;  // null marks the wake-up eventfd
+  epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+}
+
+// Destructor
+KvEventLoop::~KvEventLoop() {
+  stop();
+  if (wakeFd >= 0) close(wakeFd);
+  if (epollFd >= 0) close(epollFd);
+}
+
+/**
+ * @brief Run the loop on the calling thread until stop() is called.
+ *
+ * Each iteration dispatches socket events, expires overdue connects, runs
+ * posted tasks and then writes the output queued by those events and tasks
+ * in one go per client.
+ */
+void KvEventLoop::run() {
+  loopThread = std::this_thread::get_id();
+  running = true;
+
+  epoll_event events[256];
+  while (running) {
+    int count = epoll_wait(epollFd, events, 256, waitTimeout());
+    if (count < 0) {
+      if (errno == EINTR) continue;
+      Logger::error("epoll_wait failed: " + std::string(strerror(errno)));
+      break;
+    }
+
+    for (int i = 0; i < count; ++i) {
+      if (events[i].data.ptr == nullptr) {
+        uint64_t value;
+        while (read(wakeFd, &value, sizeof(value)) > 0) {
+        }
+      } else {
+        static_cast<KvAsyncClient*>(events[i].data.ptr)->handleEvents(events[i].events);
+      }
+    }
+    expireConnects();
+
+    std::vector<std::function<void()>> batch;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      batch.swap(tasks);
+    }
+    for (auto& task : batch) task();
+
+    std::vector<KvAsyncClient*> flushing;
+    flushing.swap(dirty);
+    for (KvAsyncClient* client : flushing) {
+      client->flushQueued = false;
+      client->flush();
+    }
+  }
+
+  loopThread = std::thread::id();
+}
+
+/** @brief Run the loop on a background thread. */
+void KvEventLoop::start() {
+  running = true;
+  thread = std::thread(&KvEventLoop::run, this);
+}
+
+/** @brief Ask the loop to exit and join its background thread. */
+void KvEventLoop::stop() {
+  post([this] { running = false; });
+  if (thread.joinable() && thread.get_id() != std::this_thread::get_id()) {
+    thread.join();
+  }
+}
+
+/**
+ * @brief Queue work for the loop thread and wake it up.
+ *
+ * @param task Work to run on the loop thread.
+ */
+void KvEventLoop::post(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    tasks.push_back(std::move(task));
+  }
+  uint64_t one = 1;
+  ssize_t ignored = write(wakeFd, &one, sizeof(one));
+  (void)ignored;
+}
+
+/** @brief True when called from inside run(). */
+bool KvEventLoop::inLoopThread() const {
+  return loopThread.load() == std::this_thread::get_id();
+}
+
+/** @brief Add or update the epoll registration of a client socket. */
+bool KvEventLoop::watch(int fd, uint32_t events, KvAsyncClient* client, bool add) {
+  epoll_event event{};
+  event.events = events;
+  event.data.ptr = client;
+  return epoll_ctl(epollFd, add ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, fd, &event) == 0;
+}
+
+/** @brief Remove a socket from epoll. */
+void KvEventLoop::unwatch(int fd) {
+  epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+/** @brief Schedule a client's output to be written after this iteration. */
+void KvEventLoop::markDirty(KvAsyncClient* client) {
+  if (client->flushQueued) return;
+  client->flushQueued = true;
+  dirty.push_back(client);
+}
+
+/** @brief Drop a closed client from the dirty list. */
+void KvEventLoop::forget(KvAsyncClient* client) {
+  for (auto& entry : dirty) {
+    if (entry == client) entry = nullptr;
+  }
+  dirty.erase(std::remove(dirty.begin(), dirty.end(), nullptr), dirty.end());
+  client->flushQueued = false;
+  timed.erase(std::remove(timed.begin(), timed.end(), client), timed.end());
+}
+
+/** @brief Milliseconds until the earliest connect deadline, or -1 for none. */
+int KvEventLoop::waitTimeout() const {
+  if (timed.empty()) return -1;
+
+  auto earliest = std::chrono::steady_clock::time_point::max();
+  for (const KvAsyncClient* client : timed) earliest = std::min(earliest, client->attemptDeadline);
+  auto left = std::chrono::ceil<std::chrono::milliseconds>(earliest - std::chrono::steady_clock::now());
+  return static_cast<int>(std::clamp<long long>(left.count(), 0, INT32_MAX));
+}
+
+/** @brief Move connects past their deadline on to the next address, or fail them. */
+void KvEventLoop::expireConnects() {
+  if (timed.empty()) return;
+
+  auto now = std::chrono::steady_clock::now();
+  std::vector<KvAsyncClient*> overdue;
+  for (KvAsyncClient* client : timed) {
+    if (client->state == KvAsyncClient::State::CONNECTING && client->attemptDeadline <= now) overdue.push_back(client);
+  }
+  // Connected clients no longer need the timer
+  timed.erase(std::remove_if(timed.begin(), timed.end(), [](const KvAsyncClient* c) { return c->state != KvAsyncClient::State::CONNECTING; }), timed.end());
+
+  for (KvAsyncClient* client : overdue) {
+    // An earlier callback in this batch may have closed it
+    if (std::find(timed.begin(), timed.end(), client) == timed.end() || client->state != KvAsyncClient::State::CONNECTING) continue;
+    client->connectNext("Connection to " + client->addresses[client->nextAddress - 1].text() + " timed out");
+  }
+}
+
+// --------------------------------------------------
+// @INFO KvAsyncClient
+// --------------------------------------------------
+
+// Constructor
+KvAsyncClient::KvAsyncClient(KvEventLoop& loop, const KvConnectionInfo& info)
+    : loop(loop), info(info), fd(-1), state(State::IDLE), wantWrite(false), flushQueued(false), written(0), outstanding(0), nextAddress(0) {}
+
+// Destructor
+KvAsyncClient::~KvAsyncClient() {
+  close();
+}
+
+/**
+ * @brief Run a task on the loop thread.
+ *
+ * Runs inline when already on the loop thread, otherwise posts it.
+ */
+void KvAsyncClient::dispatch(std::function<void()> task) {
+  if (loop.inLoopThread()) {
+    task();
+  } else {
+    loop.post(std::move(task));
+  }
+}
+
+/**
+ * @brief Start a non-blocking connect (and AUTH, if credentials are set).
+ *
+ * @param done Called on the loop thread with true once the connection is
+ *             ready for commands, or false if it failed.
+ */
+void KvAsyncClient::connect(std::function<void(bool)> done) {
+  dispatch([this, done] {
+    onConnect = done;
+    startConnect();
+  });
+}
+
+/** @brief Future form of connect(). */
+std::future<bool> KvAsyncClient::connect() {
+  auto promise = std::make_shared<std::promise<bool>>();
+  std::future<bool> future = promise->get_future();
+  connect([promise](bool ok) { promise->set_value(ok); });
+  return future;
+}
+
+/**
+ * @brief Close the socket and fail every outstanding command.
+ *
+ * Waits for the loop thread when called from another thread while the
+ * loop is running.
+ */
+void KvAsyncClient::close() {
+  bool loop_elsewhere = loop.loopThread.load() != std::thread::id() && !loop.inLoopThread();
+  if (!loop_elsewhere) {
+    fail("Connection closed", false);
+    return;
+  }
+
+  std::promise<void> closed;
+  loop.post([this, &closed] {
+    fail("Connection closed", false);
+    closed.set_value();
+  });
+  closed.get_future().wait();
+}
+
+/**
+ * @brief Queue a RESP-encoded command.
+ *
+ * @param command  Encoded command (see resp::encode).
+ * @param callback Called on the loop thread with the reply.
+ */
+void KvAsyncClient::send(std::string command, Callback callback) {
+  ++outstanding;
+  if (loop.inLoopThread()) {
+    enqueue(std::move(command), std::move(callback));
+  } else {
+    auto task = std::make_shared<std::pair<std::string, Callback>>(std::move(command), std::move(callback));
+    loop.post([this, task] { enqueue(std::move(task->first), std::move(task->second)); });
+  }
+}
+
+/**
+ * @brief Future form of send().
+ *
+ * @return Future holding the raw reply; throws std::runtime_error from
+ *         get() if the connection failed.
+ */
+std::future<std::string> KvAsyncClient::send(std::string command) {
+  auto promise = std::make_shared<std::promise<std::string>>();
+  std::future<std::string> future = promise->get_future();
+  send(std::move(command), [promise](bool ok, std::string_view reply) {
+    if (ok) {
+      promise->set_value(std::string(reply));
+    } else {
+      promise->set_exception(std::make_exception_ptr(std::runtime_error(std::string(reply))));
+    }
+  });
+  return future;
+}
+
+/** @brief Commands sent or queued that have not completed yet. */
+size_t KvAsyncClient::pending() const {
+  return outstanding.load();
+}
+
+/** @brief Append a command to the outbox (loop thread). */
+void KvAsyncClient::enqueue(std::string command, Callback callback) {
+  if (state == State::IDLE || state == State::CLOSED) {
+    --outstanding;
+    callback(false, "Not connected to server");
+    return;
+  }
+
+  outbox += command;
+  waiting.push_back(std::move(callback));
+  loop.markDirty(this);
+}
+
+/**
+ * @brief Resolve the server and begin connecting (loop thread).
+ *
+ * The resolved addresses are tried one after another, like network::dial
+ * but without racing them. KvConnectionInfo::connectTimeout bounds the
+ * whole connect; each attempt gets an even share of the time left, so a
+ * blackholed first address leaves time for the others.
+ */
+void KvAsyncClient::startConnect() {
+  if (fd >= 0) return;
+
+  addresses.clear();
+  std::string error;
+  bool resolved;
+  if (info.socketPath.empty()) {
+    resolved = network::resolve(info.host, info.port, addresses, error);
+  } else {
+    addresses.resize(1);
+    resolved = network::unix_address(info.socketPath, addresses.front(), error);
+  }
+  state = State::CONNECTING;  // lets fail() report errors through onConnect
+  if (!resolved) {
+    fail(error);
+    return;
+  }
+
+  reader.reset();
+  outbox.clear();
+  written = 0;
+  nextAddress = 0;
+  connectDeadline = std::chrono::steady_clock::time_point::max();
+  if (info.connectTimeout.count() > 0) {
+    connectDeadline = std::chrono::steady_clock::now() + info.connectTimeout;
+    loop.timed.push_back(this);
+  }
+  connectNext("No address to connect to");
+}
+
+/**
+ * @brief Drop the current attempt, if any, and start the next address.
+ *
+ * @param reason Why the previous attempt ended; reported if none is left.
+ */
+void KvAsyncClient::connectNext(const std::string& reason) {
+  if (fd >= 0) {
+    loop.unwatch(fd);
+    ::close(fd);
+    fd = -1;
+    wantWrite = false;
+  }
+
+  std::string last_error = reason;
+  while (nextAddress < addresses.size()) {
+    const KvAddress& address = addresses[nextAddress++];
+    fd = socket(address.family(), SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+      last_error = "Socket creation failed: " + std::string(strerror(errno));
+      continue;
+    }
+
+    if (address.family() != AF_UNIX) {
+      int one = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+
+    if (::connect(fd, reinterpret_cast<const struct sockaddr*>(&address.storage), address.length) < 0 && errno != EINPROGRESS) {
+      last_error = "Connection to " + address.text() + " failed: " + std::string(strerror(errno));
+      ::close(fd);
+      fd = -1;
+      continue;
+    }
+
+    attemptDeadline = connectDeadline;
+    if (connectDeadline != std::chrono::steady_clock::time_point::max()) {
+      auto now = std::chrono::steady_clock::now();
+      attemptDeadline = now + std::max(connectDeadline - now, std::chrono::steady_clock::duration::zero()) /
+                                  static_cast<int>(addresses.size() - nextAddress + 1);
+    }
+    wantWrite = true;
+    loop.watch(fd, EPOLLIN | EPOLLOUT, this, true);
+    return;
+  }
+
+  fail(last_error);
+}
+
+/** @brief Complete the TCP handshake and send AUTH first if needed. */
+void KvAsyncClient::finishConnect() {
+  int error = 0;
+  socklen_t len = sizeof(error);
+  if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len) < 0 || error != 0) {
+    connectNext("Connection to " + addresses[nextAddress - 1].text() + " failed: " + std::string(strerror(error != 0 ? error : errno)));
+    return;
+  }
+
+  if (info.user.empty() && info.password.empty()) {
+    state = State::READY;
+    if (onConnect) {
+      auto done = std::move(onConnect);
+      onConnect = nullptr;
+      done(true);
+    }
+  } else {
+    // AUTH must precede anything queued while the handshake was running.
+    state = State::AUTHENTICATING;
+    ++outstanding;
+    outbox.insert(0, resp::encode_command("AUTH", {info.user, info.password}));
+    waiting.push_front([this](bool ok, std::string_view reply) {
+      if (!ok) return;
+      if (reply != resp::encode_simple_string("OK")) {
+        fail("Authentication failed: " + resp::decode(reply));
+        return;
+      }
+      state = State::READY;
+      if (onConnect) {
+        auto done = std::move(onConnect);
+        onConnect = nullptr;
+        done(true);
+      }
+    });
+  }
+
+  flush();
+}
+
+/** @brief React to epoll readiness (loop thread). */
+void KvAsyncClient::handleEvents(uint32_t events) {
+  if (state == State::CONNECTING) {
+    if (events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) finishConnect();
+    return;
+  }
+
+  if (events & EPOLLIN) {
+    readReplies();
+    if (state == State::CLOSED) return;
+  }
+  if (events & EPOLLOUT) {
+    flush();
+    if (state == State::CLOSED) return;
+  }
+  if ((events & (EPOLLERR | EPOLLHUP)) && !(events & EPOLLIN)) {
+    fail("Connection error");
+  }
+}
+
+/**
+ * @brief Write as much of the outbox as the socket accepts.
+ *
+ * Registers for EPOLLOUT while output remains and drops the registration
+ * once everything is written.
+ */
+void KvAsyncClient::flush() {
+  if (state != State::AUTHENTICATING && state != State::READY) return;
+
+  while (written < outbox.size()) {
+    ssize_t sent = ::send(fd, outbox.data() + written, outbox.size() - written, MSG_NOSIGNAL);
+    if (sent < 0) {
+      if (errno == EINTR) continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        if (written > outbox.size() / 2) {
+          outbox.erase(0, written);
+          written = 0;
+        }
+        if (!wantWrite) {
+          wantWrite = true;
+          loop.watch(fd, EPOLLIN | EPOLLOUT, this, false);
+        }
+        return;
+      }
+      fail("Error sending command: " + std::string(strerror(errno)));
+      return;
+    }
+    written += static_cast<size_t>(sent);
+  }
+
+  outbox.clear();
+  written = 0;
+  if (wantWrite) {
+    wantWrite = false;
+    loop.watch(fd, EPOLLIN, this, false);
+  }
+}
+
+/** @brief Drain the socket and complete callbacks in order (loop thread). */
+void KvAsyncClient::readReplies() {
+  while (true) {
+    ssize_t received = recv(fd, reader.prepare(16384), 16384, 0);
+    if (received < 0) {
+      if (errno == EINTR) continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+      fail("Error receiving response: " + std::string(strerror(errno)));
+      return;
+    }
+    if (received == 0) {
+      fail("Connection closed by server");
+      return;
+    }
+    reader.commit(static_cast<size_t>(received));
+
+    std::string_view frame;
+    resp::Reader::Status status;
+    while ((status = reader.next(frame)) == resp::Reader::Status::COMPLETE) {
+      if (waiting.empty()) {
+        fail("Unexpected reply from server");
+        return;
+      }
+      Callback callback = std::move(waiting.front());
+      waiting.pop_front();
+      --outstanding;
+      callback(true, frame);
+      if (state == State::CLOSED) return;
+    }
+    if (status == resp::Reader::Status::PROTOCOL_ERROR) {
+      fail("Protocol error: invalid RESP frame from server");
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Close the socket and fail connect() and every queued command.
+ *
+ * @param reason Message passed to the failed callbacks.
+ * @param report Log the reason as an error.
+ */
+void KvAsyncClient::fail(const std::string& reason, bool report) {
+  if (state == State::IDLE || state == State::CLOSED) {
+    state = State::CLOSED;
+    return;
+  }
+  state = State::CLOSED;
+
+  if (fd >= 0) {
+    loop.unwatch(fd);
+    ::close(fd);
+    fd = -1;
+  }
+  loop.forget(this);
+  outbox.clear();
+  written = 0;
+  wantWrite = false;
+
+  if (report) Logger::error(reason);
+
+  std::deque<Callback> failed;
+  failed.swap(waiting);
+  outstanding -= failed.size();
+
+  if (onConnect) {
+    auto done = std::move(onConnect);
+    onConnect = nullptr;
+    done(false);
+  }
+  for (Callback& callback : failed) {
+    callback(false, reason);
+  }
+}
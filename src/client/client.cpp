@@ -5,11 +5,174 @@
 
 #include "include/client.hpp"
 
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <atomic>
+#include <cctype>
+#include <climits>
+#include <memory>
+#include <thread>
+
+#include "include/capture.hpp"
+#include "include/dial.hpp"
 #include "include/logger.hpp"
+#include "include/metrics.hpp"
+#include "include/resp.hpp"
+#include "include/resp_scan.hpp"
 #include "include/utils.hpp"
 
+namespace {
+
+/** @brief Source of capture connection ids. */
+std::atomic<uint32_t> g_next_capture_id(1);
+
+/** @brief Case-insensitive match of a command name against an upper-case one. */
+bool is_command(std::string_view name, std::string_view upper) {
+  if (name.size() != upper.size()) return false;
+  for (size_t i = 0; i < name.size(); ++i) {
+    if (std::toupper(static_cast<unsigned char>(name[i])) != upper[i]) return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Record a send, leaving out the credentials of a leading AUTH.
+ *
+ * Only the first command of a batch is checked, which covers the AUTH the
+ * client sends itself; AUTH lines inside piped input are recorded as sent.
+ */
+void capture_sent(KvCapture& capture, uint32_t connection, std::string_view command) {
+  std::string_view name = resp::command_name(command);
+  size_t length = 0;
+  if (name.size() == 4 && strncasecmp(name.data(), "auth", 4) == 0 && resp::scan_frame(command, length) == resp::Reader::Status::COMPLETE) {
+    capture.record(connection, capture::Direction::SENT, capture::REDACTED_AUTH);
+    command.remove_prefix(length);
+  }
+  capture.record(connection, capture::Direction::SENT, command);
+}
+
+/** @brief Largest step of a streamed body, and the relay pipe size asked for. */
+constexpr size_t STREAM_STEP = 1024 * 1024;
+
+/** @brief Write all of `size` bytes, retrying on EINTR. */
+bool write_all(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    ssize_t n = ::write(fd, data, size);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    data += n;
+    size -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+/**
+ * @class BodyCopier
+ * @brief Moves a bulk body from a socket to a descriptor.
+ *
+ * splice(2) is used while the kernel supports it for the pair: straight
+ * into the destination if that is a pipe, otherwise through a relay pipe.
+ * The body then never enters user space. Destinations splice cannot write
+ * to (terminals, O_APPEND files) fall back to recv(2) and write(2) through
+ * one chunk buffer, so memory use stays bounded either way.
+ */
+class BodyCopier {
+ public:
+  /** @brief Outcome of one copy() step. */
+  enum class Result { OK, CLOSED, READ_ERROR, WRITE_ERROR };
+
+ private:
+  int socket;                   /**< Source */
+  int out;                      /**< Destination */
+  bool direct;                  /**< Destination is a pipe: no relay needed */
+  bool splicing;                /**< splice(2) still usable */
+  int relay[2];                 /**< Relay pipe (-1 until first needed) */
+  std::unique_ptr<char[]> chunk; /**< Fallback buffer, allocated on first use */
+
+  /** @brief Empty the relay into `out`, by read/write if splice refuses. */
+  Result drain(size_t n) {
+    while (n > 0) {
+      ssize_t w = splicing ? splice(relay[0], nullptr, out, nullptr, n, SPLICE_F_MOVE | SPLICE_F_MORE) : -1;
+      if (w < 0 && errno == EINTR) continue;
+      if (w < 0 && (!splicing || errno == EINVAL)) {
+        splicing = false;
+        if (!chunk) chunk.reset(new char[STREAM_STEP]);
+        w = ::read(relay[0], chunk.get(), std::min(n, STREAM_STEP));
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0 || !write_all(out, chunk.get(), static_cast<size_t>(w))) return Result::WRITE_ERROR;
+      }
+      if (w <= 0) return Result::WRITE_ERROR;
+      n -= static_cast<size_t>(w);
+    }
+    return Result::OK;
+  }
+
+ public:
+  BodyCopier(int socket, int out) : socket(socket), out(out), direct(false), splicing(true), relay{-1, -1} {
+    struct stat st;
+    direct = fstat(out, &st) == 0 && S_ISFIFO(st.st_mode);
+  }
+
+  ~BodyCopier() {
+    if (relay[0] >= 0) close(relay[0]);
+    if (relay[1] >= 0) close(relay[1]);
+  }
+
+  BodyCopier(const BodyCopier&) = delete;
+  BodyCopier& operator=(const BodyCopier&) = delete;
+
+  /**
+   * @brief Move up to `n` bytes.
+   *
+   * @param n     Most bytes to move; never more than the body has left.
+   * @param moved Output bytes moved (0 after EINTR).
+   * @return OK, or what failed; errno is set for the errors.
+   */
+  Result copy(size_t n, size_t& moved) {
+    moved = 0;
+    if (splicing && !direct && relay[0] < 0) {
+      if (pipe2(relay, O_CLOEXEC) == 0) {
+        fcntl(relay[1], F_SETPIPE_SZ, static_cast<int>(STREAM_STEP));  // best effort; 64 KiB otherwise
+      } else {
+        splicing = false;
+      }
+    }
+
+    if (splicing) {
+      ssize_t k = splice(socket, nullptr, direct ? out : relay[1], nullptr, n, SPLICE_F_MOVE | SPLICE_F_MORE);
+      if (k > 0) {
+        moved = static_cast<size_t>(k);
+        return direct ? Result::OK : drain(moved);
+      }
+      if (k == 0) return Result::CLOSED;
+      if (errno == EINTR) return Result::OK;
+      if (errno == EPIPE) return Result::WRITE_ERROR;
+      if (errno != EINVAL) return Result::READ_ERROR;
+      splicing = false;  // unsupported pair: copy from here on
+    }
+
+    if (!chunk) chunk.reset(new char[STREAM_STEP]);
+    ssize_t k = recv(socket, chunk.get(), std::min(n, STREAM_STEP), 0);
+    if (k == 0) return Result::CLOSED;
+    if (k < 0) return errno == EINTR ? Result::OK : Result::READ_ERROR;
+    if (!write_all(out, chunk.get(), static_cast<size_t>(k))) return Result::WRITE_ERROR;
+    moved = static_cast<size_t>(k);
+    return Result::OK;
+  }
+};
+
+}  // namespace
+
 // Constructor
-KvClient::KvClient() : sock(-1), connected(false), authenticated(false), BUFFER_SIZE(1024), socket_fd(-1) {}
+KvClient::KvClient()
+    : sock(-1),
+      connected(false),
+      authenticated(false),
+      BUFFER_SIZE(16384),
+      socket_fd(-1),
+      jitter(std::random_device{}()),
+      captureId(g_next_capture_id.fetch_add(1, std::memory_order_relaxed)) {}
 
 // Destructor ensures cleanup
 KvClient::~KvClient() {
@@ -17,51 +180,116 @@ KvClient::~KvClient() {
 }
 
 /**
- * @brief Create TCP socket and connect to server.
+ * @brief Resolve the host and connect to the first address that answers.
  *
- * @param host Server address.
+ * Names may resolve to several IPv4 and IPv6 addresses; they are raced
+ * happy-eyeballs style by network::dial, bounded by the connect timeout
+ * from the connection info. When the connection info names a Unix domain
+ * socket, that socket is used and host/port are only recorded.
+ *
+ * @param host Server name or address.
  * @param port Server port.
  * @return True if successful, false on error.
  */
 bool KvClient::connect(const std::string& host, int port) {
-  // @INFO Create socket
-  socket_fd = socket(AF_INET, SOCK_STREAM, 0);
-  if (socket_fd < 0) {
-    std::string error_msg = "Socket creation failed: " + std::string(strerror(ECONNABORTED));
-    Logger::error(error_msg);
-    return false;
-  }
-
   // Set connection info
   connectionInfo.host = host;
   connectionInfo.port = port;
 
-  // @INFO Set up server address
-  struct sockaddr_in server_addr;
-  server_addr.sin_family = AF_INET;
-  server_addr.sin_port = htons(port);
-
-  if (inet_pton(AF_INET, host.c_str(), &server_addr.sin_addr) <= 0) {
-    std::string error_msg = "Invalid address: " + std::string(strerror(ECONNREFUSED));
-    Logger::error(error_msg);
-    close(socket_fd);
-    return false;
+  // @INFO Resolve and connect
+  KvAddress peer;
+  std::string error_msg;
+  if (!connectionInfo.socketPath.empty()) {
+    socket_fd = network::dial_unix(connectionInfo.socketPath, peer, error_msg);
+  } else {
+    socket_fd = network::dial(host, port, connectionInfo.connectTimeout, peer, error_msg);
   }
-
-  // @INFO Connect to server
-  if (::connect(socket_fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-    std::string error_msg = "Connection failed: " + std::string(strerror(errno));
+  if (socket_fd < 0) {
     Logger::error(error_msg);
-    close(socket_fd);
     return false;
   }
 
   connected = true;
-  Logger::info("Connected to server at " + host + ":" + std::to_string(port));
-  this->addr = host + ":" + std::to_string(port);
+  Logger::info("Connected to server at " + peer.text());
+  this->addr = connectionInfo.endpoint();
   return true;
 }
 
+/**
+ * @brief Send AUTH with the stored username and password.
+ *
+ * @param reply Output raw server reply.
+ * @return True if the server accepted the credentials.
+ */
+bool KvClient::authenticate(std::string& reply) {
+  std::vector<std::string> auth_args = {connectionInfo.user, connectionInfo.password};
+  if (!sendCommand(resp::encode_command("AUTH", auth_args))) {
+    reply.clear();
+    return false;
+  }
+
+  reply = receiveResponse();
+  return reply == resp::encode_simple_string("OK");
+}
+
+/**
+ * @brief Re-open a lost connection with jittered exponential backoff.
+ *
+ * Uses the stored connection info, so credentials changed with an in-REPL
+ * AUTH are the ones sent again. Rejected credentials end the retries at
+ * once, since waiting will not fix them. The last accepted SELECT follows
+ * AUTH, so commands replayed on the new connection hit the same database.
+ *
+ * @return True once connected (and authenticated when credentials are set).
+ */
+bool KvClient::reconnect() {
+  disconnect();
+  if (reconnectPolicy.maxAttempts == 0) return false;
+
+  std::string target = connectionInfo.endpoint();
+  std::chrono::milliseconds ceiling = reconnectPolicy.baseDelay;
+
+  for (size_t attempt = 1; attempt <= reconnectPolicy.maxAttempts; ++attempt) {
+    std::uniform_int_distribution<long long> pick(0, ceiling.count());
+    std::chrono::milliseconds delay(pick(jitter));
+    Logger::warn("Reconnecting to " + target + " in " + std::to_string(delay.count()) + " ms (attempt " + std::to_string(attempt) + "/" +
+                 std::to_string(reconnectPolicy.maxAttempts) + ")");
+    std::this_thread::sleep_for(delay);
+    ceiling = std::min(reconnectPolicy.maxDelay, ceiling * 2);
+
+    if (!connect(connectionInfo.host, connectionInfo.port)) continue;
+
+    if (!connectionInfo.user.empty() || !connectionInfo.password.empty()) {
+      std::string reply;
+      if (!authenticate(reply)) {
+        if (!connected) continue;  // dropped again during AUTH
+        Logger::error("Re-authentication failed: " + resp::decode(reply));
+        disconnect();
+        return false;
+      }
+      authenticated = true;
+    }
+
+    if (!selectCommand.empty()) {
+      if (!sendCommand(selectCommand)) continue;
+      std::string reply = receiveResponse();
+      if (!connected) continue;  // dropped again during SELECT
+      if (reply != resp::encode_simple_string("OK")) {
+        Logger::error("Could not select the database again: " + resp::decode(reply));
+        disconnect();
+        return false;
+      }
+    }
+
+    Logger::success("Reconnected to " + target);
+    KvMetrics::global().reconnected();
+    return true;
+  }
+
+  Logger::error("Giving up on " + target + " after " + std::to_string(reconnectPolicy.maxAttempts) + " reconnect attempts");
+  return false;
+}
+
 /**
  * @brief Close the socket and update connection state.
  */
@@ -71,6 +299,7 @@ void KvClient::disconnect() {
     socket_fd = -1;
     connected = false;
     this->addr = "";
+    reader.reset();
   }
 }
 
@@ -109,6 +338,46 @@ void KvClient::setConnectionInfoFromAuthCommand(const std::string& authCommand)
   }
 }
 
+/**
+ * @brief Remember a SELECT or AUTH the server accepted, for reconnect().
+ *
+ * An accepted AUTH replaces the stored credentials, the same way an
+ * in-REPL AUTH does, so a reconnect authenticates as the current user.
+ *
+ * @param command Encoded command that was sent.
+ * @param reply   Its raw reply.
+ */
+void KvClient::noteReply(std::string_view command, std::string_view reply) {
+  if (reply != "+OK\r\n") return;
+  std::string_view name = resp::command_name(command);
+  if (is_command(name, "SELECT")) {
+    selectCommand.assign(command);
+    return;
+  }
+  if (!is_command(name, "AUTH")) return;
+
+  std::vector<std::string_view> elements;
+  std::vector<std::string> args;
+  if (!resp::read_array(command, elements)) return;
+  for (size_t i = 1; i < elements.size(); ++i) {
+    std::string_view arg;
+    if (!resp::read_bulk(elements[i], arg)) return;
+    std::string_view inner;
+    if (resp::read_bulk(arg, inner)) arg = inner;  // typed dialect wraps each token
+    args.emplace_back(arg);
+  }
+  if (args.empty()) return;
+  connectionInfo.setUser(args[0]);
+  connectionInfo.setPassword(args.size() > 1 ? args[1] : "");
+  connectionInfo.requireAuth = true;
+  authenticated = true;
+}
+
+/** @brief Replace the backoff used by reconnect(). */
+void KvClient::setReconnectPolicy(const KvReconnectPolicy& policy) {
+  reconnectPolicy = policy;
+}
+
 /** @copydoc KvClient::getConnectionInfo */
 const KvConnectionInfo* KvClient::getConnectionInfo() const {
   return &connectionInfo;
@@ -126,44 +395,324 @@ std::string KvClient::getAddr() const {
 /**
  * @brief Send a RESP-formatted command over TCP.
  *
+ * Loops until the whole buffer is written, so it is safe to pass a batch
+ * of pipelined commands.
+ *
  * @param command RESP string.
- * @return True if send succeeded.
+ * @return True if send succeeded; on failure the connection is closed.
  */
-bool KvClient::sendCommand(const std::string& command) {
+bool KvClient::sendCommand(std::string_view command) {
   if (!connected) {
     Logger::error("Not connected to server");
     return false;
   }
 
-  ssize_t bytes_sent = send(socket_fd, command.c_str(), command.length(), 0);
-  if (bytes_sent < 0) {
-    std::string error_msg = "Error sending command: " + std::string(strerror(errno));
-    Logger::error(error_msg);
+  if (KvCapture* capture = KvCapture::current()) capture_sent(*capture, captureId, command);
+
+  size_t offset = 0;
+  while (offset < command.length()) {
+    ssize_t bytes_sent = send(socket_fd, command.data() + offset, command.length() - offset, MSG_NOSIGNAL);
+    if (bytes_sent < 0) {
+      if (errno == EINTR) continue;
+      std::string error_msg = "Error sending command: " + std::string(strerror(errno));
+      Logger::error(error_msg);
+      disconnect();  // the socket is unusable; reconnect() opens a new one
+      return false;
+    }
+    offset += static_cast<size_t>(bytes_sent);
+  }
+
+  KvMetrics::global().sent(command.size());
+  return true;
+}
+
+/**
+ * @brief Send a command built in a resp::Buffer with writev.
+ *
+ * Large payloads referenced by the buffer go straight from the caller's
+ * memory to the socket. Partial writes resume at the right iovec.
+ *
+ * @param command Encoded command.
+ * @return True if send succeeded.
+ */
+bool KvClient::sendCommand(const resp::Buffer& command) {
+  if (!connected) {
+    Logger::error("Not connected to server");
     return false;
   }
 
+  std::vector<struct iovec> iov;
+  command.gather(iov);
+  if (KvCapture* capture = KvCapture::current()) capture->record(captureId, capture::Direction::SENT, iov.data(), iov.size());
+
+  size_t index = 0;
+  while (index < iov.size()) {
+    int count = static_cast<int>(std::min<size_t>(iov.size() - index, IOV_MAX));
+    ssize_t bytes_sent = writev(socket_fd, iov.data() + index, count);
+    if (bytes_sent < 0) {
+      if (errno == EINTR) continue;
+      std::string error_msg = "Error sending command: " + std::string(strerror(errno));
+      Logger::error(error_msg);
+      disconnect();
+      return false;
+    }
+
+    // Skip fully written iovecs and trim a partially written one.
+    size_t remaining = static_cast<size_t>(bytes_sent);
+    while (index < iov.size() && remaining >= iov[index].iov_len) {
+      remaining -= iov[index].iov_len;
+      ++index;
+    }
+    if (remaining > 0) {
+      iov[index].iov_base = static_cast<char*>(iov[index].iov_base) + remaining;
+      iov[index].iov_len -= remaining;
+    }
+  }
+
+  KvMetrics::global().sent(command.size());
   return true;
 }
 
 /**
- * @brief Receive a single response chunk (up to BUFFER_SIZE-1).
+ * @brief Receive exactly one complete RESP frame.
+ *
+ * Reads until the reader holds a whole frame, however many segments it
+ * spans. Bytes belonging to later frames stay buffered for the next call,
+ * so pipelined replies that arrive together are not merged.
  *
- * @return Response string or error message.
+ * @param frame Output view of the raw frame; valid until the next receive.
+ * @return False if the connection failed, was closed, or sent invalid RESP.
+ *         The client is disconnected in all three cases.
  */
-std::string KvClient::receiveResponse() {
+bool KvClient::receiveFrame(std::string_view& frame) {
   if (!connected) {
     Logger::error("Not connected to server");
-    return "Not connected to server";
+    return false;
   }
 
-  char buffer[BUFFER_SIZE] = {0};
-  ssize_t bytes_received = recv(socket_fd, buffer, BUFFER_SIZE - 1, 0);
+  while (true) {
+    resp::Reader::Status status = reader.next(frame);
+    if (status == resp::Reader::Status::COMPLETE) {
+      if (KvCapture* capture = KvCapture::current()) capture->record(captureId, capture::Direction::RECEIVED, frame);
+      KvMetrics::global().frame();
+      return true;
+    }
+    if (status == resp::Reader::Status::PROTOCOL_ERROR) {
+      Logger::error("Protocol error: invalid RESP frame from server");
+      disconnect();
+      return false;
+    }
 
+    if (!fill(BUFFER_SIZE)) return false;
+  }
+}
+
+/**
+ * @brief Read once from the socket into the reader.
+ *
+ * @param want Bytes to make room for.
+ * @return False if the connection failed or was closed; the client is
+ *         disconnected then. An interrupted read returns true with nothing
+ *         added.
+ */
+bool KvClient::fill(size_t want) {
+  ssize_t bytes_received = recv(socket_fd, reader.prepare(want), want, 0);
   if (bytes_received < 0) {
+    if (errno == EINTR) return true;
     std::string err_msg = "Error receiving response: " + std::string(strerror(errno));
     Logger::error(err_msg);
-    return "Error receiving response";
+    disconnect();
+    return false;
+  }
+  if (bytes_received == 0) {
+    Logger::error("Connection closed by server");
+    disconnect();
+    return false;
+  }
+
+  reader.commit(static_cast<size_t>(bytes_received));
+  KvMetrics::global().received(static_cast<size_t>(bytes_received));
+  return true;
+}
+
+/**
+ * @brief Receive one reply, streaming a bulk string body to `fd`.
+ *
+ * Only the `$<length>` header is parsed in memory. The body goes to `fd` as
+ * it arrives (see BodyCopier), so memory use does not depend on the value
+ * size. Any other reply (errors, nulls, aggregates) is received whole with
+ * receiveFrame(). A traffic capture gets the `$<length>` header of a
+ * streamed reply without its body.
+ *
+ * @param fd       Destination of a bulk string body.
+ * @param frame    Output raw reply when it was not streamed.
+ * @param streamed Output body bytes written to `fd`, or -1 if not streamed.
+ * @return False if the connection failed or `fd` could not be written. The
+ *         client is disconnected in both cases, since the rest of the body
+ *         is still unread.
+ */
+bool KvClient::receiveInto(int fd, std::string_view& frame, int64_t& streamed) {
+  streamed = -1;
+  if (!connected) {
+    Logger::error("Not connected to server");
+    return false;
+  }
+
+  // Wait for the header line; anything but a bulk string is read as usual
+  int64_t length = 0;
+  size_t header = 0;
+  while (true) {
+    std::string_view data = reader.peek();
+    if (!data.empty()) {
+      if (data[0] != '$') return receiveFrame(frame);
+      const char* next = nullptr;
+      resp::LineStatus status = resp::parse_length_line(data.data() + 1, data.data() + data.size(), length, next);
+      if (status == resp::LineStatus::MALFORMED) return receiveFrame(frame);  // reports the protocol error
+      if (status == resp::LineStatus::OK) {
+        header = static_cast<size_t>(next - data.data());
+        break;
+      }
+    }
+    if (!fill(BUFFER_SIZE)) return false;
   }
+  if (length < 0) return receiveFrame(frame);  // null bulk string
+  reader.skip(header);
 
-  return std::string(buffer, bytes_received);
+  // Body bytes that arrived with the header, then the rest from the socket
+  uint64_t left = static_cast<uint64_t>(length);
+  std::string_view early = reader.peek();
+  size_t take = static_cast<size_t>(std::min<uint64_t>(left, early.size()));
+  bool written = write_all(fd, early.data(), take);
+  reader.skip(take);
+  left -= take;
+
+  BodyCopier copier(socket_fd, fd);
+  while (written && left > 0) {
+    size_t moved = 0;
+    BodyCopier::Result result = copier.copy(static_cast<size_t>(std::min<uint64_t>(left, STREAM_STEP)), moved);
+    if (result == BodyCopier::Result::CLOSED) {
+      Logger::error("Connection closed by server");
+      disconnect();
+      return false;
+    }
+    if (result == BodyCopier::Result::READ_ERROR) {
+      Logger::error("Error receiving response: " + std::string(strerror(errno)));
+      disconnect();
+      return false;
+    }
+    written = result == BodyCopier::Result::OK;
+    left -= moved;
+    KvMetrics::global().received(moved);
+  }
+  if (!written) {
+    Logger::error("Error writing the reply: " + std::string(strerror(errno)));
+    disconnect();
+    return false;
+  }
+
+  // The CRLF that ends the body
+  while (reader.peek().size() < 2) {
+    if (!fill(BUFFER_SIZE)) return false;
+  }
+  if (reader.peek().substr(0, 2) != "\r\n") {
+    Logger::error("Protocol error: invalid RESP frame from server");
+    disconnect();
+    return false;
+  }
+  reader.skip(2);
+
+  if (KvCapture* capture = KvCapture::current()) capture->record(captureId, capture::Direction::RECEIVED, "$" + std::to_string(length) + "\r\n");
+  KvMetrics::global().frame();
+  streamed = length;
+  return true;
+}
+
+/**
+ * @brief Receive a single complete response frame.
+ *
+ * @return Response string, empty if the connection failed.
+ */
+std::string KvClient::receiveResponse() {
+  if (!connected) {
+    Logger::error("Not connected to server");
+    return "Not connected to server";
+  }
+
+  std::string_view frame;
+  if (!receiveFrame(frame)) {
+    return "";
+  }
+
+  return std::string(frame);
+}
+
+/**
+ * @brief Send one command and wait for its reply, reconnecting if needed.
+ *
+ * A lost connection is re-opened before the send. If it drops while the
+ * command is in flight, an idempotent command is replayed on a fresh
+ * connection. A non-idempotent one is not, because the server may already
+ * have applied it. In that case the error says so and the connection is
+ * restored for the next command.
+ *
+ * @param command    Encoded command.
+ * @param idempotent Whether the command may be sent twice.
+ * @param reply      Output raw reply; valid until the next receive.
+ * @return False if no reply could be obtained.
+ */
+bool KvClient::request(const resp::Buffer& command, bool idempotent, std::string_view& reply) {
+  static constexpr int MAX_REPLAYS = 3;
+
+  for (int replay = 0;; ++replay) {
+    if (!connected && !reconnect()) return false;
+
+    std::string_view frame;
+    auto sent_at = std::chrono::steady_clock::now();
+    if (sendCommand(command) && receiveFrame(frame)) {
+      KvMetrics::global().reply(resp::command_name(command.framing()), std::chrono::steady_clock::now() - sent_at, frame);
+      if (command.size() == command.framing().size()) noteReply(command.framing(), frame);
+      reply = frame;
+      return true;
+    }
+
+    if (!idempotent) {
+      Logger::error("Connection lost before the reply; the command was not replayed because it is not idempotent and may already have been applied");
+      reconnect();
+      return false;
+    }
+    if (replay == MAX_REPLAYS) {
+      Logger::error("Connection lost " + std::to_string(MAX_REPLAYS + 1) + " times while waiting for the reply; giving up");
+      return false;
+    }
+    Logger::warn("Connection lost before the reply; replaying idempotent command");
+  }
+}
+
+/**
+ * @brief Send one command and stream a bulk string reply to `fd`.
+ *
+ * A lost connection is re-opened before the send, as in request(). The
+ * command is never replayed once sent, because part of the value may
+ * already be in `fd`.
+ *
+ * @param command  Encoded command.
+ * @param fd       Destination of a bulk string body.
+ * @param reply    Output raw reply when it was not a bulk string.
+ * @param streamed Output body bytes written, or -1 if `reply` holds the reply.
+ * @return False if no complete reply was obtained.
+ */
+bool KvClient::requestInto(const resp::Buffer& command, int fd, std::string_view& reply, int64_t& streamed) {
+  if (!connected && !reconnect()) return false;
+
+  auto sent_at = std::chrono::steady_clock::now();
+  if (!sendCommand(command) || !receiveInto(fd, reply, streamed)) return false;
+
+  std::string_view name = resp::command_name(command.framing());
+  auto latency = std::chrono::steady_clock::now() - sent_at;
+  if (streamed < 0) {
+    KvMetrics::global().reply(name, latency, reply);
+  } else {
+    KvMetrics::global().reply(name, latency, false, static_cast<size_t>(streamed));
+  }
+  return true;
 }
@@ -0,0 +1,204 @@
+/**
+ * @file pipeline.cpp
+ * @brief KvPipeline method implementations.
+ */
+
+#include "include/pipeline.hpp"
+
+#include "include/logger.hpp"
+#include "include/metrics.hpp"
+#include "include/utils.hpp"
+
+// Constructor
+KvPipeline::KvPipeline(KvClient& client, size_t window, ReplyHandler handler)
+    : client(client),
+      window(window > 0 ? window : 1),
+      handler(std::move(handler)),
+      pendingHead(0),
+      sentBytes(0),
+      queued(0),
+      inFlight(0),
+      sentCount(0),
+      replyCount(0),
+      replayCount(0) {}
+
+/**
+ * @brief Queue an encoded command.
+ *
+ * Writes the queued commands once they are large enough or the window is
+ * full, then reads replies until there is room for another command.
+ *
+ * @param command RESP-encoded command.
+ * @return False if the connection failed and could not be recovered.
+ */
+bool KvPipeline::push(std::string_view command) {
+  entries.push_back({command.size(), cmd::is_idempotent_request(command), false, {}});
+  pending.append(command);
+  ++queued;
+
+  if (pending.size() - sentBytes >= FLUSH_BYTES || queued + inFlight >= window) {
+    if (!flush()) return false;
+  }
+
+  while (inFlight >= window) {
+    if (!receiveOne()) return false;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Write every queued command to the socket.
+ *
+ * @return False if the send failed and the connection could not be recovered.
+ */
+bool KvPipeline::flush() {
+  if (queued == 0) return true;
+
+  bool written = client.sendCommand(std::string_view(pending).substr(sentBytes));
+
+  // A failed write may still have delivered some of the batch, so the batch
+  // counts as in flight either way.
+  markSent();
+  sentCount += queued;
+  inFlight += queued;
+  queued = 0;
+  sentBytes = pending.size();
+  return written || recover();
+}
+
+/**
+ * @brief Flush the outbox and wait for every outstanding reply.
+ *
+ * @return False if the connection failed before all replies arrived.
+ */
+bool KvPipeline::drain() {
+  if (!flush()) return false;
+
+  while (inFlight > 0) {
+    if (!receiveOne()) return false;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Read the next reply and hand it to the handler.
+ *
+ * A command lost with an earlier connection is answered with LOST_REPLY
+ * without reading from the socket.
+ *
+ * @return False if the connection failed and could not be recovered.
+ */
+bool KvPipeline::receiveOne() {
+  if (entries.front().lost) {
+    popFront();
+    handler(replyCount++, LOST_REPLY);
+    return true;
+  }
+
+  std::string_view reply;
+  if (!client.receiveFrame(reply)) return recover();
+
+  const Entry& entry = entries.front();
+  std::string_view command = std::string_view(pending).substr(pendingHead, entry.length);
+  KvMetrics::global().reply(resp::command_name(command), std::chrono::steady_clock::now() - entry.sentAt, reply);
+  client.noteReply(command, reply);
+  popFront();
+  handler(replyCount++, reply);
+  return true;
+}
+
+/** @brief Stamp the queued commands, which are about to be written, with the time. */
+void KvPipeline::markSent() {
+  auto now = std::chrono::steady_clock::now();
+  for (size_t i = entries.size() - queued; i < entries.size(); ++i) entries[i].sentAt = now;
+}
+
+/** @brief Forget the oldest in-flight command once it is answered. */
+void KvPipeline::popFront() {
+  pendingHead += entries.front().length;
+  entries.pop_front();
+  --inFlight;
+
+  // Drop answered bytes once they dominate the buffer.
+  if (pendingHead >= FLUSH_BYTES && pendingHead * 2 >= pending.size()) {
+    pending.erase(0, pendingHead);
+    sentBytes -= pendingHead;
+    pendingHead = 0;
+  }
+}
+
+/**
+ * @brief Reconnect and resend what the lost connection left unanswered.
+ *
+ * In-flight commands that are not idempotent are marked lost, since the
+ * server may already have applied them. Everything else, including
+ * commands that were never written, is sent again in the original order
+ * and stamped with the new send time, so reply latency does not include
+ * the time spent on the dead connection.
+ *
+ * @return False if the client could not reconnect.
+ */
+bool KvPipeline::recover() {
+  for (int attempt = 0; attempt < MAX_RECOVERIES; ++attempt) {
+    if (!client.reconnect()) return false;
+
+    std::string resend;
+    auto now = std::chrono::steady_clock::now();
+    size_t offset = pendingHead;
+    size_t replays = 0;
+    size_t lost = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+      Entry& entry = entries[i];
+      bool was_sent = i < inFlight;
+      if (was_sent && !entry.lost && !entry.idempotent) {
+        entry.lost = true;
+        ++lost;
+      }
+      if (!entry.lost) {
+        resend.append(pending, offset, entry.length);
+        entry.sentAt = now;
+        if (was_sent) ++replays;
+      }
+      offset += entry.length;
+      if (entry.lost) entry.length = 0;
+    }
+
+    pending.swap(resend);
+    pendingHead = 0;
+    sentBytes = 0;
+    sentCount += queued;
+    inFlight += queued;
+    queued = 0;
+    replayCount += replays;
+
+    if (replays > 0 || lost > 0) {
+      Logger::warn("Replaying " + std::to_string(replays) + " in-flight commands" +
+                   (lost > 0 ? "; " + std::to_string(lost) + " non-idempotent commands were not replayed" : ""));
+    }
+
+    if (pending.empty() || client.sendCommand(pending)) {
+      sentBytes = pending.size();
+      return true;
+    }
+  }
+
+  Logger::error("Connection kept failing while replaying pipelined commands");
+  return false;
+}
+
+/** @brief Number of commands written to the socket (replays not counted). */
+uint64_t KvPipeline::sent() const {
+  return sentCount;
+}
+
+/** @brief Number of replies received. */
+uint64_t KvPipeline::received() const {
+  return replyCount;
+}
+
+/** @brief Number of commands written again after a reconnect. */
+uint64_t KvPipeline::replayed() const {
+  return replayCount;
+}
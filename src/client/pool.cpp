@@ -0,0 +1,257 @@
+/**
+ * @file pool.cpp
+ * @brief KvClientPool and KvClientPool::Lease method implementations.
+ */
+
+#include "include/pool.hpp"
+
+#include <algorithm>
+
+#include "include/logger.hpp"
+#include "include/resp.hpp"
+#include "include/utils.hpp"
+
+// --------------------------------------------------
+// @INFO Lease
+// --------------------------------------------------
+
+// Constructors
+KvClientPool::Lease::Lease() : pool(nullptr), broken(false) {}
+
+KvClientPool::Lease::Lease(KvClientPool* pool, std::unique_ptr<KvClient> client) : pool(pool), client(std::move(client)), broken(false) {}
+
+KvClientPool::Lease::Lease(Lease&& other) noexcept : pool(other.pool), client(std::move(other.client)), broken(other.broken) {
+  other.pool = nullptr;
+}
+
+KvClientPool::Lease& KvClientPool::Lease::operator=(Lease&& other) noexcept {
+  if (this != &other) {
+    release();
+    pool = other.pool;
+    client = std::move(other.client);
+    broken = other.broken;
+    other.pool = nullptr;
+  }
+  return *this;
+}
+
+// Destructor returns the connection
+KvClientPool::Lease::~Lease() {
+  release();
+}
+
+/**
+ * @brief Mark the connection as unusable.
+ *
+ * It is closed instead of being returned to the pool on release.
+ */
+void KvClientPool::Lease::invalidate() {
+  broken = true;
+}
+
+/** @brief Return the connection to the pool early. */
+void KvClientPool::Lease::release() {
+  if (pool != nullptr && client) {
+    pool->giveBack(std::move(client), broken);
+  }
+  pool = nullptr;
+}
+
+// --------------------------------------------------
+// @INFO KvClientPool
+// --------------------------------------------------
+
+// Constructor pre-opens minSize connections
+KvClientPool::KvClientPool(const KvConnectionInfo& info, const KvPoolConfig& config) : info(info), config(config), openCount(0), stopping(false) {
+  this->config.maxSize = std::max({this->config.maxSize, this->config.minSize, static_cast<size_t>(1)});
+
+  for (size_t i = 0; i < this->config.minSize; ++i) {
+    std::unique_ptr<KvClient> client = open();
+    if (!client) break;
+
+    auto now = std::chrono::steady_clock::now();
+    idle.push_back({std::move(client), now, now});
+    ++openCount;
+  }
+
+  if (openCount < this->config.minSize) {
+    Logger::warn("Connection pool opened " + std::to_string(openCount) + " of " + std::to_string(this->config.minSize) + " connections");
+  }
+
+  maintainer = std::thread(&KvClientPool::maintain, this);
+}
+
+// Destructor stops maintenance and closes idle connections
+KvClientPool::~KvClientPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  maintainer.join();
+  idle.clear();
+}
+
+/**
+ * @brief Open and authenticate one connection.
+ *
+ * @return The client, or null if it could not be opened.
+ */
+std::unique_ptr<KvClient> KvClientPool::open() {
+  std::unique_ptr<KvClient> client(new KvClient());
+  if (!network::open_connection(*client, info)) return nullptr;
+  return client;
+}
+
+/**
+ * @brief Borrow a connection.
+ *
+ * Prefers the most recently returned idle connection, opens a new one
+ * while below maxSize, and otherwise waits up to waitTimeout.
+ *
+ * @return A lease; empty if no connection could be obtained.
+ */
+KvClientPool::Lease KvClientPool::acquire() {
+  std::unique_lock<std::mutex> lock(mutex);
+  auto deadline = std::chrono::steady_clock::now() + config.waitTimeout;
+
+  while (true) {
+    if (!idle.empty()) {
+      std::unique_ptr<KvClient> client = std::move(idle.back().client);
+      idle.pop_back();
+      return Lease(this, std::move(client));
+    }
+
+    if (openCount < config.maxSize) {
+      ++openCount;  // reserve the slot while connecting without the lock
+      lock.unlock();
+
+      std::unique_ptr<KvClient> client = open();
+      if (client) return Lease(this, std::move(client));
+
+      lock.lock();
+      --openCount;
+      return Lease();
+    }
+
+    if (ready.wait_until(lock, deadline) == std::cv_status::timeout && idle.empty() && openCount >= config.maxSize) {
+      Logger::error("Timed out waiting for a pooled connection");
+      return Lease();
+    }
+  }
+}
+
+/**
+ * @brief Take a connection back from a lease.
+ *
+ * Broken or disconnected clients are closed and free their slot.
+ */
+void KvClientPool::giveBack(std::unique_ptr<KvClient> client, bool broken) {
+  if (broken || !client->isConnected()) {
+    client.reset();  // close outside the lock
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      --openCount;
+    }
+    ready.notify_one();
+    wake.notify_one();  // refill to minSize
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto now = std::chrono::steady_clock::now();
+    idle.push_back({std::move(client), now, now});
+  }
+  ready.notify_one();
+}
+
+/**
+ * @brief Background health checks, shrinking and refilling.
+ *
+ * Idle connections unused for keepalive are pinged outside the lock and
+ * dropped if the ping fails; connections idle longer than idleTimeout are
+ * closed while the pool is above minSize; lost connections are replaced
+ * until minSize are open again.
+ */
+void KvClientPool::maintain() {
+  auto interval = std::max(std::chrono::milliseconds(100), std::min(config.keepalive, config.idleTimeout) / 2);
+  std::string ping = resp::encode_command("PING", {});
+
+  std::unique_lock<std::mutex> lock(mutex);
+  while (!stopping) {
+    wake.wait_for(lock, interval);
+    if (stopping) break;
+
+    auto now = std::chrono::steady_clock::now();
+
+    // Shrink: the oldest idle connections sit at the front.
+    std::vector<std::unique_ptr<KvClient>> surplus;
+    while (!idle.empty() && openCount > config.minSize && now - idle.front().idleSince >= config.idleTimeout) {
+      surplus.push_back(std::move(idle.front().client));
+      idle.pop_front();
+      --openCount;
+    }
+
+    // Keepalive: take due connections out so leases are not blocked by pings.
+    std::vector<IdleClient> due;
+    for (auto it = idle.begin(); it != idle.end();) {
+      if (now - it->checkedAt >= config.keepalive) {
+        due.push_back(std::move(*it));
+        it = idle.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    size_t missing = openCount < config.minSize ? config.minSize - openCount : 0;
+    openCount += missing;
+    lock.unlock();
+
+    surplus.clear();
+
+    std::vector<IdleClient> healthy;
+    size_t dropped = 0;
+    for (IdleClient& entry : due) {
+      std::string_view reply;
+      if (entry.client->sendCommand(ping) && entry.client->receiveFrame(reply)) {
+        entry.checkedAt = std::chrono::steady_clock::now();
+        healthy.push_back(std::move(entry));
+      } else {
+        Logger::warn("Dropping broken pooled connection");
+        ++dropped;
+      }
+    }
+    due.clear();
+
+    std::vector<std::unique_ptr<KvClient>> fresh;
+    for (size_t i = 0; i < missing; ++i) {
+      std::unique_ptr<KvClient> client = open();
+      if (!client) break;
+      fresh.push_back(std::move(client));
+    }
+
+    lock.lock();
+    for (IdleClient& entry : healthy) {
+      idle.push_front(std::move(entry));
+    }
+    auto opened = std::chrono::steady_clock::now();
+    for (std::unique_ptr<KvClient>& client : fresh) {
+      idle.push_back({std::move(client), opened, opened});
+    }
+    openCount -= dropped + (missing - fresh.size());
+    if (!healthy.empty() || !fresh.empty()) ready.notify_all();
+  }
+}
+
+/** @brief Connections currently open (idle or leased). */
+size_t KvClientPool::size() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return openCount;
+}
+
+/** @brief Connections ready to be leased. */
+size_t KvClientPool::idleCount() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return idle.size();
+}
@@ -0,0 +1,336 @@
+/**
+ * @file read_cache.cpp
+ * @brief KvReadCache method implementations.
+ */
+
+#include "include/read_cache.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+/** @brief What a command does to the cache. */
+enum Effect {
+  EFFECT_WRITE, /**< Drop the entries of every argument (the default) */
+  EFFECT_CACHE, /**< Single-key read whose reply can be stored */
+  EFFECT_READ,  /**< Read that is not cached and changes nothing */
+  EFFECT_CLEAR, /**< May change any key, or switches database or user */
+  EFFECT_MULTI, /**< Starts a transaction */
+  EFFECT_END    /**< EXEC or DISCARD */
+};
+
+/** @brief Effect of a command name; upper case and sorted. */
+struct Rule {
+  const char* name;
+  Effect effect;
+};
+
+const Rule RULES[] = {
+    {"AUTH", EFFECT_CLEAR},      {"DBSIZE", EFFECT_READ},     {"DISCARD", EFFECT_END},     {"ECHO", EFFECT_READ},       {"EVAL", EFFECT_CLEAR},
+    {"EVALSHA", EFFECT_CLEAR},   {"EXEC", EFFECT_END},        {"EXISTS", EFFECT_CACHE},    {"FCALL", EFFECT_CLEAR},     {"FLUSHALL", EFFECT_CLEAR},
+    {"FLUSHDB", EFFECT_CLEAR},   {"GET", EFFECT_CACHE},       {"GETRANGE", EFFECT_CACHE},  {"HELLO", EFFECT_CLEAR},     {"HEXISTS", EFFECT_CACHE},
+    {"HGET", EFFECT_CACHE},      {"HGETALL", EFFECT_CACHE},   {"HKEYS", EFFECT_CACHE},     {"HLEN", EFFECT_CACHE},      {"HMGET", EFFECT_CACHE},
+    {"HSTRLEN", EFFECT_CACHE},   {"HVALS", EFFECT_CACHE},     {"INFO", EFFECT_READ},       {"KEYS", EFFECT_READ},       {"LINDEX", EFFECT_CACHE},
+    {"LLEN", EFFECT_CACHE},      {"LRANGE", EFFECT_CACHE},    {"MGET", EFFECT_READ},       {"MULTI", EFFECT_MULTI},     {"PING", EFFECT_READ},
+    {"PTTL", EFFECT_READ},       {"RESET", EFFECT_CLEAR},     {"SCAN", EFFECT_READ},       {"SCARD", EFFECT_CACHE},     {"SELECT", EFFECT_CLEAR},
+    {"SISMEMBER", EFFECT_CACHE}, {"SMEMBERS", EFFECT_CACHE},  {"STRLEN", EFFECT_CACHE},    {"SWAPDB", EFFECT_CLEAR},    {"TIME", EFFECT_READ},
+    {"TTL", EFFECT_READ},        {"TYPE", EFFECT_READ},       {"ZCARD", EFFECT_CACHE},     {"ZRANGE", EFFECT_CACHE},    {"ZSCORE", EFFECT_CACHE},
+};
+
+/**
+ * @brief Upper-case a command name into `upper` and look up its effect.
+ *
+ * @param name  Command name, any case.
+ * @param upper Output; the upper-case name.
+ * @return The effect; names not in RULES are writes.
+ */
+Effect effect_of(std::string_view name, std::string& upper) {
+  upper.resize(name.size());
+  for (size_t i = 0; i < name.size(); ++i) upper[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(name[i])));
+
+  auto rule = std::lower_bound(std::begin(RULES), std::end(RULES), upper, [](const Rule& r, const std::string& n) { return n.compare(r.name) > 0; });
+  return rule != std::end(RULES) && upper == rule->name ? rule->effect : EFFECT_WRITE;
+}
+
+/** @brief Replies worth keeping: data, not errors or status lines such as +QUEUED. */
+bool storable(std::string_view reply) {
+  return !reply.empty() && (reply[0] == '$' || reply[0] == ':' || reply[0] == '*');
+}
+
+}  // namespace
+
+// Constructor
+KvReadCache::KvReadCache(const KvCacheConfig& config)
+    : config(config), head(NONE), tail(NONE), hand(0), generation(0), clearedAt(0), transaction(false) {}
+
+/**
+ * @brief Answer a command from the cache, or prepare it for the server.
+ *
+ * A cacheable read that has a live entry is answered into `reply`. Any
+ * other command first applies its effect: writes drop the entries of their
+ * arguments, FLUSHDB and friends drop everything, MULTI suspends the cache
+ * until EXEC or DISCARD.
+ *
+ * @param words  The command.
+ * @param ticket Output; pass to complete() with the server's reply.
+ * @param reply  Output; the cached reply on a hit.
+ * @return True on a hit, in which case nothing must be sent.
+ */
+bool KvReadCache::begin(const Command& words, Ticket& ticket, std::string& reply) {
+  ticket.cacheable = false;
+  if (words.empty()) return false;
+
+  Effect effect = effect_of(words[0], probe);
+  switch (effect) {
+    case EFFECT_READ:
+      return false;
+    case EFFECT_MULTI:
+      transaction = true;
+      return false;
+    case EFFECT_END:
+      transaction = false;
+      return false;
+    case EFFECT_CLEAR:
+      counters.invalidations += counters.entries;
+      clear();
+      return false;
+    case EFFECT_WRITE:
+      ++generation;
+      for (size_t i = 1; i < words.size(); ++i) invalidateKey(words[i]);
+      return false;
+    case EFFECT_CACHE:
+      break;
+  }
+
+  // EXISTS with several keys counts them; only the single-key form is cached.
+  if (transaction || words.size() < 2 || (probe == "EXISTS" && words.size() > 2)) return false;
+
+  // Data key, NUL, NAME, then the remaining arguments, each after a NUL
+  ticket.key.assign(words[1]);
+  ticket.key += '\0';
+  ticket.key += probe;
+  for (size_t i = 2; i < words.size(); ++i) {
+    ticket.key += '\0';
+    ticket.key.append(words[i]);
+  }
+  ticket.keyLength = words[1].size();
+  ticket.generation = generation;
+
+  auto found = index.find(ticket.key);
+  if (found != index.end()) {
+    uint32_t slot = found->second;
+    Entry& entry = slots[slot];
+    if (config.ttl.count() > 0 && std::chrono::steady_clock::now() >= entry.expires) {
+      ++counters.expired;
+      remove(slot);
+    } else {
+      if (config.eviction == KvEviction::LRU) {
+        unlink(slot);
+        link(slot);
+      } else {
+        entry.referenced = true;
+      }
+      ++counters.hits;
+      reply.assign(entry.reply);
+      return true;
+    }
+  }
+
+  ++counters.misses;
+  probe.assign(words[1]);
+  ++pending[probe].reads;
+  ticket.cacheable = true;
+  return false;
+}
+
+/**
+ * @brief Store the server's reply to a command begin() could not answer.
+ *
+ * Call it once for every command begin() did not answer. Nothing is
+ * stored if the command was not a cacheable read, the reply is an error or
+ * status line, or the key was written (or the cache cleared) since begin():
+ * a write queued behind a pipelined read may have changed the value before
+ * this reply was read.
+ *
+ * @param ticket As filled by begin().
+ * @param reply  Raw RESP reply; empty if the command failed.
+ */
+void KvReadCache::complete(const Ticket& ticket, std::string_view reply) {
+  if (!ticket.cacheable) return;
+
+  bool stale = clearedAt > ticket.generation;
+  probe.assign(ticket.key, 0, ticket.keyLength);
+  auto reads = pending.find(probe);
+  if (reads != pending.end()) {
+    stale = stale || reads->second.written > ticket.generation;
+    if (--reads->second.reads == 0) pending.erase(reads);
+  }
+  if (stale || transaction || !storable(reply)) return;
+
+  // One entry may take at most a quarter of the cache, so a single large
+  // value cannot flush out everything else.
+  size_t bytes = ticket.key.size() + ticket.keyLength + reply.size() + ENTRY_OVERHEAD;
+  if (bytes > config.maxBytes / 4) return;
+
+  auto found = index.find(ticket.key);
+  if (found != index.end()) remove(found->second);
+  while (counters.bytes + bytes > config.maxBytes) {
+    if (!evictOne()) break;
+  }
+
+  uint32_t slot;
+  if (!freeSlots.empty()) {
+    slot = freeSlots.back();
+    freeSlots.pop_back();
+  } else {
+    slot = static_cast<uint32_t>(slots.size());
+    slots.emplace_back();
+  }
+
+  auto inserted = index.emplace(ticket.key, slot).first;
+  Entry& entry = slots[slot];
+  entry.key = &inserted->first;
+  entry.keyLength = ticket.keyLength;
+  entry.reply.assign(reply);
+  entry.expires = std::chrono::steady_clock::now() + config.ttl;
+  entry.referenced = false;
+  entry.live = true;
+  byDataKey[ticket.key.substr(0, ticket.keyLength)].push_back(slot);
+  if (config.eviction == KvEviction::LRU) link(slot);
+
+  ++counters.entries;
+  counters.bytes += bytes;
+}
+
+/** @brief Drop every entry, and the replies of reads in flight; statistics are kept. */
+void KvReadCache::clear() {
+  clearedAt = ++generation;
+  slots.clear();
+  freeSlots.clear();
+  index.clear();
+  byDataKey.clear();
+  head = tail = NONE;
+  hand = 0;
+  counters.entries = 0;
+  counters.bytes = 0;
+}
+
+/** @brief Hit, miss, eviction and size counters. */
+const KvCacheStats& KvReadCache::stats() const {
+  return counters;
+}
+
+/** @brief One-line summary of stats() for the end of a session. */
+std::string KvReadCache::summary() const {
+  uint64_t lookups = counters.hits + counters.misses;
+  std::ostringstream out;
+  out.setf(std::ios::fixed);
+  out.precision(1);
+  out << "cache: " << counters.hits << " hits, " << counters.misses << " misses";
+  if (lookups > 0) out << " (" << 100.0 * static_cast<double>(counters.hits) / static_cast<double>(lookups) << "% hit rate)";
+  out << ", " << counters.invalidations << " invalidated, " << counters.expired << " expired, " << counters.evictions << " evicted, "
+      << counters.entries << " entries in " << static_cast<double>(counters.bytes) / 1024.0 << " KiB";
+  return out.str();
+}
+
+/** @brief Make `slot` the most recently used entry. */
+void KvReadCache::link(uint32_t slot) {
+  Entry& entry = slots[slot];
+  entry.prev = NONE;
+  entry.next = head;
+  if (head != NONE) slots[head].prev = slot;
+  head = slot;
+  if (tail == NONE) tail = slot;
+}
+
+/** @brief Take `slot` out of the LRU list. */
+void KvReadCache::unlink(uint32_t slot) {
+  Entry& entry = slots[slot];
+  if (entry.prev != NONE) {
+    slots[entry.prev].next = entry.next;
+  } else {
+    head = entry.next;
+  }
+  if (entry.next != NONE) {
+    slots[entry.next].prev = entry.prev;
+  } else {
+    tail = entry.prev;
+  }
+}
+
+/** @brief Free `slot` and forget its key. */
+void KvReadCache::remove(uint32_t slot) {
+  Entry& entry = slots[slot];
+  if (config.eviction == KvEviction::LRU) unlink(slot);
+
+  probe.assign(*entry.key, 0, entry.keyLength);
+  auto owner = byDataKey.find(probe);
+  if (owner != byDataKey.end()) {
+    std::vector<uint32_t>& siblings = owner->second;
+    siblings.erase(std::find(siblings.begin(), siblings.end(), slot));
+    if (siblings.empty()) byDataKey.erase(owner);
+  }
+
+  --counters.entries;
+  counters.bytes -= entry.key->size() + entry.keyLength + entry.reply.size() + ENTRY_OVERHEAD;
+  index.erase(*entry.key);
+
+  std::string().swap(entry.reply);
+  entry.key = nullptr;
+  entry.live = false;
+  freeSlots.push_back(slot);
+}
+
+/**
+ * @brief Drop one entry by the configured policy.
+ *
+ * LRU drops the tail. CLOCK sweeps the hand over the slots, clearing
+ * reference bits, and drops the first entry without one.
+ *
+ * @return False if the cache is empty.
+ */
+bool KvReadCache::evictOne() {
+  if (counters.entries == 0) return false;
+
+  if (config.eviction == KvEviction::LRU) {
+    remove(tail);
+    ++counters.evictions;
+    return true;
+  }
+
+  // Two passes are enough: the first clears every reference bit.
+  for (size_t step = 0; step < 2 * slots.size(); ++step) {
+    uint32_t slot = hand;
+    hand = hand + 1 < slots.size() ? hand + 1 : 0;
+    Entry& entry = slots[slot];
+    if (!entry.live) continue;
+    if (entry.referenced) {
+      entry.referenced = false;
+      continue;
+    }
+    remove(slot);
+    ++counters.evictions;
+    return true;
+  }
+  return false;
+}
+
+/** @brief Drop every entry of one data key, and the replies of its reads in flight. */
+void KvReadCache::invalidateKey(std::string_view key) {
+  probe.assign(key);
+  auto reads = pending.find(probe);
+  if (reads != pending.end()) reads->second.written = generation;
+
+  auto owner = byDataKey.find(probe);
+  if (owner == byDataKey.end()) return;
+
+  std::vector<uint32_t> victims;
+  victims.swap(owner->second);
+  byDataKey.erase(owner);
+  for (uint32_t slot : victims) {
+    // remove() looks the data key up again and finds it gone, which is fine.
+    remove(slot);
+    ++counters.invalidations;
+  }
+}
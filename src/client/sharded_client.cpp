@@ -0,0 +1,306 @@
+/**
+ * @file sharded_client.cpp
+ * @brief KvShardedClient method implementations.
+ */
+
+#include "include/sharded_client.hpp"
+
+#include <strings.h>
+
+#include <algorithm>
+#include <cstdint>
+
+#include "include/logger.hpp"
+#include "include/metrics.hpp"
+#include "include/resp_reader.hpp"
+#include "include/resp_scan.hpp"
+
+namespace {
+
+/** @brief Where a command is sent. */
+enum RouteKind {
+  ROUTE_BROADCAST, /**< Every node */
+  ROUTE_KEYS,      /**< Split by key; every `stride` words start a key group */
+  ROUTE_FIRST      /**< The first node; the command has no key */
+};
+
+/** @brief Routing for a command that does not simply take one key first. */
+struct Route {
+  const char* name;
+  RouteKind kind;
+  KvShardedClient::Merge merge;
+  size_t stride;
+};
+
+using Merge = KvShardedClient::Merge;
+
+const Route ROUTES[] = {
+    {"DBSIZE", ROUTE_BROADCAST, Merge::SUM, 0},    {"KEYS", ROUTE_BROADCAST, Merge::CONCAT, 0}, {"FLUSHDB", ROUTE_BROADCAST, Merge::SAME, 0},
+    {"FLUSHALL", ROUTE_BROADCAST, Merge::SAME, 0}, {"SELECT", ROUTE_BROADCAST, Merge::SAME, 0}, {"PING", ROUTE_BROADCAST, Merge::SAME, 0},
+    {"MGET", ROUTE_KEYS, Merge::ARRAY, 1},         {"DEL", ROUTE_KEYS, Merge::SUM, 1},          {"UNLINK", ROUTE_KEYS, Merge::SUM, 1},
+    {"EXISTS", ROUTE_KEYS, Merge::SUM, 1},         {"TOUCH", ROUTE_KEYS, Merge::SUM, 1},        {"MSET", ROUTE_KEYS, Merge::SAME, 2},
+    {"INFO", ROUTE_FIRST, Merge::SINGLE, 0},       {"TIME", ROUTE_FIRST, Merge::SINGLE, 0},     {"ECHO", ROUTE_FIRST, Merge::SINGLE, 0},
+};
+
+/** @brief Routing entry for a command name, or null for single-key commands. */
+const Route* find_route(std::string_view name) {
+  for (const Route& route : ROUTES) {
+    if (name.size() == strlen(route.name) && strncasecmp(name.data(), route.name, name.size()) == 0) return &route;
+  }
+  return nullptr;
+}
+
+/** @brief 64-bit FNV-1a with a murmur3 finalizer, so nearby keys spread over the ring. */
+uint64_t hash(std::string_view data) {
+  uint64_t h = 0xcbf29ce484222325ULL;
+  for (unsigned char c : data) {
+    h ^= c;
+    h *= 0x100000001b3ULL;
+  }
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+/** @brief The part of a key that is hashed: the first non-empty `{tag}`, else the key. */
+std::string_view hash_slot(std::string_view key) {
+  size_t open = key.find('{');
+  if (open == std::string_view::npos) return key;
+  size_t close = key.find('}', open + 1);
+  if (close == std::string_view::npos || close == open + 1) return key;
+  return key.substr(open + 1, close - open - 1);
+}
+
+/** @brief Read an `:n` integer reply. */
+bool read_integer(std::string_view reply, int64_t& value) {
+  const char* next = nullptr;
+  return reply.size() > 1 && reply[0] == ':' &&
+         resp::parse_length_line(reply.data() + 1, reply.data() + reply.size(), value, next) == resp::LineStatus::OK;
+}
+
+}  // namespace
+
+// Constructor builds the ring from each node's endpoint, so the key
+// placement does not depend on the order the nodes were given in.
+KvShardedClient::KvShardedClient(const std::vector<KvConnectionInfo>& infos) : infos(infos), outboxes(infos.size()) {
+  for (size_t n = 0; n < infos.size(); ++n) {
+    nodes.push_back(std::make_unique<KvClient>());
+    std::string endpoint = infos[n].endpoint();
+    for (size_t v = 0; v < VIRTUAL_NODES; ++v) {
+      ring.emplace_back(hash(endpoint + "#" + std::to_string(v)), n);
+    }
+  }
+  std::sort(ring.begin(), ring.end());
+}
+
+/**
+ * @brief Connect (and authenticate) every node.
+ *
+ * @return False if any node could not be reached.
+ */
+bool KvShardedClient::connect() {
+  bool ok = true;
+  for (size_t n = 0; n < nodes.size(); ++n) {
+    if (!network::open_connection(*nodes[n], infos[n])) {
+      Logger::error("Cannot reach shard " + infos[n].endpoint());
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+/** @brief Close every node connection. */
+void KvShardedClient::disconnect() {
+  for (auto& node : nodes) node->disconnect();
+}
+
+/** @brief Use the same reconnect backoff on every node. */
+void KvShardedClient::setReconnectPolicy(const KvReconnectPolicy& policy) {
+  for (auto& node : nodes) node->setReconnectPolicy(policy);
+}
+
+/** @brief Number of nodes. */
+size_t KvShardedClient::size() const {
+  return nodes.size();
+}
+
+/** @brief Connection settings of a node. */
+const KvConnectionInfo& KvShardedClient::node(size_t index) const {
+  return infos[index];
+}
+
+/**
+ * @brief Node owning a key: the first ring point at or after the key's hash.
+ *
+ * @param key Key, possibly with a `{tag}`.
+ * @return Index of the node.
+ */
+size_t KvShardedClient::nodeFor(std::string_view key) const {
+  auto point = std::lower_bound(ring.begin(), ring.end(), std::make_pair(hash(hash_slot(key)), size_t(0)));
+  return point == ring.end() ? ring.front().second : point->second;
+}
+
+/**
+ * @brief Decide which nodes a command goes to and with which arguments.
+ *
+ * @param command Command words.
+ * @param plan    Output plan.
+ */
+void KvShardedClient::split(const Command& command, Plan& plan) const {
+  plan.parts.clear();
+  plan.merge = Merge::SINGLE;
+  plan.results = 0;
+
+  const Route* route = command.empty() ? nullptr : find_route(command[0]);
+
+  if (route != nullptr && route->kind == ROUTE_BROADCAST) {
+    plan.merge = route->merge;
+    for (size_t n = 0; n < nodes.size(); ++n) plan.parts.push_back({n, command, {}, {}});
+    return;
+  }
+
+  // Split key groups by node; a wrong argument count goes to one node whole
+  // so the server reports it.
+  if (route != nullptr && route->kind == ROUTE_KEYS && command.size() > 1 && (command.size() - 1) % route->stride == 0) {
+    std::vector<size_t> part_of(nodes.size(), SIZE_MAX);
+    for (size_t i = 1; i < command.size(); i += route->stride) {
+      size_t n = nodeFor(command[i]);
+      if (part_of[n] == SIZE_MAX) {
+        part_of[n] = plan.parts.size();
+        plan.parts.push_back({n, {command[0]}, {}, {}});
+      }
+      Part& part = plan.parts[part_of[n]];
+      part.words.insert(part.words.end(), command.begin() + static_cast<std::ptrdiff_t>(i),
+                        command.begin() + static_cast<std::ptrdiff_t>(i + route->stride));
+      part.positions.push_back(plan.results++);
+    }
+
+    // Everything on one node: its reply needs no merging.
+    plan.merge = plan.parts.size() == 1 ? Merge::SINGLE : route->merge;
+    return;
+  }
+
+  bool keyed = command.size() > 1 && (route == nullptr || route->kind != ROUTE_FIRST);
+  plan.parts.push_back({keyed ? nodeFor(command[1]) : 0, command, {}, {}});
+}
+
+/**
+ * @brief Combine the sub-replies of a command into one reply.
+ *
+ * The first error reply (simple or bulk), if any, is the result.
+ *
+ * @param plan Executed plan; replies are moved out.
+ * @return Raw RESP reply.
+ */
+std::string KvShardedClient::merge(Plan& plan) const {
+  for (Part& part : plan.parts) {
+    if (part.reply.empty() || part.reply[0] == '-' || part.reply[0] == '!') return std::move(part.reply);
+  }
+
+  std::string out;
+  switch (plan.merge) {
+    case Merge::SINGLE:
+    case Merge::SAME:
+      return std::move(plan.parts.front().reply);
+
+    case Merge::SUM: {
+      int64_t total = 0;
+      for (const Part& part : plan.parts) {
+        int64_t value = 0;
+        if (!read_integer(part.reply, value)) return resp::encode_error("ERR unexpected reply from shard " + infos[part.node].endpoint());
+        total += value;
+      }
+      resp::append_integer(out, total);
+      return out;
+    }
+
+    case Merge::ARRAY: {
+      std::vector<std::string_view> slots(plan.results);
+      std::vector<std::string_view> elements;
+      for (const Part& part : plan.parts) {
+        if (!resp::read_array(part.reply, elements) || elements.size() != part.positions.size()) {
+          return resp::encode_error("ERR unexpected reply from shard " + infos[part.node].endpoint());
+        }
+        for (size_t j = 0; j < elements.size(); ++j) slots[part.positions[j]] = elements[j];
+      }
+      resp::append_array_header(out, slots.size());
+      for (std::string_view element : slots) out.append(element);
+      return out;
+    }
+
+    case Merge::CONCAT: {
+      std::vector<std::string_view> all;
+      std::vector<std::string_view> elements;
+      for (const Part& part : plan.parts) {
+        if (!resp::read_array(part.reply, elements)) return resp::encode_error("ERR unexpected reply from shard " + infos[part.node].endpoint());
+        all.insert(all.end(), elements.begin(), elements.end());
+      }
+      resp::append_array_header(out, all.size());
+      for (std::string_view element : all) out.append(element);
+      return out;
+    }
+  }
+  return out;
+}
+
+/**
+ * @brief Run a batch of commands across the nodes.
+ *
+ * Every node's share of the batch is written before any reply is read.
+ * A node that fails has its commands answered with an error and is
+ * reconnected for the next batch.
+ *
+ * @param commands Commands in input order.
+ * @param replies  Output raw replies, one per command, same order.
+ * @return False if any node failed during the batch.
+ */
+bool KvShardedClient::execute(const std::vector<Command>& commands, std::vector<std::string>& replies) {
+  std::vector<Plan> plans(commands.size());
+  std::vector<std::vector<Part*>> expected(nodes.size());
+  std::vector<std::vector<size_t>> starts(nodes.size());  // offset of each part's command in its outbox
+  for (std::string& outbox : outboxes) outbox.clear();
+
+  for (size_t c = 0; c < commands.size(); ++c) {
+    split(commands[c], plans[c]);
+    for (Part& part : plans[c].parts) {
+      std::string& outbox = outboxes[part.node];
+      starts[part.node].push_back(outbox.size());
+      resp::append_array_header(outbox, part.words.size());
+      for (std::string_view word : part.words) resp::append_token_element(outbox, word);
+      expected[part.node].push_back(&part);
+    }
+  }
+
+  bool healthy = true;
+  std::vector<bool> sent(nodes.size(), false);
+  auto sent_at = std::chrono::steady_clock::now();
+  for (size_t n = 0; n < nodes.size(); ++n) {
+    if (expected[n].empty()) continue;
+    KvClient& node = *nodes[n];
+    sent[n] = (node.isConnected() || node.reconnect()) && node.sendCommand(outboxes[n]);
+  }
+
+  for (size_t n = 0; n < nodes.size(); ++n) {
+    for (size_t i = 0; i < expected[n].size(); ++i) {
+      std::string_view frame;
+      if (!sent[n] || !nodes[n]->receiveFrame(frame)) {
+        healthy = false;
+        std::string lost = resp::encode_error("ERR shard " + infos[n].endpoint() + " unavailable");
+        for (; i < expected[n].size(); ++i) expected[n][i]->reply = lost;
+        break;
+      }
+      KvMetrics::global().reply(expected[n][i]->words[0], std::chrono::steady_clock::now() - sent_at, frame);
+      // Lets reconnect() restore a broadcast SELECT on this node
+      size_t end = i + 1 < starts[n].size() ? starts[n][i + 1] : outboxes[n].size();
+      nodes[n]->noteReply(std::string_view(outboxes[n]).substr(starts[n][i], end - starts[n][i]), frame);
+      expected[n][i]->reply.assign(frame);
+    }
+  }
+
+  replies.clear();
+  for (Plan& plan : plans) replies.push_back(merge(plan));
+  return healthy;
+}
@@ -6,22 +6,168 @@
 #ifndef _ARGUMENT_HPP_
 #define _ARGUMENT_HPP_
 
-#include "utils.hpp"
+#include "client.hpp"
+#include "read_cache.hpp"
+#include "render.hpp"
+
+/**
+ * @class KvCliOptions
+ * @brief Run mode and tuning flags that are not part of the connection.
+ */
+class KvCliOptions {
+ public:
+  bool pipe;             /**< Run in pipelined batch mode instead of the REPL */
+  std::string inputFile; /**< Command file for pipe mode (empty = stdin) */
+  size_t pipeWindow;     /**< Max commands in flight in pipe and import mode */
+
+  resp::Format outputFormat; /**< How replies are printed */
+
+  std::vector<std::string> command; /**< One-shot command from the command line (empty = none) */
+  std::string outFile;              /**< Stream a one-shot bulk reply here ("-" = stdout, empty = print) */
+
+  size_t reconnectAttempts; /**< Reconnect attempts after a lost connection (0 = never) */
+
+  std::string captureFile; /**< Traffic capture to write (empty = no capture) */
+
+  std::string metricsFile;  /**< Prometheus textfile to rewrite (empty = none) */
+  uint64_t metricsInterval; /**< Seconds between textfile rewrites */
+  std::string metricsJson;  /**< JSON metrics dump written at exit (empty = none) */
+
+  std::string replayFile;   /**< Traffic capture to replay (empty = no replay) */
+  double replaySpeed;       /**< Timing scale: 2 = twice as fast (0 = as fast as possible) */
+  size_t replayConnections; /**< Replay connections (0 = one per recorded connection) */
+
+  bool cache;                /**< Answer repeated reads from a local cache */
+  size_t cacheSize;          /**< Cache memory cap in MiB */
+  uint64_t cacheTtl;         /**< Cache entry lifetime in milliseconds */
+  std::string cacheEviction; /**< lru or clock */
+
+  std::vector<KvConnectionInfo> shards; /**< Every node when several -url are given (empty = one server) */
+
+  std::string importFile;   /**< File to bulk-load (empty = no import) */
+  std::string importFormat; /**< auto, csv, tsv, commands, resp or snapshot */
+
+  std::string exportFile;   /**< Snapshot file to write (empty = no export) */
+  size_t exportConnections; /**< Connections fetching values in parallel */
+
+  bool latency;             /**< Run the latency monitor */
+  bool latencyHistory;      /**< Print one latency line per interval */
+  bool latencyDist;         /**< Print a latency heatmap row per interval */
+  uint64_t latencyInterval; /**< History interval in seconds (0 = mode default) */
+
+  bool bench;                 /**< Run the load generator */
+  size_t benchClients;        /**< Concurrent connections */
+  size_t benchThreads;        /**< Worker threads (0 = one per core) */
+  uint64_t benchRequests;     /**< Total requests across all connections */
+  size_t benchPipeline;       /**< Requests in flight per connection */
+  std::string benchMix;       /**< Weighted command mix, e.g. "set=3,get=7" */
+  uint64_t benchKeyspace;     /**< Number of distinct keys */
+  size_t benchValueSize;      /**< SET value size in bytes */
+  std::string benchValueType; /**< SET value kind: string, int or bool */
+
+  /**
+   * @brief Default constructor initializes defaults.
+   */
+  KvCliOptions()
+      : pipe(false),
+        inputFile(""),
+        pipeWindow(1024),
+        outputFormat(resp::Format::HUMAN),
+        outFile(""),
+        reconnectAttempts(10),
+        captureFile(""),
+        metricsFile(""),
+        metricsInterval(15),
+        metricsJson(""),
+        replayFile(""),
+        replaySpeed(1),
+        replayConnections(0),
+        cache(false),
+        cacheSize(64),
+        cacheTtl(5000),
+        cacheEviction("lru"),
+        importFile(""),
+        importFormat("auto"),
+        exportFile(""),
+        exportConnections(4),
+        latency(false),
+        latencyHistory(false),
+        latencyDist(false),
+        latencyInterval(0),
+        bench(false),
+        benchClients(50),
+        benchThreads(0),
+        benchRequests(100000),
+        benchPipeline(1),
+        benchMix("set=1,get=1"),
+        benchKeyspace(100000),
+        benchValueSize(3),
+        benchValueType("string") {}
+
+  /** @brief Read cache settings from the --cache flags. */
+  KvCacheConfig cacheConfig() const {
+    KvCacheConfig config;
+    config.maxBytes = cacheSize * 1024 * 1024;
+    config.ttl = std::chrono::milliseconds(cacheTtl);
+    config.eviction = cacheEviction == "clock" ? KvEviction::CLOCK : KvEviction::LRU;
+    return config;
+  }
+};
 
 namespace arg {
 
 /**
- * @brief Parses command-line options into KvConnectionInfo.
+ * @brief Parses command-line options into KvConnectionInfo and KvCliOptions.
  *
- * Supports -p, -h, -U, -P, and -url flags.
+ * Supports -p, -h, -s, -U, -P, and -url connection flags, plus:
+ *   - -url given more than once, or with a comma-separated list, fills
+ *     options.shards for client-side sharding
+ *   - --pipe               Pipelined batch mode (auto when stdin is not a TTY)
+ *   - -f <file>            Read pipe mode commands from a file
+ *   - --pipe-window <n>    Max commands in flight in pipe and import mode
+ *   - --raw, --csv, --json Print replies bare, as CSV or as JSON lines; log
+ *                          lines then go to stderr
+ *   - --connect-timeout <ms>  Deadline for opening a connection
+ *   - --reconnect-attempts <n>  Reconnect attempts after a lost connection;
+ *                          --no-reconnect disables reconnecting
+ *   - --cache              Cache reads in the REPL and pipe mode, tuned with
+ *                          --cache-size <MiB>, --cache-ttl <ms> and
+ *                          --cache-eviction lru|clock
+ *   - --import <file>      Bulk-load a memory-mapped file
+ *   - --import-format <f>  auto, csv, tsv, commands, resp or snapshot
+ *   - --export <file>      Write every string key to a binary snapshot
+ *   - --export-connections <n>  Connections fetching values in parallel
+ *   - --latency            Latency monitor; --latency-history and
+ *                          --latency-dist add per-interval lines or a
+ *                          heatmap, --interval <s> sets the interval
+ *   - --bench              Load generator, tuned with --clients, --threads,
+ *                          --requests, --pipeline, --mix, --keyspace,
+ *                          --value-size and --value-type
+ *   - --capture <file>     Record every frame sent and received, with
+ *                          timestamps, to a binary capture file
+ *   - --metrics-file <file>  Prometheus textfile rewritten every
+ *                          --metrics-interval <s> seconds
+ *   - --metrics-json <file>  JSON dump of the metrics at exit
+ *   - --replay <file>      Replay a capture, tuned with --replay-speed <x|max>
+ *                          and --replay-connections <n>
+ *   - --log-level <level>  debug, info, warn, error or off (default: info;
+ *                          error for a one-shot command)
+ *   - --startup-trace      Print how long each startup phase took
+ *   - --max-reply-bytes <n>  Receive buffer size (K, M or G suffix allowed)
+ *                          beyond which a reply spills to a temporary file
+ *   - --out <file>         Stream a one-shot command's bulk reply into a file
+ *                          ("-" = stdout) instead of printing it
+ *   - The first argument that is not a flag starts a one-shot command;
+ *     it and everything after it are sent as one command
  *
  * Exits on missing required values or invalid URI.
  *
- * @param argc Number of CLI args.
- * @param argv Array of arg strings.
- * @param info  Output connection info to populate.
+ * @param argc    Number of CLI args.
+ * @param argv    Array of arg strings.
+ * @param info    Output connection info to populate.
+ * @param options Output run mode options to populate.
  */
-void parse(int argc, char* argv[], KvConnectionInfo& info);
+void parse(int argc, char* argv[], KvConnectionInfo& info, KvCliOptions& options);
 
 }  // namespace arg
 
@@ -0,0 +1,198 @@
+/**
+ * @file async_client.hpp
+ * @brief KvEventLoop and KvAsyncClient class declarations.
+ */
+
+#ifndef _CLI_ASYNC_CLIENT_HPP_
+#define _CLI_ASYNC_CLIENT_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "client.hpp"
+#include "dial.hpp"
+#include "resp_reader.hpp"
+
+#if __cplusplus >= 202002L && __has_include(<coroutine>)
+#include <coroutine>
+#define KV_HAS_COROUTINES 1
+#endif
+
+class KvAsyncClient;
+
+/**
+ * @class KvEventLoop
+ * @brief epoll-based event loop that drives any number of KvAsyncClients.
+ *
+ * All socket I/O happens on the loop thread. Work submitted from other
+ * threads is queued with post() and picked up after an eventfd wake-up.
+ * epoll_wait() sleeps no longer than the earliest connect deadline of the
+ * clients it drives, so a connect to a blackholed address times out.
+ */
+class KvEventLoop {
+ private:
+  int epollFd;                                  /**< epoll instance */
+  int wakeFd;                                   /**< eventfd used by post() */
+  std::atomic<bool> running;                    /**< Cleared by stop() */
+  std::atomic<std::thread::id> loopThread;      /**< Thread inside run() */
+  std::thread thread;                           /**< Thread started by start() */
+  std::mutex mutex;                             /**< Guards tasks */
+  std::vector<std::function<void()>> tasks;     /**< Work posted from other threads */
+  std::vector<KvAsyncClient*> dirty;            /**< Clients with unsent output */
+  std::vector<KvAsyncClient*> timed;            /**< Clients connecting under a deadline */
+
+  friend class KvAsyncClient;
+  bool watch(int fd, uint32_t events, KvAsyncClient* client, bool add);
+  void unwatch(int fd);
+  void markDirty(KvAsyncClient* client);
+  void forget(KvAsyncClient* client);
+  int waitTimeout() const;
+  void expireConnects();
+
+ public:
+  /** @brief Creates the epoll instance and wake-up eventfd. */
+  KvEventLoop();
+
+  /** @brief Stops the loop thread (if any) and closes the descriptors. */
+  ~KvEventLoop();
+
+  KvEventLoop(const KvEventLoop&) = delete;
+  KvEventLoop& operator=(const KvEventLoop&) = delete;
+
+  /** @name Loop control */
+  //@{
+  void run();
+  void start();
+  void stop();
+  //@}
+
+  /** @name Task submission */
+  //@{
+  void post(std::function<void()> task);
+  bool inLoopThread() const;
+  //@}
+};
+
+/**
+ * @class KvAsyncClient
+ * @brief Non-blocking RESP connection with any number of outstanding commands.
+ *
+ * Commands are queued in submission order and replies are matched to them
+ * in the same order. Completion is reported through a callback, invoked on
+ * the loop thread, or through a std::future. Methods may be called from
+ * any thread.
+ */
+class KvAsyncClient {
+ public:
+  /**
+   * @brief Completion callback.
+   *
+   * @param ok    True if a reply arrived; false if the connection failed.
+   * @param reply Raw RESP reply, or an error message when !ok. Only valid
+   *              for the duration of the call.
+   */
+  using Callback = std::function<void(bool ok, std::string_view reply)>;
+
+ private:
+  /** @brief Connection lifecycle. */
+  enum class State { IDLE, CONNECTING, AUTHENTICATING, READY, CLOSED };
+
+  KvEventLoop& loop;                                     /**< Loop driving this connection */
+  KvConnectionInfo info;                                 /**< Connection parameters */
+  int fd;                                                /**< Non-blocking socket */
+  State state;                                           /**< Current lifecycle stage */
+  bool wantWrite;                                        /**< EPOLLOUT is registered */
+  bool flushQueued;                                      /**< Already on the loop's dirty list */
+  std::string outbox;                                    /**< Encoded commands not yet written */
+  size_t written;                                        /**< Bytes of outbox already sent */
+  std::deque<Callback> waiting;                          /**< One callback per queued command, in order */
+  resp::Reader reader;                                   /**< Frame-complete receive buffer */
+  std::function<void(bool)> onConnect;                   /**< Completion of connect() */
+  std::atomic<size_t> outstanding;                       /**< Commands without a reply yet */
+  std::vector<KvAddress> addresses;                      /**< Resolved addresses, in connection order */
+  size_t nextAddress;                                    /**< Next entry of `addresses` to try */
+  std::chrono::steady_clock::time_point connectDeadline; /**< End of the whole connect */
+  std::chrono::steady_clock::time_point attemptDeadline; /**< End of the current address's attempt */
+
+  friend class KvEventLoop;
+  void dispatch(std::function<void()> task);
+  void startConnect();
+  void connectNext(const std::string& reason);
+  void enqueue(std::string command, Callback callback);
+  void handleEvents(uint32_t events);
+  void finishConnect();
+  void flush();
+  void readReplies();
+  void fail(const std::string& reason, bool report = true);
+
+ public:
+  /**
+   * @brief Creates an unconnected client bound to a loop.
+   *
+   * @param loop Event loop that will drive the socket.
+   * @param info Host, port and optional AUTH credentials.
+   */
+  KvAsyncClient(KvEventLoop& loop, const KvConnectionInfo& info);
+
+  /** @brief Closes the connection; pending callbacks fail. */
+  ~KvAsyncClient();
+
+  KvAsyncClient(const KvAsyncClient&) = delete;
+  KvAsyncClient& operator=(const KvAsyncClient&) = delete;
+
+  /** @name Connection methods */
+  //@{
+  void connect(std::function<void(bool)> done);
+  std::future<bool> connect();
+  void close();
+  //@}
+
+  /** @name Communication */
+  //@{
+  void send(std::string command, Callback callback);
+  std::future<std::string> send(std::string command);
+  size_t pending() const;
+  //@}
+
+#ifdef KV_HAS_COROUTINES
+  /**
+   * @class Awaitable
+   * @brief `co_await client.command(...)` support when built as C++20.
+   *
+   * The coroutine resumes on the loop thread with the raw RESP reply, or
+   * throws std::runtime_error if the connection failed.
+   */
+  class Awaitable {
+   private:
+    KvAsyncClient& client;
+    std::string command;
+    bool ok;
+    std::string result;
+
+   public:
+    Awaitable(KvAsyncClient& client, std::string command) : client(client), command(std::move(command)), ok(false) {}
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) {
+      client.send(std::move(command), [this, handle](bool success, std::string_view reply) {
+        ok = success;
+        result.assign(reply.data(), reply.size());
+        handle.resume();
+      });
+    }
+    std::string await_resume() {
+      if (!ok) throw std::runtime_error(result);
+      return std::move(result);
+    }
+  };
+
+  /** @brief Awaitable form of send(). */
+  Awaitable command(std::string command) { return Awaitable(*this, std::move(command)); }
+#endif
+};
+
+#endif  // _CLI_ASYNC_CLIENT_HPP_
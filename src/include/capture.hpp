@@ -0,0 +1,157 @@
+/**
+ * @file capture.hpp
+ * @brief Binary traffic capture of the RESP frames a KvClient sends and receives.
+ *
+ * Layout (all integers little-endian):
+ *
+ *     header   "KVCAPT" 0x00 0x01                   magic and format version
+ *              u64 monotonic ns, u64 realtime ns     clocks when the capture started
+ *     records  { u32 payload length, u32 connection id, u64 monotonic ns,
+ *                u8 direction, 7 bytes zero, payload, zero padding to 8 } ...
+ *
+ * A record with payload length 0 ends the log: the file is grown ahead of
+ * the writers and zero-filled, so a capture cut short by a crash still reads
+ * cleanly up to its last complete record. Sent records hold whatever one
+ * sendCommand() call wrote, which may be several pipelined commands;
+ * received records hold exactly one reply frame, except that a bulk string
+ * streamed to a file is recorded as its `$<length>` header alone.
+ */
+
+#ifndef _CLI_CAPTURE_HPP_
+#define _CLI_CAPTURE_HPP_
+
+#include <sys/uio.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "mapped_file.hpp"
+
+namespace capture {
+
+/** @brief File header: magic plus a version byte. */
+constexpr std::string_view MAGIC("KVCAPT\0\1", 8);
+
+constexpr size_t HEADER_SIZE = 24;        /**< Magic and the two start clocks */
+constexpr size_t RECORD_HEADER_SIZE = 24; /**< Length, connection, time, direction */
+
+/** @brief Recorded in place of an AUTH command, whose arguments are left out. */
+constexpr std::string_view REDACTED_AUTH = "*1\r\n$4\r\nAUTH\r\n";
+
+/** @brief Which way a record's bytes went. */
+enum class Direction : uint8_t { SENT = 1, RECEIVED = 2 };
+
+/** @brief Monotonic clock in nanoseconds, as stored in records. */
+uint64_t now_ns();
+
+}  // namespace capture
+
+/**
+ * @class KvCapture
+ * @brief Append-only, memory-mapped log of client traffic.
+ *
+ * A large range of address space is mapped once over the file, and the file
+ * is extended in steps ahead of the writers, so the mapping never moves.
+ * Writers reserve space with one atomic add and copy their record in
+ * parallel; only the writer that crosses into a new step takes a lock, to
+ * grow the file. close() trims the file to the records written.
+ *
+ * One capture is installed process-wide; every KvClient records into it.
+ */
+class KvCapture {
+ private:
+  std::string path;                /**< Capture file name, for the summary */
+  int fd;                          /**< Capture file, -1 when closed */
+  char* base;                      /**< Start of the mapping */
+  size_t reserved;                 /**< Bytes of address space mapped */
+  std::atomic<uint64_t> tail;      /**< Next free byte */
+  std::atomic<uint64_t> allocated; /**< Bytes the file has been grown to */
+  std::atomic<bool> full;          /**< The reservation ran out; records are dropped */
+  std::atomic<uint64_t> records;   /**< Records written */
+  std::atomic<uint64_t> dropped;   /**< Records that did not fit */
+  std::mutex growLock;             /**< Serializes growing the file */
+
+  static std::atomic<KvCapture*> active; /**< Installed capture */
+
+  char* reserve(size_t bytes);
+
+ public:
+  /** @brief Creates a closed capture. */
+  KvCapture();
+
+  /** @brief Closes the file, trimming it to the records written. */
+  ~KvCapture();
+
+  KvCapture(const KvCapture&) = delete;
+  KvCapture& operator=(const KvCapture&) = delete;
+
+  /** @name File */
+  //@{
+  bool open(const std::string& file, std::string& error);
+  void close();
+  //@}
+
+  /** @name Recording (thread-safe) */
+  //@{
+  void record(uint32_t connection, capture::Direction direction, std::string_view payload);
+  void record(uint32_t connection, capture::Direction direction, const struct iovec* iov, size_t count);
+  //@}
+
+  /** @brief Records written so far. */
+  uint64_t recordCount() const { return records.load(std::memory_order_relaxed); }
+  /** @brief Records dropped because the capture was full. */
+  uint64_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+  /** @brief Bytes written so far, header included. */
+  uint64_t size() const { return tail.load(std::memory_order_relaxed); }
+
+  /** @name Process-wide capture */
+  //@{
+  static void install(KvCapture* capture);
+  /** @brief The installed capture, or null; one atomic load on the hot path. */
+  static KvCapture* current() { return active.load(std::memory_order_acquire); }
+  //@}
+};
+
+/**
+ * @class KvCaptureReader
+ * @brief Reads the records of a capture file in the order they were written.
+ *
+ * The file is mapped, so payloads are views into it and stay valid while
+ * the reader is open.
+ */
+class KvCaptureReader {
+ public:
+  /** @brief One record; `payload` points into the mapping. */
+  struct Record {
+    uint32_t connection;          /**< Client the bytes belong to */
+    capture::Direction direction; /**< Sent or received */
+    uint64_t stamp;               /**< Monotonic ns when recorded */
+    std::string_view payload;     /**< The bytes */
+  };
+
+ private:
+  KvMappedFile file;   /**< Mapped capture */
+  size_t offset;       /**< Next record */
+  uint64_t monotonic;  /**< Monotonic ns at the start of the capture */
+  uint64_t realtime;   /**< Wall clock ns at the start of the capture */
+  bool truncated;      /**< A record ran past the end of the file */
+
+ public:
+  /** @brief Creates a closed reader. */
+  KvCaptureReader();
+
+  bool open(const std::string& path, std::string& error);
+  bool next(Record& record);
+
+  /** @brief Monotonic ns when the capture started, comparable to Record::stamp. */
+  uint64_t startTime() const { return monotonic; }
+  /** @brief Wall clock ns when the capture started. */
+  uint64_t startRealtime() const { return realtime; }
+  /** @brief True if reading stopped at a record cut off by the end of the file. */
+  bool isTruncated() const { return truncated; }
+};
+
+#endif  // _CLI_CAPTURE_HPP_
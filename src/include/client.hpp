@@ -6,7 +6,12 @@
 #ifndef _CLI_CLIENT_HPP_
 #define _CLI_CLIENT_HPP_
 
+#include <chrono>
+#include <random>
+
 #include "include.hpp"
+#include "resp.hpp"
+#include "resp_reader.hpp"
 
 /**
  * @class KvConnectionInfo
@@ -14,12 +19,14 @@
  */
 class KvConnectionInfo {
  public:
-  std::string host;     /**< Server hostname or IP */
-  int port;             /**< Server port */
-  std::string user;     /**< Username for AUTH */
-  std::string password; /**< Password for AUTH */
-  std::string url;      /**< Full connection URI */
-  bool requireAuth;     /**< Indicates if AUTH is required */
+  std::string host;                         /**< Server hostname or IP */
+  int port;                                 /**< Server port */
+  std::string socketPath;                   /**< Unix domain socket; replaces host/port when set */
+  std::string user;                         /**< Username for AUTH */
+  std::string password;                     /**< Password for AUTH */
+  std::string url;                          /**< Full connection URI */
+  bool requireAuth;                         /**< Indicates if AUTH is required */
+  std::chrono::milliseconds connectTimeout; /**< Deadline for opening a connection (0 = none) */
 
   /**
    * @brief Default constructor initializes defaults.
@@ -27,16 +34,44 @@ class KvConnectionInfo {
   KvConnectionInfo()
       : host("127.0.0.1"),
         port(6379),
+        socketPath(""),
         user(""),  // initialize user/password too
         password(""),
         url(""),  // initialize url
-        requireAuth(false) {}
+        requireAuth(false),
+        connectTimeout(5000) {}
 
   /** @brief Set username. */
   void setUser(const std::string& user) { this->user = user; }
 
   /** @brief Set password. */
   void setPassword(const std::string& password) { this->password = password; }
+
+  /** @brief Socket path, or host:port with IPv6 literals bracketed. */
+  std::string endpoint() const {
+    if (!socketPath.empty()) return socketPath;
+    return (host.find(':') != std::string::npos ? "[" + host + "]" : host) + ":" + std::to_string(port);
+  }
+};
+
+/**
+ * @class KvReconnectPolicy
+ * @brief Retry schedule used by KvClient::reconnect().
+ *
+ * The delay ceiling doubles from baseDelay up to maxDelay, and each wait is
+ * drawn uniformly below the ceiling ("full jitter"). Clients that lost the
+ * same server then do not all reconnect at the same moment.
+ */
+class KvReconnectPolicy {
+ public:
+  size_t maxAttempts;                  /**< Attempts per reconnect (0 = never reconnect) */
+  std::chrono::milliseconds baseDelay; /**< First delay ceiling */
+  std::chrono::milliseconds maxDelay;  /**< Largest delay ceiling */
+
+  /**
+   * @brief Default constructor initializes defaults.
+   */
+  KvReconnectPolicy() : maxAttempts(10), baseDelay(100), maxDelay(5000) {}
 };
 
 /**
@@ -45,13 +80,20 @@ class KvConnectionInfo {
  */
 class KvClient {
  private:
-  std::string addr;                /**< Address string for prompts */
-  int sock;                        /**< Socket descriptor (unused) */
-  bool connected;                  /**< Connection state flag */
-  bool authenticated;              /**< AUTH state flag */
-  KvConnectionInfo connectionInfo; /**< Connection parameters */
-  int BUFFER_SIZE;                 /**< Size of receive buffer */
-  int socket_fd;                   /**< Active socket file descriptor */
+  std::string addr;                  /**< Address string for prompts */
+  int sock;                          /**< Socket descriptor (unused) */
+  bool connected;                    /**< Connection state flag */
+  bool authenticated;                /**< AUTH state flag */
+  KvConnectionInfo connectionInfo;   /**< Connection parameters */
+  int BUFFER_SIZE;                   /**< Size of receive buffer */
+  int socket_fd;                     /**< Active socket file descriptor */
+  resp::Reader reader;               /**< Frame-complete receive buffer */
+  KvReconnectPolicy reconnectPolicy; /**< Backoff used by reconnect() */
+  std::minstd_rand jitter;           /**< Random source for backoff jitter */
+  uint32_t captureId;                /**< Connection id in a traffic capture */
+  std::string selectCommand;         /**< Last accepted SELECT, re-sent by reconnect() */
+
+  bool fill(size_t want);
 
  public:
   /** @brief Default constructor. */
@@ -63,6 +105,8 @@ class KvClient {
   /** @name Connection methods */
   //@{
   bool connect(const std::string& host, int port);
+  bool authenticate(std::string& reply);
+  bool reconnect();
   void disconnect();
   //@}
 
@@ -79,12 +123,19 @@ class KvClient {
   void setAuthenticated(bool auth);
   void setConnectionInfo(const KvConnectionInfo& info);
   void setConnectionInfoFromAuthCommand(const std::string& authCommand);
+  void setReconnectPolicy(const KvReconnectPolicy& policy);
+  void noteReply(std::string_view command, std::string_view reply);
   //@}
 
   /** @name Communication */
   //@{
-  bool sendCommand(const std::string& command);
+  bool sendCommand(std::string_view command);
+  bool sendCommand(const resp::Buffer& command);
   std::string receiveResponse();
+  bool receiveFrame(std::string_view& frame);
+  bool receiveInto(int fd, std::string_view& frame, int64_t& streamed);
+  bool request(const resp::Buffer& command, bool idempotent, std::string_view& reply);
+  bool requestInto(const resp::Buffer& command, int fd, std::string_view& reply, int64_t& streamed);
   //@}
 };
 
@@ -0,0 +1,90 @@
+/**
+ * @file dial.hpp
+ * @brief Name resolution and timed TCP connection setup.
+ */
+
+#ifndef _CLI_DIAL_HPP_
+#define _CLI_DIAL_HPP_
+
+#include <sys/socket.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * @class KvAddress
+ * @brief One resolved socket address (IPv4, IPv6 or Unix domain).
+ */
+class KvAddress {
+ public:
+  sockaddr_storage storage; /**< Address with port */
+  socklen_t length;         /**< Bytes of `storage` in use */
+
+  /** @brief Address family: AF_INET, AF_INET6 or AF_UNIX. */
+  int family() const { return storage.ss_family; }
+
+  /** @brief Numeric form, e.g. "127.0.0.1:6379", "[::1]:6379" or a socket path. */
+  std::string text() const;
+};
+
+namespace network {
+
+/** @brief Delay before racing the next address while one is pending (RFC 8305). */
+constexpr std::chrono::milliseconds ATTEMPT_DELAY(250);
+
+/**
+ * @brief Resolves a host name or literal address with getaddrinfo.
+ *
+ * Addresses are interleaved by family, starting with the family the
+ * resolver preferred, so a dead IPv6 path is quickly followed by IPv4.
+ *
+ * @param host      Name, IPv4 literal or IPv6 literal (without brackets).
+ * @param port      TCP port.
+ * @param addresses Output addresses in connection order.
+ * @param error     Resolver message on failure.
+ * @return False if the name could not be resolved.
+ */
+bool resolve(const std::string& host, int port, std::vector<KvAddress>& addresses, std::string& error);
+
+/**
+ * @brief Builds the address of a Unix domain socket.
+ *
+ * @param path    Socket file path.
+ * @param address Output address.
+ * @param error   Reason when the path does not fit in sockaddr_un.
+ * @return False if the path is empty or too long.
+ */
+bool unix_address(const std::string& path, KvAddress& address, std::string& error);
+
+/**
+ * @brief Connects to a Unix domain socket.
+ *
+ * Local connects do not wait on the network, so no timeout is applied.
+ *
+ * @param path  Socket file path.
+ * @param peer  Output address that was connected.
+ * @param error Reason on failure.
+ * @return Connected blocking socket, or -1.
+ */
+int dial_unix(const std::string& path, KvAddress& peer, std::string& error);
+
+/**
+ * @brief Connects to the first reachable address of `host` (happy eyeballs).
+ *
+ * Non-blocking connects are started ATTEMPT_DELAY apart, or at once when the
+ * previous one fails, and the first to complete wins. The whole dial gives
+ * up after `timeout` (zero = only the kernel's own limits apply).
+ *
+ * @param host    Name or literal address.
+ * @param port    TCP port.
+ * @param timeout Overall deadline.
+ * @param peer    Output address that was connected.
+ * @param error   Reason on failure.
+ * @return Connected blocking socket, or -1.
+ */
+int dial(const std::string& host, int port, std::chrono::milliseconds timeout, KvAddress& peer, std::string& error);
+
+}  // namespace network
+
+#endif  // _CLI_DIAL_HPP_
@@ -0,0 +1,58 @@
+/**
+ * @file histogram.hpp
+ * @brief KvHistogram class declaration for latency percentiles.
+ */
+
+#ifndef _CLI_HISTOGRAM_HPP_
+#define _CLI_HISTOGRAM_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @class KvHistogram
+ * @brief Log-linear (HDR-style) histogram of non-negative integer samples.
+ *
+ * Each power-of-two range is split into 128 linear sub-buckets, so any
+ * reported value is within 1% of the recorded one while memory stays fixed
+ * no matter how many samples are recorded. Histograms with the same layout
+ * can be merged, which lets each worker thread record without locking.
+ */
+class KvHistogram {
+ private:
+  std::vector<uint64_t> buckets; /**< Sample count per bucket */
+  uint64_t total;                /**< Number of samples */
+  uint64_t minValue;             /**< Smallest sample (exact) */
+  uint64_t maxValue;             /**< Largest sample (exact) */
+  long double sum;               /**< Sum of samples, for the mean */
+
+  static size_t indexOf(uint64_t value);
+  static uint64_t upperBound(size_t index);
+
+ public:
+  /** @brief Creates an empty histogram. */
+  KvHistogram();
+
+  /** @name Recording */
+  //@{
+  void record(uint64_t value);
+  void merge(const KvHistogram& other);
+  void reset();
+  //@}
+
+  /** @name Statistics */
+  //@{
+  uint64_t count() const;
+  uint64_t min() const;
+  uint64_t max() const;
+  double mean() const;
+  uint64_t percentile(double p) const;
+  //@}
+};
+
+/** @brief Format a nanosecond sample as milliseconds with three decimals. */
+std::string format_ms(uint64_t ns);
+
+#endif  // _CLI_HISTOGRAM_HPP_
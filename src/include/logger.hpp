@@ -1,122 +1,154 @@
 /**
  * @file logger.hpp
  * @brief ANSI-colored logging utilities with severity levels.
+ *
+ * Log lines are filtered twice: levels below KV_LOG_MIN_LEVEL (set with the
+ * KV_LOG_LEVEL CMake option) are compiled out, and levels below the runtime
+ * threshold (--log-level) return after one relaxed load. Lines that pass
+ * are queued in a lock-free ring and written by a background thread, so a
+ * log call never waits on the terminal.
  */
 
 #ifndef _LOGGER_HPP_
 #define _LOGGER_HPP_
 
-#include <iostream>
+#include <atomic>
 #include <string>
+#include <utility>
 
 namespace Logger {
 
 /**
  * @enum Level
- * @brief Log severity levels.
+ * @brief Log severity levels, least severe first.
  */
-enum class Level { INFO, WARN, ERROR, SUCCESS, CLIENT, DEBUG };
+enum class Level { DEBUG, INFO, SUCCESS, CLIENT, WARN, ERROR, OFF };
+
+#ifndef KV_LOG_MIN_LEVEL
+#define KV_LOG_MIN_LEVEL Logger::Level::DEBUG
+#endif
+
+/** @brief Least severe level compiled in; calls below it compile to nothing. */
+constexpr Level COMPILED_LEVEL = KV_LOG_MIN_LEVEL;
+
+/** @brief True if `level` survives compile-time filtering. */
+constexpr bool compiled(Level level) {
+  return level >= COMPILED_LEVEL;
+}
 
-// ANSI escape codes
-const std::string RESET = "\033[0m";
-const std::string BOLD = "\033[1m";
+/** @brief Runtime threshold; INFO unless changed with setLevel(). */
+inline std::atomic<Level>& threshold() {
+  static std::atomic<Level> level(Level::INFO);
+  return level;
+}
 
-const std::string RED = "\033[31m";
-const std::string GREEN = "\033[32m";
-const std::string YELLOW = "\033[33m";
-const std::string BLUE = "\033[34m";
+/** @brief True if a line at `level` would be written. */
+inline bool enabled(Level level) {
+  return compiled(level) && level >= threshold().load(std::memory_order_relaxed);
+}
+
+/** @brief Set the runtime threshold (Level::OFF silences everything). */
+inline void setLevel(Level level) {
+  threshold().store(level, std::memory_order_relaxed);
+}
+
+bool parseLevel(const std::string& name, Level& level);
 
 /**
- * @brief Core logging function.
+ * @brief Send log lines to `fd` (stdout by default).
+ *
+ * Switched to stderr when stdout carries machine-readable output (--raw,
+ * --csv, --json, one-shot replies). Colors are used only if `fd` is a TTY.
+ */
+void setOutput(int fd);
+
+/**
+ * @brief Queue one line for the writer thread.
  *
- * Applies color/style, tag, and prints to stdout or stderr.
+ * Blocks only while the ring is full.
+ *
+ * @param level   Severity level; not filtered again.
+ * @param message Line without the trailing newline.
+ */
+void write(Level level, std::string message);
+
+/**
+ * @brief Wait until every queued line has been written.
+ *
+ * Call before writing to the same terminal from another path (a prompt, a
+ * report table), so the two stay in order.
+ */
+void flush();
+
+/**
+ * @brief Core logging function.
  *
  * @param level   Severity level.
  * @param message Message to log.
  */
-inline void log(Level level, const std::string& message) {
-  std::string tag;
-  std::string color;
-  bool new_line = true;
-
-  switch (level) {
-    case Level::INFO:
-      tag = "[INFO]   ";
-      color = BLUE;
-      break;
-    case Level::WARN:
-      tag = "[WARN]   ";
-      color = YELLOW;
-      break;
-    case Level::ERROR:
-      tag = "[ERROR]  ";
-      color = RED;
-      break;
-    case Level::SUCCESS:
-      tag = "[SUCCESS]";
-      color = GREEN;
-      break;
-    case Level::CLIENT:
-      tag = "[CLIENT] ";
-      color = BLUE;
-      new_line = false;
-      break;
-    case Level::DEBUG:
-      tag = "[DEBUG]  ";
-      color = GREEN;
-      new_line = true;
-      break;
-  }
-
-  if (new_line) {
-    std::cout << BOLD << color << tag << RESET << " " << message << std::endl;
-  } else {
-    std::cout << BOLD << color << tag << RESET << " " << message;
-  }
+inline void log(Level level, std::string message) {
+  if (enabled(level)) write(level, std::move(message));
 }
 
 /**
  * @brief Shortcut for INFO level.
  */
-inline void info(const std::string& message) {
-  log(Level::INFO, message);
+inline void info(std::string message) {
+  if constexpr (compiled(Level::INFO)) log(Level::INFO, std::move(message));
 }
 
 /**
  * @brief Shortcut for DEBUG level.
+ *
+ * The message is built even when DEBUG is filtered out; use KV_LOG(DEBUG,
+ * ...) where building it costs.
  */
-inline void debug(const std::string& message) {
-  log(Level::DEBUG, message);
+inline void debug(std::string message) {
+  if constexpr (compiled(Level::DEBUG)) log(Level::DEBUG, std::move(message));
 }
 
 /**
  * @brief Shortcut for WARN level.
  */
-inline void warn(const std::string& message) {
-  log(Level::WARN, message);
+inline void warn(std::string message) {
+  if constexpr (compiled(Level::WARN)) log(Level::WARN, std::move(message));
 }
 
 /**
  * @brief Shortcut for ERROR level.
  */
-inline void error(const std::string& message) {
-  log(Level::ERROR, message);
+inline void error(std::string message) {
+  if constexpr (compiled(Level::ERROR)) log(Level::ERROR, std::move(message));
 }
 
 /**
  * @brief Shortcut for SUCCESS level.
  */
-inline void success(const std::string& message) {
-  log(Level::SUCCESS, message);
+inline void success(std::string message) {
+  if constexpr (compiled(Level::SUCCESS)) log(Level::SUCCESS, std::move(message));
 }
 
 /**
  * @brief Client prompt style (no newline).
  */
-inline void client(const std::string& message) {
-  log(Level::CLIENT, message);
+inline void client(std::string message) {
+  if constexpr (compiled(Level::CLIENT)) log(Level::CLIENT, std::move(message));
 }
 
 }  // namespace Logger
 
+/**
+ * @brief Log at `level` (DEBUG, INFO, ...) without evaluating `message`
+ *        unless the line will be written.
+ *
+ * Below KV_LOG_MIN_LEVEL the whole statement, message included, compiles
+ * to nothing.
+ */
+#define KV_LOG(level, message)                                                                   \
+  do {                                                                                           \
+    if constexpr (Logger::compiled(Logger::Level::level)) {                                      \
+      if (Logger::enabled(Logger::Level::level)) Logger::write(Logger::Level::level, (message)); \
+    }                                                                                            \
+  } while (0)
+
 #endif  // _LOGGER_HPP_
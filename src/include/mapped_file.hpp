@@ -0,0 +1,48 @@
+/**
+ * @file mapped_file.hpp
+ * @brief KvMappedFile class declaration for read-only memory-mapped input.
+ */
+
+#ifndef _CLI_MAPPED_FILE_HPP_
+#define _CLI_MAPPED_FILE_HPP_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @class KvMappedFile
+ * @brief Maps a whole file read-only so it can be parsed in place.
+ *
+ * The mapping is advised for sequential access, letting the kernel read
+ * ahead while records are encoded straight out of the page cache.
+ */
+class KvMappedFile {
+ private:
+  const char* base; /**< Start of the mapping (null when closed or empty) */
+  size_t length;    /**< File size in bytes */
+
+ public:
+  /** @brief Creates a closed mapping. */
+  KvMappedFile();
+
+  /** @brief Unmaps the file. */
+  ~KvMappedFile();
+
+  KvMappedFile(const KvMappedFile&) = delete;
+  KvMappedFile& operator=(const KvMappedFile&) = delete;
+
+  /** @name Mapping */
+  //@{
+  bool open(const std::string& path);
+  void close();
+  //@}
+
+  /** @name Contents */
+  //@{
+  std::string_view view() const;
+  size_t size() const;
+  //@}
+};
+
+#endif  // _CLI_MAPPED_FILE_HPP_
@@ -0,0 +1,140 @@
+/**
+ * @file metrics.hpp
+ * @brief KvMetrics, the process-wide registry of client counters and
+ *        histograms, and KvMetricsExporter, which writes it out.
+ */
+
+#ifndef _CLI_METRICS_HPP_
+#define _CLI_METRICS_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "histogram.hpp"
+
+/**
+ * @class KvMetrics
+ * @brief Request, error, byte, latency and reply-size statistics.
+ *
+ * Every thread records into a shard of its own, so recording takes only an
+ * uncontended lock; snapshot() merges the shards. Per-command statistics
+ * are keyed by the upper-cased command name. Names that do not look like a
+ * command, and names past the first MAX_COMMANDS, are counted as OTHER so
+ * piped garbage cannot grow the registry.
+ */
+class KvMetrics {
+ public:
+  /** @brief Statistics of one command. */
+  struct CommandStats {
+    uint64_t requests = 0;  /**< Replies received */
+    uint64_t errors = 0;    /**< Error replies */
+    KvHistogram latency;    /**< Round trip in nanoseconds */
+    KvHistogram replyBytes; /**< Raw reply size in bytes */
+  };
+
+  /** @brief Merged view of every shard. */
+  struct Snapshot {
+    std::map<std::string, CommandStats> commands; /**< By command name */
+    uint64_t bytesOut = 0;                        /**< Bytes written to servers */
+    uint64_t bytesIn = 0;                         /**< Bytes read from servers */
+    uint64_t sends = 0;                           /**< Socket sends (a pipelined batch is one) */
+    uint64_t frames = 0;                          /**< Reply frames received */
+    uint64_t reconnects = 0;                      /**< Successful reconnects */
+    double uptime = 0;                            /**< Seconds since the registry was created */
+  };
+
+  static constexpr size_t MAX_COMMANDS = 128; /**< Distinct names per shard before OTHER */
+
+ private:
+  /** @brief One thread's statistics. */
+  struct Shard {
+    std::atomic<uint64_t> bytesOut{0};
+    std::atomic<uint64_t> bytesIn{0};
+    std::atomic<uint64_t> sends{0};
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> reconnects{0};
+    std::mutex mutex;                                          /**< Guards commands */
+    std::map<std::string, CommandStats, std::less<>> commands; /**< By command name */
+  };
+
+  std::mutex mutex;                           /**< Guards shards */
+  std::vector<std::unique_ptr<Shard>> shards; /**< Never freed: a finished thread's counts still add up */
+  std::chrono::steady_clock::time_point started;
+
+  KvMetrics();
+  Shard& local();
+
+ public:
+  KvMetrics(const KvMetrics&) = delete;
+  KvMetrics& operator=(const KvMetrics&) = delete;
+
+  /** @brief The registry. */
+  static KvMetrics& global();
+
+  /** @name Recording (thread-safe) */
+  //@{
+  void sent(size_t bytes);
+  void received(size_t bytes);
+  void frame();
+  void reconnected();
+  void reply(std::string_view command, std::chrono::steady_clock::duration latency, std::string_view reply);
+  void reply(std::string_view command, std::chrono::steady_clock::duration latency, bool error, size_t bytes);
+  //@}
+
+  /** @name Reporting */
+  //@{
+  Snapshot snapshot();
+  static std::string table(const Snapshot& snapshot);
+  static std::string json(const Snapshot& snapshot);
+  static std::string prometheus(const Snapshot& snapshot);
+  //@}
+};
+
+/**
+ * @class KvMetricsExporter
+ * @brief Rewrites a Prometheus textfile periodically and dumps JSON at exit.
+ *
+ * The textfile is written to `<file>.tmp` and renamed, so the node
+ * exporter's textfile collector never reads a partial file. Both files are
+ * written once more when the exporter is destroyed.
+ */
+class KvMetricsExporter {
+ private:
+  std::string jsonFile;                /**< JSON dump at exit (empty = none) */
+  std::string textFile;                /**< Prometheus textfile (empty = none) */
+  std::chrono::seconds interval;       /**< Rewrite period of the textfile */
+  bool stopping;                       /**< Guarded by mutex */
+  std::mutex mutex;                    /**< Guards stopping */
+  std::condition_variable wake;        /**< Signals stopping */
+  std::thread thread;                  /**< Rewrites the textfile */
+
+  void run();
+
+ public:
+  /**
+   * @brief Starts the textfile thread if a textfile is set.
+   *
+   * @param jsonFile JSON dump written at exit (empty = none).
+   * @param textFile Prometheus textfile (empty = none).
+   * @param interval Seconds between textfile rewrites.
+   */
+  KvMetricsExporter(std::string jsonFile, std::string textFile, std::chrono::seconds interval);
+
+  /** @brief Stops the thread and writes both files one last time. */
+  ~KvMetricsExporter();
+
+  KvMetricsExporter(const KvMetricsExporter&) = delete;
+  KvMetricsExporter& operator=(const KvMetricsExporter&) = delete;
+
+  static bool writeFile(const std::string& path, const std::string& contents);
+};
+
+#endif  // _CLI_METRICS_HPP_
@@ -0,0 +1,141 @@
+/**
+ * @file modes.hpp
+ * @brief Non-interactive run modes selected from the command line.
+ */
+
+#ifndef _CLI_MODES_HPP_
+#define _CLI_MODES_HPP_
+
+#include "argument.hpp"
+#include "client.hpp"
+
+namespace mode {
+
+/**
+ * @brief One-shot mode: run `options.command` and exit.
+ *
+ * The words are encoded like one REPL line, except that each word stays
+ * one element even if it contains spaces. The reply is printed in
+ * `options.outputFormat`.
+ *
+ * @param client  Connected and authenticated client.
+ * @param options Parsed run mode options.
+ * @return reply_status() of the reply, or 1 if no reply arrived.
+ */
+int oneshot(KvClient& client, const KvCliOptions& options);
+
+/**
+ * @brief Exit code for a one-shot reply.
+ *
+ * @param reply Raw reply (attributes before it are skipped).
+ * @return 0 for a value, 2 for an error reply, 3 for a null reply
+ *         (`$-1`, `*-1`, `_`) and 1 if the reply is empty or malformed,
+ *         the same code as any other client-side failure.
+ */
+int reply_status(std::string_view reply);
+
+/**
+ * @brief Pipelined batch mode.
+ *
+ * Reads one command per line from stdin or `options.inputFile`, keeps up to
+ * `options.pipeWindow` commands in flight, prints every reply in input order
+ * and finishes with a sent/ok/error summary.
+ *
+ * @param client  Connected and authenticated client.
+ * @param options Parsed run mode options.
+ * @return Exit code (0 = every command succeeded).
+ */
+int pipe(KvClient& client, const KvCliOptions& options);
+
+/**
+ * @brief Memory-mapped bulk loader.
+ *
+ * Maps `options.importFile` and turns every record into one command: CSV
+ * and TSV key/value rows become SET, command files are encoded like REPL
+ * input, raw RESP frames are sent unchanged and snapshot records (see
+ * export_snapshot) become SET once their block checksum passes. Commands
+ * are pipelined with `options.pipeWindow` in flight; progress, rows/sec and
+ * per-row errors with their line numbers are reported.
+ *
+ * @param client  Connected and authenticated client.
+ * @param options Parsed run mode options.
+ * @return Exit code (0 = every row was imported).
+ */
+int import(KvClient& client, const KvCliOptions& options);
+
+/**
+ * @brief Parallel keyspace exporter.
+ *
+ * Enumerates keys with SCAN on one connection and fetches their values with
+ * pipelined GETs over `options.exportConnections` pooled connections. The
+ * values are written to `options.exportFile` in the binary snapshot format
+ * of snapshot.hpp, which import() loads back.
+ *
+ * @param info    Connection settings for the export connections.
+ * @param options Parsed run mode options.
+ * @return Exit code (0 = the snapshot was written).
+ */
+int export_snapshot(const KvConnectionInfo& info, const KvCliOptions& options);
+
+/**
+ * @brief Latency monitor.
+ *
+ * Sends PING over `client` every few milliseconds and records round-trip
+ * times in a KvHistogram until interrupted. Shows a rolling
+ * min/avg/percentile/max line; with `options.latencyHistory` a new line is
+ * started every interval, and with `options.latencyDist` each interval is
+ * drawn as a heatmap row.
+ *
+ * @param client  Connected and authenticated client.
+ * @param options Parsed run mode options.
+ * @return Exit code (0 = stopped by the user).
+ */
+int latency(KvClient& client, const KvCliOptions& options);
+
+/**
+ * @brief Load generator.
+ *
+ * Opens `options.benchClients` connections spread over a pool of worker
+ * threads and issues a weighted SET/GET/INCR/DEL mix with the configured
+ * pipeline depth, key space and value size. Prints throughput and
+ * p50/p90/p99/p99.9/max latency per command.
+ *
+ * @param info    Connection settings for the benchmark connections.
+ * @param options Parsed run mode options.
+ * @return Exit code (0 = run completed).
+ */
+int bench(const KvConnectionInfo& info, const KvCliOptions& options);
+
+/**
+ * @brief Traffic replay.
+ *
+ * Reads a capture written with --capture and sends every recorded command
+ * at its recorded time, scaled by `options.replaySpeed` (0 = as fast as
+ * possible, with `options.pipeWindow` commands in flight per connection).
+ * Recorded connections are spread over `options.replayConnections`
+ * connections; the commands of one recorded connection always share a
+ * connection, so their order is kept. Prints p50/p90/p99/p99.9/max latency
+ * and the number of replies that differ from the recorded ones.
+ *
+ * @param info    Connection settings for the replay connections.
+ * @param options Parsed run mode options.
+ * @return Exit code (0 = every reply arrived and matched the recording).
+ */
+int replay(const KvConnectionInfo& info, const KvCliOptions& options);
+
+/**
+ * @brief REPL and pipe mode over several servers.
+ *
+ * Connects to every node in `options.shards` and sends each command to the
+ * node that owns its key (see KvShardedClient). A one-shot command and
+ * interactive input are run one command at a time. Piped input is run in batches of
+ * `options.pipeWindow`, and every reply is printed in input order.
+ *
+ * @param options Parsed run mode options.
+ * @return Exit code (0 = every command succeeded).
+ */
+int sharded(const KvCliOptions& options);
+
+}  // namespace mode
+
+#endif  // _CLI_MODES_HPP_
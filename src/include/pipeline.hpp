@@ -0,0 +1,91 @@
+/**
+ * @file pipeline.hpp
+ * @brief KvPipeline class declaration for keeping many commands in flight.
+ */
+
+#ifndef _CLI_PIPELINE_HPP_
+#define _CLI_PIPELINE_HPP_
+
+#include <chrono>
+#include <deque>
+#include <functional>
+
+#include "client.hpp"
+
+/**
+ * @class KvPipeline
+ * @brief Batches RESP commands over one KvClient and matches replies in order.
+ *
+ * Commands are appended to an outgoing buffer and written in batches. Up to
+ * `window` commands may be unanswered at any time; replies are handed to the
+ * reply handler in the order the commands were pushed.
+ *
+ * The bytes of unanswered commands are kept until their reply arrives. If
+ * the connection drops, the client reconnects. Idempotent commands that were
+ * in flight are then replayed. Non-idempotent ones receive LOST_REPLY in
+ * their place, so a bulk job does not need to restart from zero.
+ */
+class KvPipeline {
+ public:
+  /** @brief Callback receiving the sequence number and raw RESP reply. */
+  using ReplyHandler = std::function<void(uint64_t seq, std::string_view reply)>;
+
+  /** @brief Reply reported for a non-idempotent command lost with its connection. */
+  static constexpr std::string_view LOST_REPLY = "-ERR connection lost before the reply; not replayed because the command is not idempotent\r\n";
+
+ private:
+  /** @brief Bookkeeping for one unanswered or queued command. */
+  struct Entry {
+    size_t length;                                /**< Bytes in `pending` (0 once lost) */
+    bool idempotent;                              /**< Safe to send again */
+    bool lost;                                    /**< Dropped with a connection; answered with LOST_REPLY */
+    std::chrono::steady_clock::time_point sentAt; /**< When its batch was written, for the latency metric */
+  };
+
+  KvClient& client;          /**< Connection the pipeline writes to */
+  size_t window;             /**< Max commands in flight */
+  ReplyHandler handler;      /**< Called once per reply, in order */
+  std::string pending;       /**< Unanswered then queued commands, oldest first */
+  size_t pendingHead;        /**< Start of the oldest unanswered command */
+  size_t sentBytes;          /**< End of the bytes already written */
+  std::deque<Entry> entries; /**< One per unanswered or queued command */
+  size_t queued;             /**< Commands not yet written */
+  size_t inFlight;           /**< Commands written (or lost) but not yet answered */
+  uint64_t sentCount;        /**< Commands written so far */
+  uint64_t replyCount;       /**< Replies received so far */
+  uint64_t replayCount;      /**< Commands written again after a reconnect */
+
+  static constexpr size_t FLUSH_BYTES = 64 * 1024; /**< Queued bytes that force a write */
+  static constexpr int MAX_RECOVERIES = 3;         /**< Reconnects tried per failure */
+
+  bool receiveOne();
+  bool recover();
+  void markSent();
+  void popFront();
+
+ public:
+  /**
+   * @brief Creates a pipeline on an already connected client.
+   *
+   * @param client  Connected (and authenticated) client.
+   * @param window  Max commands in flight; at least 1.
+   * @param handler Reply callback.
+   */
+  KvPipeline(KvClient& client, size_t window, ReplyHandler handler);
+
+  /** @name Pipelining */
+  //@{
+  bool push(std::string_view command);
+  bool flush();
+  bool drain();
+  //@}
+
+  /** @name Counters */
+  //@{
+  uint64_t sent() const;
+  uint64_t received() const;
+  uint64_t replayed() const;
+  //@}
+};
+
+#endif  // _CLI_PIPELINE_HPP_
@@ -0,0 +1,124 @@
+/**
+ * @file pool.hpp
+ * @brief KvClientPool class declaration for sharing authenticated connections.
+ */
+
+#ifndef _CLI_POOL_HPP_
+#define _CLI_POOL_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "client.hpp"
+
+/**
+ * @class KvPoolConfig
+ * @brief Sizing and health-check settings for a KvClientPool.
+ */
+class KvPoolConfig {
+ public:
+  size_t minSize;                        /**< Connections kept open at all times */
+  size_t maxSize;                        /**< Upper bound on open connections */
+  std::chrono::milliseconds idleTimeout; /**< Idle time before a connection above minSize is closed */
+  std::chrono::milliseconds keepalive;   /**< Idle time before a connection is pinged */
+  std::chrono::milliseconds waitTimeout; /**< How long acquire() waits when the pool is exhausted */
+
+  /**
+   * @brief Default constructor initializes defaults.
+   */
+  KvPoolConfig() : minSize(1), maxSize(8), idleTimeout(60000), keepalive(15000), waitTimeout(5000) {}
+};
+
+/**
+ * @class KvClientPool
+ * @brief Thread-safe pool of connected and authenticated KvClients.
+ *
+ * minSize connections are opened (and AUTHed) up front. acquire() hands out
+ * an idle connection, opens a new one while below maxSize, or waits for a
+ * lease to come back. A background thread pings idle connections, drops
+ * those that fail, closes surplus idle connections and refills to minSize.
+ */
+class KvClientPool {
+ public:
+  /**
+   * @class Lease
+   * @brief RAII handle that returns its connection to the pool when destroyed.
+   */
+  class Lease {
+   private:
+    KvClientPool* pool;               /**< Owning pool, null once released */
+    std::unique_ptr<KvClient> client; /**< Borrowed connection */
+    bool broken;                      /**< Close instead of returning to the pool */
+
+   public:
+    Lease();
+    Lease(KvClientPool* pool, std::unique_ptr<KvClient> client);
+    Lease(Lease&& other) noexcept;
+    Lease& operator=(Lease&& other) noexcept;
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+    ~Lease();
+
+    /** @brief True if the lease holds a connection. */
+    explicit operator bool() const { return client != nullptr; }
+    KvClient* operator->() const { return client.get(); }
+    KvClient& operator*() const { return *client; }
+
+    void invalidate();
+    void release();
+  };
+
+ private:
+  /** @brief An idle connection and when it was last known to be healthy. */
+  struct IdleClient {
+    std::unique_ptr<KvClient> client;
+    std::chrono::steady_clock::time_point idleSince;
+    std::chrono::steady_clock::time_point checkedAt;
+  };
+
+  KvConnectionInfo info;         /**< Settings for new connections */
+  KvPoolConfig config;           /**< Sizing and health-check settings */
+  std::deque<IdleClient> idle;   /**< Connections ready to lend, most recent last */
+  size_t openCount;              /**< Idle + leased + being opened */
+  bool stopping;                 /**< Set by the destructor */
+  mutable std::mutex mutex;      /**< Guards idle, openCount and stopping */
+  std::condition_variable ready; /**< Signalled when a connection is returned */
+  std::condition_variable wake;  /**< Wakes the maintenance thread early */
+  std::thread maintainer;        /**< Runs maintain() */
+
+  std::unique_ptr<KvClient> open();
+  void giveBack(std::unique_ptr<KvClient> client, bool broken);
+  void maintain();
+
+ public:
+  /**
+   * @brief Creates the pool and opens minSize connections.
+   *
+   * @param info   Connection settings, including AUTH credentials.
+   * @param config Sizing and health-check settings.
+   */
+  KvClientPool(const KvConnectionInfo& info, const KvPoolConfig& config = KvPoolConfig());
+
+  /** @brief Stops the maintenance thread and closes idle connections. */
+  ~KvClientPool();
+
+  KvClientPool(const KvClientPool&) = delete;
+  KvClientPool& operator=(const KvClientPool&) = delete;
+
+  /** @name Leasing */
+  //@{
+  Lease acquire();
+  //@}
+
+  /** @name State accessors */
+  //@{
+  size_t size() const;
+  size_t idleCount() const;
+  //@}
+};
+
+#endif  // _CLI_POOL_HPP_
@@ -0,0 +1,156 @@
+/**
+ * @file read_cache.hpp
+ * @brief KvReadCache class declaration for answering repeated reads locally.
+ */
+
+#ifndef _CLI_READ_CACHE_HPP_
+#define _CLI_READ_CACHE_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+
+#include "include.hpp"
+
+/** @brief How KvReadCache picks an entry to drop when it is full. */
+enum class KvEviction {
+  LRU,  /**< Least recently used; every hit reorders a list */
+  CLOCK /**< Second chance; a hit only sets a bit, eviction sweeps a hand */
+};
+
+/**
+ * @class KvCacheConfig
+ * @brief Size, lifetime and eviction settings for a KvReadCache.
+ */
+class KvCacheConfig {
+ public:
+  size_t maxBytes;               /**< Memory cap for keys, replies and bookkeeping */
+  std::chrono::milliseconds ttl; /**< Lifetime of an entry (0 = until evicted) */
+  KvEviction eviction;           /**< Eviction policy */
+
+  /**
+   * @brief Default constructor initializes defaults.
+   */
+  KvCacheConfig() : maxBytes(64 * 1024 * 1024), ttl(5000), eviction(KvEviction::LRU) {}
+};
+
+/**
+ * @class KvCacheStats
+ * @brief Counters kept by a KvReadCache.
+ */
+class KvCacheStats {
+ public:
+  uint64_t hits;          /**< Reads answered from the cache */
+  uint64_t misses;        /**< Cacheable reads sent to the server */
+  uint64_t expired;       /**< Entries found past their TTL */
+  uint64_t evictions;     /**< Entries dropped to stay under maxBytes */
+  uint64_t invalidations; /**< Entries dropped because a command changed their key */
+  size_t entries;         /**< Entries held now */
+  size_t bytes;           /**< Bytes accounted to those entries */
+
+  /**
+   * @brief Default constructor zeroes every counter.
+   */
+  KvCacheStats() : hits(0), misses(0), expired(0), evictions(0), invalidations(0), entries(0), bytes(0) {}
+};
+
+/**
+ * @class KvReadCache
+ * @brief In-process cache of replies to single-key read commands.
+ *
+ * Replies to reads such as GET, HGET or LRANGE are kept per command and
+ * arguments, so `GET a` and `GETRANGE a 0 3` are separate entries of the
+ * same key. Every other command sent through begin() drops the entries of
+ * each argument it names; FLUSHDB, SELECT, AUTH, scripts and the like drop
+ * everything. Inside MULTI the cache is bypassed until EXEC or DISCARD.
+ *
+ * Only writes made through this cache are seen. Changes by other clients
+ * and server-side expiry show up once the entry's TTL runs out.
+ *
+ * The cache is not thread-safe; use one per connection.
+ */
+class KvReadCache {
+ public:
+  /** @brief One command, as the words append_encoded() would send. */
+  using Command = std::vector<std::string_view>;
+
+  /**
+   * @brief What begin() learnt about a command that must go to the server.
+   *
+   * Hand it to complete() together with the reply, or an empty reply if
+   * none came. It owns its key, so it may outlive the input line (e.g.
+   * while the command is pipelined).
+   */
+  struct Ticket {
+    std::string key;     /**< Data key, a NUL, then the command and its arguments */
+    size_t keyLength;    /**< Length of the data key at the start of `key` */
+    uint64_t generation; /**< Write count when the command was sent */
+    bool cacheable;      /**< The reply may be stored */
+  };
+
+ private:
+  static constexpr uint32_t NONE = UINT32_MAX;  /**< Null slot index */
+  static constexpr size_t ENTRY_OVERHEAD = 128; /**< Bookkeeping bytes charged per entry */
+
+  /** @brief Reads of one data key that await their reply. */
+  struct Pending {
+    uint32_t reads;   /**< Tickets not yet completed */
+    uint64_t written; /**< Generation of the last write to the key meanwhile */
+  };
+
+  /** @brief One cached reply; slots are reused through `freeSlots`. */
+  struct Entry {
+    const std::string* key;                        /**< Ticket::key, owned by `index` */
+    size_t keyLength;                              /**< As in Ticket::keyLength */
+    std::string reply;                             /**< Raw RESP reply */
+    std::chrono::steady_clock::time_point expires; /**< Drop after this (ttl > 0) */
+    uint32_t prev;                                 /**< LRU: more recently used neighbor */
+    uint32_t next;                                 /**< LRU: less recently used neighbor */
+    bool referenced;                               /**< CLOCK: hit since the hand last passed */
+    bool live;                                     /**< Slot holds an entry */
+  };
+
+  KvCacheConfig config;                                             /**< Size, TTL and eviction */
+  KvCacheStats counters;                                            /**< Hit/miss statistics */
+  std::vector<Entry> slots;                                         /**< Entry storage */
+  std::vector<uint32_t> freeSlots;                                  /**< Unused indices into slots */
+  std::unordered_map<std::string, uint32_t> index;                  /**< Ticket::key -> slot; owns the keys */
+  std::unordered_map<std::string, std::vector<uint32_t>> byDataKey; /**< Data key -> its slots */
+  uint32_t head;                                                    /**< LRU: most recently used */
+  uint32_t tail;                                                    /**< LRU: least recently used */
+  uint32_t hand;                                                    /**< CLOCK: next slot to inspect */
+  std::unordered_map<std::string, Pending> pending;                 /**< Data key -> reads in flight */
+  uint64_t generation;                                              /**< Bumped on every write */
+  uint64_t clearedAt;                                               /**< Generation of the last clear() */
+  bool transaction;                                                 /**< Between MULTI and EXEC/DISCARD */
+  std::string probe;                                                /**< Scratch command name or data key */
+
+  void link(uint32_t slot);
+  void unlink(uint32_t slot);
+  void remove(uint32_t slot);
+  bool evictOne();
+  void invalidateKey(std::string_view key);
+
+ public:
+  /**
+   * @brief Creates an empty cache.
+   *
+   * @param config Size, TTL and eviction settings.
+   */
+  explicit KvReadCache(const KvCacheConfig& config = KvCacheConfig());
+
+  /** @name Caching */
+  //@{
+  bool begin(const Command& words, Ticket& ticket, std::string& reply);
+  void complete(const Ticket& ticket, std::string_view reply);
+  void clear();
+  //@}
+
+  /** @name State accessors */
+  //@{
+  const KvCacheStats& stats() const;
+  std::string summary() const;
+  //@}
+};
+
+#endif  // _CLI_READ_CACHE_HPP_
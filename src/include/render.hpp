@@ -0,0 +1,131 @@
+/**
+ * @file render.hpp
+ * @brief Buffered output sink and reply renderer for the CLI's output formats.
+ */
+
+#ifndef _RESP_RENDER_HPP_
+#define _RESP_RENDER_HPP_
+
+#include <memory>
+
+#include "include/include.hpp"
+
+namespace resp {
+
+/** @brief How replies are printed. */
+enum class Format {
+  HUMAN, /**< `(string) value`, as resp::decode() formats it */
+  RAW,   /**< Bare values, one array element per line */
+  CSV,   /**< One line per reply, quoted strings, elements comma-separated */
+  JSON   /**< One JSON value per line */
+};
+
+/**
+ * @brief Parses a format name (human, raw, csv or json).
+ *
+ * @param name   Format name.
+ * @param format Output; set on success.
+ * @return False if the name is unknown.
+ */
+bool parse_format(std::string_view name, Format& format);
+
+/**
+ * @class OutputSink
+ * @brief Large write buffer in front of a file descriptor.
+ *
+ * Bytes are collected until the buffer is full and then written with one
+ * write(2); writes bigger than the buffer bypass it. Nothing is flushed per
+ * line, so callers flush when a person is waiting for the output (after a
+ * REPL reply, before a log line) and at exit. The destructor flushes.
+ */
+class OutputSink {
+ private:
+  int fd;                      /**< Destination */
+  std::unique_ptr<char[]> buf; /**< Pending bytes */
+  size_t used;                 /**< Bytes in buf */
+  size_t capacity;             /**< Size of buf; the flush threshold */
+  bool failed;                 /**< A write failed (e.g. EPIPE); later output is dropped */
+
+  void writeAll(std::string_view data);
+
+ public:
+  /**
+   * @brief Creates a sink; nothing is written until the buffer fills.
+   *
+   * @param fd       Destination file descriptor.
+   * @param capacity Buffer size in bytes.
+   */
+  explicit OutputSink(int fd = STDOUT_FILENO, size_t capacity = 256 * 1024);
+
+  /** @brief Flushes what is left. */
+  ~OutputSink();
+
+  OutputSink(const OutputSink&) = delete;
+  OutputSink& operator=(const OutputSink&) = delete;
+
+  /** @brief Append bytes, writing the buffer out first if they do not fit. */
+  void write(std::string_view data) {
+    if (used + data.size() > capacity) {
+      flush();
+      if (data.size() >= capacity) {
+        writeAll(data);
+        return;
+      }
+    }
+    std::memcpy(buf.get() + used, data.data(), data.size());
+    used += data.size();
+  }
+
+  /** @brief Append one byte. */
+  void put(char c) {
+    if (used == capacity) flush();
+    buf[used++] = c;
+  }
+
+  bool flush();
+  bool good() const { return !failed; }
+};
+
+/**
+ * @class Renderer
+ * @brief Walks a raw RESP reply and writes it to an OutputSink.
+ *
+ * The reply is walked with resp::visit() and formatted value by value,
+ * with no intermediate strings. Every RESP3 type is printed: maps as
+ * `{key: value}` (JSON objects), sets and pushes like arrays; attributes
+ * are skipped. Each render() call prints one reply followed by a newline
+ * (RAW prints one line per scalar).
+ */
+class Renderer {
+ private:
+  OutputSink& out; /**< Destination */
+  Format format;   /**< Output format */
+
+ public:
+  /**
+   * @brief Creates a renderer writing to `out`.
+   *
+   * @param out    Sink that receives the output.
+   * @param format Output format.
+   */
+  Renderer(OutputSink& out, Format format);
+
+  void render(std::string_view reply);
+  Format getFormat() const { return format; }
+};
+
+/**
+ * @brief Format one reply into a string, without a trailing newline.
+ *
+ * For callers that need the text (log messages, resp::decode() of RESP3
+ * types) rather than output on a sink.
+ *
+ * @param reply  Raw RESP reply.
+ * @param format Output format.
+ * @return The formatted reply.
+ */
+std::string format_reply(std::string_view reply, Format format = Format::HUMAN);
+
+}  // namespace resp
+
+#endif  // _RESP_RENDER_HPP_
@@ -6,10 +6,61 @@
 #ifndef _RESP_HPP_
 #define _RESP_HPP_
 
+#include <memory>
+
 #include "include/include.hpp"
+#include "include/mapped_file.hpp"
 
 namespace resp {
 
+/**
+ * @class Buffer
+ * @brief Reusable command buffer that can reference large payloads in place.
+ *
+ * Framing and small values are copied into an owned byte string; payloads
+ * of at least `threshold` bytes are recorded as pointers to the caller's
+ * memory and sent with writev. Referenced payloads must outlive the send.
+ * Files mapped with mapFile() are owned by the buffer until clear(), so
+ * their contents go from the page cache to the socket without a copy.
+ * clear() keeps the allocated capacity for the next command.
+ */
+class Buffer {
+ private:
+  /** @brief A run of owned bytes (data == nullptr) or an external payload. */
+  struct Piece {
+    const char* data; /**< External payload, or null for owned bytes */
+    size_t offset;    /**< Start within the owned bytes */
+    size_t length;    /**< Length in bytes */
+  };
+
+  std::string bytes;                                /**< Owned framing and small values */
+  std::vector<Piece> pieces;                        /**< Send order of owned runs and payloads */
+  std::vector<std::unique_ptr<KvMappedFile>> files; /**< Mappings referenced by pieces */
+  size_t sealed;             /**< Owned bytes already covered by pieces */
+  size_t threshold;          /**< Minimum payload size referenced in place */
+
+ public:
+  /**
+   * @brief Creates an empty buffer.
+   *
+   * @param threshold Payloads at least this large are not copied.
+   */
+  explicit Buffer(size_t threshold = 16 * 1024);
+
+  /** @brief Owned byte string to append framing to. */
+  std::string& framing() { return bytes; }
+  /** @brief Owned bytes, read-only; they begin with the header and command name. */
+  const std::string& framing() const { return bytes; }
+
+  void attach(std::string_view payload);
+  bool mapFile(const std::string& path, std::string_view& contents);
+  void clear();
+  size_t size() const;
+  size_t zeroCopyThreshold() const { return threshold; }
+  void gather(std::vector<struct iovec>& iov) const;
+  std::string str() const;
+};
+
 /** @name Encoding functions */
 //@{
 std::string encode(const std::string& str);
@@ -23,25 +74,44 @@ std::string encode_command(const std::string& cmd, const std::vector<std::string
 std::string encode_raw_command(const std::string& raw_cmd);
 //@}
 
+/** @name Buffer encoding functions (append, no temporaries) */
+//@{
+void append_bulk_string(std::string& out, std::string_view str);
+void append_simple_string(std::string& out, std::string_view str);
+void append_error(std::string& out, std::string_view str);
+void append_integer(std::string& out, int64_t num);
+void append_boolean(std::string& out, bool value);
+void append_array_header(std::string& out, size_t count);
+void append_token(std::string& out, std::string_view token);
+void append_token_element(std::string& out, std::string_view token);
+void append_encoded(std::string& out, std::string_view input);
+void append_command(std::string& out, std::string_view cmd, const std::vector<std::string_view>& args);
+bool append_token_element(Buffer& out, std::string_view token);
+bool append_encoded(Buffer& out, std::string_view input);
+void append_command(Buffer& out, std::string_view cmd, const std::vector<std::string_view>& args);
+//@}
+
 /** @name Type detection helpers */
 //@{
-bool is_integer(const std::string& str);
-bool is_boolean(const std::string& str);
-bool is_array(const std::string& str);
+bool is_integer(std::string_view str);
+bool is_boolean(std::string_view str);
+bool is_array(std::string_view str);
 std::vector<std::string> parse_array(const std::string& str);
 std::vector<std::string> tokenize(const std::string& input);
+void split_words(std::string_view input, std::vector<std::string_view>& words);
 std::string encode_token(const std::string& token);
 //@}
 
 /** @name Decoding functions */
 //@{
-std::string decode(const std::string& str);
-std::string decode_simple_string(const std::string& str);
-std::string decode_error(const std::string& str);
-std::string decode_integer(const std::string& str);
-std::string decode_bulk_string(const std::string& str);
-std::string decode_array(const std::string& str);
-std::string decode_boolean(const std::string& str);
+std::string decode(std::string_view str);
+std::string decode_simple_string(std::string_view str);
+std::string decode_error(std::string_view str);
+std::string decode_integer(std::string_view str);
+std::string decode_bulk_string(std::string_view str);
+std::string decode_array(std::string_view str);
+std::string decode_boolean(std::string_view str);
+std::string_view command_name(std::string_view encoded);
 //@}
 
 }  // namespace resp
@@ -0,0 +1,104 @@
+/**
+ * @file resp_reader.hpp
+ * @brief Incremental, frame-complete RESP reader interface.
+ */
+
+#ifndef _RESP_READER_HPP_
+#define _RESP_READER_HPP_
+
+#include "include/include.hpp"
+#include "include/spill_buffer.hpp"
+
+namespace resp {
+
+/**
+ * @brief Largest bulk length or aggregate count accepted (512 MiB).
+ *
+ * Matches the server's default proto-max-bulk-len. A header announcing
+ * more is a PROTOCOL_ERROR, so a corrupt or hostile length cannot make a
+ * reader reserve memory for it. Integer replies are values, not lengths,
+ * and are not limited.
+ */
+constexpr int64_t MAX_LENGTH = 512LL * 1024 * 1024;
+
+/**
+ * @class Reader
+ * @brief Resumable RESP frame splitter that owns a growable receive buffer.
+ *
+ * Network bytes are written into the buffer through prepare()/commit().
+ * next() advances a state machine over the new bytes only, so a large reply
+ * that arrives in many segments is scanned once. Bytes after a complete
+ * frame stay buffered for the following call.
+ *
+ * The buffer spills to a temporary file once it grows past
+ * KvSpillBuffer::limit(), so a reply larger than the limit costs page cache
+ * rather than heap.
+ */
+class Reader {
+ public:
+  /** @brief Result of a next() call. */
+  enum class Status { COMPLETE, INCOMPLETE, PROTOCOL_ERROR };
+
+ private:
+  KvSpillBuffer buffer;           /**< Receive buffer, data lives in [head, tail) */
+  size_t initialCapacity;         /**< Capacity restored once the buffer drains */
+  size_t head;                    /**< Start of the frame being parsed */
+  size_t tail;                    /**< End of received data */
+  size_t released;                /**< Length of the frame returned by the last next() */
+  size_t cursor;                  /**< Parse position, relative to head */
+  size_t bodyEnd;                 /**< End of the pending bulk body, relative to head (0 = none) */
+  std::vector<int64_t> remaining; /**< Elements still expected by each open aggregate */
+
+  void compact();
+  bool finishValue();
+
+ public:
+  /**
+   * @brief Creates an empty reader.
+   *
+   * @param capacity Initial buffer size in bytes.
+   */
+  explicit Reader(size_t capacity = 16384);
+
+  /** @name Buffer management */
+  //@{
+  char* prepare(size_t n);
+  void commit(size_t n);
+  void feed(const char* data, size_t n);
+  size_t buffered() const;
+  void reset();
+  //@}
+
+  /** @name Raw access between frames */
+  //@{
+  std::string_view peek() const;
+  void skip(size_t n);
+  //@}
+
+  /** @name Parsing */
+  //@{
+  Status next(std::string_view& frame);
+  //@}
+};
+
+/**
+ * @brief Measure the first complete frame of an in-memory RESP stream.
+ *
+ * One-shot counterpart of Reader::next() for data that is already fully
+ * in memory (e.g. a mapped file), so nothing is copied.
+ *
+ * @param data   Bytes starting at a frame boundary.
+ * @param length On COMPLETE, the frame length in bytes.
+ * @return COMPLETE, INCOMPLETE (data ends mid-frame) or PROTOCOL_ERROR.
+ */
+Reader::Status scan_frame(std::string_view data, size_t& length);
+
+/** @name Reply splitting (in-memory frames) */
+//@{
+bool read_bulk(std::string_view frame, std::string_view& payload);
+bool read_array(std::string_view frame, std::vector<std::string_view>& elements);
+//@}
+
+}  // namespace resp
+
+#endif  // _RESP_READER_HPP_
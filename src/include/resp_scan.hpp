@@ -0,0 +1,45 @@
+/**
+ * @file resp_scan.hpp
+ * @brief Vectorized CRLF and length scanning shared by the RESP decoder and reader.
+ */
+
+#ifndef _RESP_SCAN_HPP_
+#define _RESP_SCAN_HPP_
+
+#include <cstdint>
+
+namespace resp {
+
+/** @brief Result of parse_length_line(). */
+enum class LineStatus { OK, INCOMPLETE, MALFORMED };
+
+/**
+ * @brief Find the first "\r\n" in [first, last).
+ *
+ * Uses AVX2 or SSE2 when the CPU has them (picked once at startup) and a
+ * memchr loop otherwise.
+ *
+ * @return Pointer to the '\r', or nullptr if there is no CRLF.
+ */
+const char* find_crlf(const char* first, const char* last);
+
+/**
+ * @brief Parse a `[-]digits\r\n` length field without allocating.
+ *
+ * Digits are accumulated up to the first non-digit, which must start the
+ * CRLF, so no separate line search is needed.
+ *
+ * @param first Start of the field (just after the type byte).
+ * @param last  End of the available data.
+ * @param value Parsed value.
+ * @param next  On OK, the position after the LF.
+ * @return OK, INCOMPLETE (the data ends inside the field) or MALFORMED.
+ */
+LineStatus parse_length_line(const char* first, const char* last, int64_t& value, const char*& next);
+
+/** @brief Name of the CRLF kernel in use ("avx2", "sse2" or "scalar"). */
+const char* scan_kernel();
+
+}  // namespace resp
+
+#endif  // _RESP_SCAN_HPP_
@@ -0,0 +1,111 @@
+/**
+ * @file resp_tree.hpp
+ * @brief Arena-backed reply tree for callers that need random access.
+ */
+
+#ifndef _RESP_TREE_HPP_
+#define _RESP_TREE_HPP_
+
+#include <memory>
+#include <type_traits>
+
+#include "include/resp_visit.hpp"
+
+namespace resp {
+
+/**
+ * @class Arena
+ * @brief Bump allocator that frees everything at once.
+ *
+ * Memory comes from blocks of at least `blockSize` bytes. reset() rewinds
+ * to the first block and keeps the blocks, so a reused arena stops
+ * allocating once it has grown to the largest tree it held.
+ */
+class Arena {
+ private:
+  std::vector<std::unique_ptr<char[]>> blocks; /**< Owned blocks, in order of use */
+  std::vector<size_t> sizes;                   /**< Size of each block */
+  size_t blockSize;                            /**< Minimum size of a new block */
+  size_t current;                              /**< Block being carved */
+  size_t offset;                               /**< Used bytes of the current block */
+
+ public:
+  /**
+   * @brief Creates an empty arena; the first block is allocated on demand.
+   *
+   * @param blockSize Minimum block size in bytes.
+   */
+  explicit Arena(size_t blockSize = 64 * 1024);
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  void* allocate(size_t bytes, size_t align);
+  void reset();
+  size_t capacity() const;
+
+  /** @brief Uninitialized storage for `count` objects of a trivial type. */
+  template <typename T>
+  T* allocate(size_t count) {
+    static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+    return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+  }
+};
+
+/**
+ * @struct Node
+ * @brief One value of a reply tree.
+ *
+ * Strings are views into the parsed reply, which must outlive the tree.
+ * MAP and ATTRIBUTE children alternate key, value.
+ */
+struct Node {
+  Type type;             /**< Value type */
+  bool boolean;          /**< BOOLEAN: the value */
+  uint32_t count;        /**< Aggregates: number of children */
+  int64_t integer;       /**< INTEGER: the value */
+  double number;         /**< DOUBLE: the value */
+  std::string_view text; /**< Strings, errors, and INTEGER/DOUBLE/BIG_NUMBER as sent */
+  const Node* children;  /**< Aggregates: `count` children */
+
+  /** @brief True for aggregates (ARRAY, MAP, SET, PUSH). */
+  bool isAggregate() const { return type == Type::ARRAY || type == Type::MAP || type == Type::SET || type == Type::PUSH; }
+  /** @brief Elements of an ARRAY, SET or PUSH, or pairs of a MAP. */
+  size_t size() const { return type == Type::MAP ? count / 2 : count; }
+  /** @brief The i-th child (for a MAP: keys at even, values at odd positions). */
+  const Node& operator[](size_t i) const { return children[i]; }
+  /** @brief The value stored under a string key in a MAP, or null. */
+  const Node* find(std::string_view key) const;
+};
+
+/**
+ * @class Document
+ * @brief A reply parsed into Nodes held in an Arena.
+ *
+ * Attributes are dropped; use visit() to see them. The document can be
+ * reused: parse() rewinds the arena, so repeated parses reuse its memory.
+ */
+class Document {
+ private:
+  Arena arena; /**< Node storage */
+  Node top;    /**< Root value */
+
+ public:
+  /**
+   * @brief Creates an empty document.
+   *
+   * @param blockSize Arena block size in bytes.
+   */
+  explicit Document(size_t blockSize = 64 * 1024);
+
+  Reader::Status parse(std::string_view reply);
+
+  /** @brief Root of the last successful parse(). */
+  const Node& root() const { return top; }
+  /** @brief Bytes reserved by the arena. */
+  size_t memory() const { return arena.capacity(); }
+};
+
+}  // namespace resp
+
+#endif  // _RESP_TREE_HPP_
@@ -0,0 +1,241 @@
+/**
+ * @file resp_visit.hpp
+ * @brief Event-based (SAX-style) walker over RESP2 and RESP3 replies.
+ */
+
+#ifndef _RESP_VISIT_HPP_
+#define _RESP_VISIT_HPP_
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+
+#include "include/resp_reader.hpp"
+#include "include/resp_scan.hpp"
+
+namespace resp {
+
+/** @brief Every RESP2 and RESP3 value type. */
+enum class Type : uint8_t {
+  SIMPLE_STRING, /**< `+` */
+  ERROR,         /**< `-` */
+  INTEGER,       /**< `:` */
+  BULK_STRING,   /**< `$` */
+  ARRAY,         /**< `*` */
+  NIL,           /**< `_`, and the RESP2 nulls `$-1` / `*-1` */
+  BOOLEAN,       /**< `#` */
+  DOUBLE,        /**< `,` */
+  BIG_NUMBER,    /**< `(` */
+  BULK_ERROR,    /**< `!` */
+  VERBATIM,      /**< `=`; the 3-letter format and `:` are stripped */
+  MAP,           /**< `%` */
+  SET,           /**< `~` */
+  ATTRIBUTE,     /**< `|`; annotates the value that follows it */
+  PUSH           /**< `>` */
+};
+
+/** @brief Deepest aggregate nesting visit() accepts. */
+constexpr int MAX_VISIT_DEPTH = 64;
+
+/**
+ * @class Visitor
+ * @brief No-op event handlers to derive from.
+ *
+ * visit() is a template and calls the handlers directly, so a visitor only
+ * declares the events it cares about (hiding these) and nothing is virtual.
+ * Views point into the reply and are valid as long as it is.
+ */
+class Visitor {
+ public:
+  /** @brief `+ - $ ! = (` values. */
+  void onString(Type, std::string_view) {}
+  /** @brief `:` values, parsed and as sent. */
+  void onInteger(int64_t, std::string_view) {}
+  /** @brief `,` values, parsed and as sent. */
+  void onDouble(double, std::string_view) {}
+  /** @brief `#t` / `#f`. */
+  void onBoolean(bool) {}
+  /** @brief `_`, or a null bulk string / array (type BULK_STRING / ARRAY). */
+  void onNull(Type) {}
+  /** @brief Start of an aggregate; `count` is its element count (pairs for MAP and ATTRIBUTE). */
+  void onBegin(Type, int64_t) {}
+  /** @brief End of the aggregate opened last. */
+  void onEnd(Type) {}
+  /** @brief Checked after onBegin(); true ends the walk with PROTOCOL_ERROR. */
+  bool stopped() const { return false; }
+};
+
+/**
+ * @brief Walk one reply and report every value to `visitor`.
+ *
+ * Aggregates are tracked on a fixed stack, so walking allocates nothing.
+ * An attribute is reported as its own aggregate, followed by the value it
+ * annotates. Events already reported stay reported if the data turns out
+ * to be incomplete or malformed. A visitor that refuses an aggregate
+ * header ends the walk through stopped().
+ *
+ * @param data    Bytes starting at a frame boundary.
+ * @param visitor Receives the events.
+ * @param length  On COMPLETE, the frame length in bytes.
+ * @return COMPLETE, INCOMPLETE or PROTOCOL_ERROR (also for nesting deeper
+ *         than MAX_VISIT_DEPTH, or when the visitor stopped the walk).
+ */
+template <typename V>
+Reader::Status visit(std::string_view data, V& visitor, size_t& length) {
+  struct Open {
+    Type type;
+    int64_t left; /**< Elements still to come */
+  };
+  Open stack[MAX_VISIT_DEPTH];
+  int depth = 0;
+
+  const char* first = data.data();
+  const char* end = first + data.size();
+  const char* p = first;
+
+  while (true) {
+    if (p >= end) return Reader::Status::INCOMPLETE;
+
+    char kind = *p;
+    const char* next = nullptr;
+    int64_t n = 0;
+
+    switch (kind) {
+      case '$':
+      case '!':
+      case '=': {
+        LineStatus status = parse_length_line(p + 1, end, n, next);
+        if (status != LineStatus::OK) return status == LineStatus::INCOMPLETE ? Reader::Status::INCOMPLETE : Reader::Status::PROTOCOL_ERROR;
+        if (n > MAX_LENGTH) return Reader::Status::PROTOCOL_ERROR;
+        if (n < 0) {
+          if (kind != '$') return Reader::Status::PROTOCOL_ERROR;
+          visitor.onNull(Type::BULK_STRING);
+          p = next;
+          break;
+        }
+        if (end - next < n + 2) return Reader::Status::INCOMPLETE;
+        if (next[n] != '\r' || next[n + 1] != '\n') return Reader::Status::PROTOCOL_ERROR;
+
+        std::string_view body(next, static_cast<size_t>(n));
+        if (kind == '$') {
+          visitor.onString(Type::BULK_STRING, body);
+        } else if (kind == '!') {
+          visitor.onString(Type::BULK_ERROR, body);
+        } else {
+          if (body.size() < 4 || body[3] != ':') return Reader::Status::PROTOCOL_ERROR;
+          visitor.onString(Type::VERBATIM, body.substr(4));
+        }
+        p = next + n + 2;
+        break;
+      }
+
+      case '*':
+      case '~':
+      case '>':
+      case '%':
+      case '|': {
+        LineStatus status = parse_length_line(p + 1, end, n, next);
+        if (status != LineStatus::OK) return status == LineStatus::INCOMPLETE ? Reader::Status::INCOMPLETE : Reader::Status::PROTOCOL_ERROR;
+        if (n > MAX_LENGTH) return Reader::Status::PROTOCOL_ERROR;
+        p = next;
+        if (n < 0) {
+          if (kind != '*') return Reader::Status::PROTOCOL_ERROR;
+          visitor.onNull(Type::ARRAY);
+          break;
+        }
+
+        Type type = kind == '*' ? Type::ARRAY : kind == '~' ? Type::SET : kind == '>' ? Type::PUSH : kind == '%' ? Type::MAP : Type::ATTRIBUTE;
+        visitor.onBegin(type, n);
+        if (visitor.stopped()) return Reader::Status::PROTOCOL_ERROR;
+        int64_t elements = (type == Type::MAP || type == Type::ATTRIBUTE) ? 2 * n : n;
+        if (elements == 0) {
+          visitor.onEnd(type);
+          if (type == Type::ATTRIBUTE) continue;  // the annotated value still follows
+          break;
+        }
+        if (depth == MAX_VISIT_DEPTH) return Reader::Status::PROTOCOL_ERROR;
+        stack[depth++] = {type, elements};
+        continue;
+      }
+
+      case ':': {
+        LineStatus status = parse_length_line(p + 1, end, n, next);
+        if (status == LineStatus::INCOMPLETE) return Reader::Status::INCOMPLETE;
+        if (status == LineStatus::OK) {
+          visitor.onInteger(n, std::string_view(p + 1, static_cast<size_t>(next - p - 3)));
+          p = next;
+          break;
+        }
+        // "+5" or a value beyond 64 bits: the text is reported as sent and
+        // the value is 0 if it does not fit
+        const char* cr = find_crlf(p + 1, end);
+        if (cr == nullptr) return Reader::Status::INCOMPLETE;
+        n = 0;
+        if (std::from_chars(p + 1 + (p[1] == '+'), cr, n).ec != std::errc()) n = 0;
+        visitor.onInteger(n, std::string_view(p + 1, static_cast<size_t>(cr - p - 1)));
+        p = cr + 2;
+        break;
+      }
+
+      case '+':
+      case '-':
+      case ',':
+      case '(':
+      case '#':
+      case '_': {
+        const char* cr = find_crlf(p + 1, end);
+        if (cr == nullptr) return Reader::Status::INCOMPLETE;
+        std::string_view line(p + 1, static_cast<size_t>(cr - p - 1));
+
+        if (kind == '+') {
+          visitor.onString(Type::SIMPLE_STRING, line);
+        } else if (kind == '-') {
+          visitor.onString(Type::ERROR, line);
+        } else if (kind == '(') {
+          visitor.onString(Type::BIG_NUMBER, line);
+        } else if (kind == '#') {
+          if (line != "t" && line != "f") return Reader::Status::PROTOCOL_ERROR;
+          visitor.onBoolean(line[0] == 't');
+        } else if (kind == '_') {
+          if (!line.empty()) return Reader::Status::PROTOCOL_ERROR;
+          visitor.onNull(Type::NIL);
+        } else {
+          double number = 0;
+          if (line == "inf") {
+            number = HUGE_VAL;
+          } else if (line == "-inf") {
+            number = -HUGE_VAL;
+          } else if (std::from_chars(line.data(), line.data() + line.size(), number).ec != std::errc()) {
+            number = NAN;
+          }
+          visitor.onDouble(number, line);
+        }
+        p = cr + 2;
+        break;
+      }
+
+      default:
+        return Reader::Status::PROTOCOL_ERROR;
+    }
+
+    // A value is complete: close every aggregate it completes. A finished
+    // attribute does not fill a slot of its parent; the next value does.
+    bool annotated = false;
+    while (depth > 0 && --stack[depth - 1].left == 0) {
+      Type closed = stack[--depth].type;
+      visitor.onEnd(closed);
+      if (closed == Type::ATTRIBUTE) {
+        annotated = true;
+        break;
+      }
+    }
+    if (depth == 0 && !annotated) {
+      length = static_cast<size_t>(p - first);
+      return Reader::Status::COMPLETE;
+    }
+  }
+}
+
+}  // namespace resp
+
+#endif  // _RESP_VISIT_HPP_
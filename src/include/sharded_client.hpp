@@ -0,0 +1,97 @@
+/**
+ * @file sharded_client.hpp
+ * @brief KvShardedClient class declaration for spreading keys over several servers.
+ */
+
+#ifndef _CLI_SHARDED_CLIENT_HPP_
+#define _CLI_SHARDED_CLIENT_HPP_
+
+#include <memory>
+
+#include "client.hpp"
+
+/**
+ * @class KvShardedClient
+ * @brief Routes commands to one of several servers by key.
+ *
+ * Keys are placed on a consistent-hash ring on which every node owns
+ * VIRTUAL_NODES points, so adding or removing a node moves only about 1/N
+ * of the keys. A `{tag}` inside a key is hashed instead of the whole key,
+ * which keeps related keys on one node.
+ *
+ * Multi-key commands (MGET, MSET, DEL, UNLINK, EXISTS, TOUCH) are split
+ * into one sub-command per node. DBSIZE, KEYS, FLUSHDB, FLUSHALL, SELECT
+ * and PING go to every node. Each batch is written to all nodes before any
+ * reply is read, so the nodes work on it concurrently. The replies are then
+ * merged back into one per command, in the original order.
+ */
+class KvShardedClient {
+ public:
+  /** @brief Ring points per node. */
+  static constexpr size_t VIRTUAL_NODES = 160;
+
+  /** @brief One input command, as the words append_encoded() would send. */
+  using Command = std::vector<std::string_view>;
+
+  /** @brief How the sub-replies of a command are combined. */
+  enum class Merge {
+    SINGLE, /**< One node answered; use its reply */
+    ARRAY,  /**< Reassemble array elements in key order (MGET) */
+    SUM,    /**< Add up integer replies (DEL, EXISTS, DBSIZE) */
+    SAME,   /**< Every node must succeed; use the first reply (MSET, PING) */
+    CONCAT  /**< Concatenate array replies (KEYS) */
+  };
+
+ private:
+  /** @brief The part of a command sent to one node. */
+  struct Part {
+    size_t node;                         /**< Index into `nodes` */
+    std::vector<std::string_view> words; /**< Command name plus this node's arguments */
+    std::vector<size_t> positions;       /**< ARRAY: result slot of each key */
+    std::string reply;                   /**< Raw reply once received */
+  };
+
+  /** @brief A command split into per-node parts. */
+  struct Plan {
+    Merge merge;             /**< How to combine the parts */
+    size_t results;          /**< ARRAY: number of result elements */
+    std::vector<Part> parts; /**< At most one per node */
+  };
+
+  std::vector<KvConnectionInfo> infos;           /**< Settings per node */
+  std::vector<std::unique_ptr<KvClient>> nodes;  /**< One connection per node */
+  std::vector<std::pair<uint64_t, size_t>> ring; /**< (point, node), sorted by point */
+  std::vector<std::string> outboxes;             /**< Per-node send buffer, reused */
+
+  void split(const Command& command, Plan& plan) const;
+  std::string merge(Plan& plan) const;
+
+ public:
+  /**
+   * @brief Builds the ring; call connect() before executing commands.
+   *
+   * @param infos Connection settings, one per node.
+   */
+  explicit KvShardedClient(const std::vector<KvConnectionInfo>& infos);
+
+  /** @name Connection methods */
+  //@{
+  bool connect();
+  void disconnect();
+  void setReconnectPolicy(const KvReconnectPolicy& policy);
+  //@}
+
+  /** @name Routing */
+  //@{
+  size_t size() const;
+  size_t nodeFor(std::string_view key) const;
+  const KvConnectionInfo& node(size_t index) const;
+  //@}
+
+  /** @name Communication */
+  //@{
+  bool execute(const std::vector<Command>& commands, std::vector<std::string>& replies);
+  //@}
+};
+
+#endif  // _CLI_SHARDED_CLIENT_HPP_
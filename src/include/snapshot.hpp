@@ -0,0 +1,158 @@
+/**
+ * @file snapshot.hpp
+ * @brief Binary keyspace snapshot format: KvSnapshotWriter and KvSnapshotReader.
+ *
+ * Layout (all integers little-endian):
+ *
+ *     header   "KVSNAP" 0x00 0x01                 magic and format version
+ *     blocks   { u32 key length, u32 value length, key, value } ...
+ *     index    { u64 offset, u64 length, u32 records, u32 crc32c } per block
+ *     trailer  u64 index offset, u64 records, u32 blocks, u32 index crc32c,
+ *              "KVSNAPIX"
+ *
+ * Blocks are written in whatever order the export workers finish them; the
+ * index at the end lists them all. Each block and the index carry a CRC-32C,
+ * so a truncated or damaged file is detected before anything is sent.
+ */
+
+#ifndef _CLI_SNAPSHOT_HPP_
+#define _CLI_SNAPSHOT_HPP_
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace snapshot {
+
+/** @brief File header: magic plus a version byte. */
+constexpr std::string_view MAGIC("KVSNAP\0\1", 8);
+
+/** @brief Last bytes of a complete file. */
+constexpr std::string_view TRAILER_MAGIC("KVSNAPIX", 8);
+
+constexpr size_t RECORD_HEADER_SIZE = 8; /**< Key and value lengths */
+constexpr size_t INDEX_ENTRY_SIZE = 24;  /**< Offset, length, records, crc */
+constexpr size_t TRAILER_SIZE = 32;      /**< Index offset, records, blocks, crc, magic */
+
+/**
+ * @brief CRC-32C (Castagnoli) of a byte range.
+ *
+ * Uses the SSE4.2 crc32 instruction when the CPU has it and a table
+ * otherwise; both give the same result.
+ *
+ * @param data Bytes to checksum.
+ * @param size Number of bytes.
+ * @param crc  CRC of the preceding bytes, to checksum in pieces.
+ * @return Updated CRC.
+ */
+uint32_t crc32c(const void* data, size_t size, uint32_t crc = 0);
+
+/** @brief True if `data` starts with the snapshot magic. */
+bool is_snapshot(std::string_view data);
+
+}  // namespace snapshot
+
+/**
+ * @class KvSnapshotWriter
+ * @brief Writes a snapshot file from blocks built on several threads.
+ *
+ * Workers build blocks with appendRecord() and hand them to writeBlock(),
+ * which is safe to call concurrently. finish() adds the index and trailer
+ * and renames the temporary file into place, so an interrupted export never
+ * leaves a file that looks complete.
+ */
+class KvSnapshotWriter {
+ private:
+  /** @brief Index entry for a written block. */
+  struct Block {
+    uint64_t offset;  /**< Start of the block in the file */
+    uint64_t length;  /**< Block size in bytes */
+    uint32_t records; /**< Records in the block */
+    uint32_t crc;     /**< CRC-32C of the block */
+  };
+
+  int fd;                   /**< Temporary file, -1 when closed */
+  std::string path;         /**< Final file name */
+  std::string tempPath;     /**< File being written */
+  uint64_t offset;          /**< Bytes written so far */
+  uint64_t recordCount;     /**< Records written so far */
+  std::vector<Block> index; /**< One entry per block, in file order */
+  std::mutex mutex;         /**< Guards the file, offset and index */
+
+  bool writeAll(const char* data, size_t size);
+
+ public:
+  /** @brief Creates a closed writer. */
+  KvSnapshotWriter();
+
+  /** @brief Discards an unfinished file. */
+  ~KvSnapshotWriter();
+
+  KvSnapshotWriter(const KvSnapshotWriter&) = delete;
+  KvSnapshotWriter& operator=(const KvSnapshotWriter&) = delete;
+
+  /** @name Writing */
+  //@{
+  bool open(const std::string& path);
+  bool writeBlock(std::string_view block, uint32_t records);
+  bool finish();
+  void abort();
+  //@}
+
+  /** @name Block building */
+  //@{
+  static void appendRecord(std::string& block, std::string_view key, std::string_view value);
+  //@}
+
+  /** @name Counters */
+  //@{
+  uint64_t records();
+  uint64_t bytes();
+  //@}
+};
+
+/**
+ * @class KvSnapshotReader
+ * @brief Validates a snapshot held in memory and walks its records in place.
+ *
+ * open() checks the trailer and the index checksum. Each block's checksum
+ * is checked when the block is requested, so a mapped file is read once.
+ */
+class KvSnapshotReader {
+ private:
+  /** @brief A block located through the index. */
+  struct Block {
+    std::string_view data; /**< Block bytes inside the snapshot */
+    uint32_t records;      /**< Records in the block */
+    uint32_t crc;          /**< Expected CRC-32C */
+  };
+
+  std::vector<Block> blocks; /**< Blocks in index order */
+  uint64_t recordCount;      /**< Records according to the trailer */
+
+ public:
+  /** @brief Creates an empty reader. */
+  KvSnapshotReader();
+
+  /** @name Validation */
+  //@{
+  bool open(std::string_view data, std::string& error);
+  bool block(size_t index, std::string_view& records, std::string& error) const;
+  //@}
+
+  /** @name Records */
+  //@{
+  static bool nextRecord(std::string_view& records, std::string_view& key, std::string_view& value);
+  //@}
+
+  /** @name State accessors */
+  //@{
+  size_t blockCount() const;
+  uint32_t blockRecords(size_t index) const;
+  uint64_t records() const;
+  //@}
+};
+
+#endif  // _CLI_SNAPSHOT_HPP_
@@ -0,0 +1,66 @@
+/**
+ * @file spill_buffer.hpp
+ * @brief KvSpillBuffer class declaration for receive buffers that may
+ *        outgrow memory.
+ */
+
+#ifndef _CLI_SPILL_BUFFER_HPP_
+#define _CLI_SPILL_BUFFER_HPP_
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @class KvSpillBuffer
+ * @brief Resizable byte buffer that moves to a temporary file past a limit.
+ *
+ * Up to the process-wide limit (see setLimit()) the bytes live on the heap.
+ * A resize beyond it copies them into an unlinked file under $TMPDIR (or
+ * /tmp) and maps that file instead. A huge reply is then held in page cache,
+ * which the kernel can write back and reclaim, rather than in anonymous
+ * memory. Resizing to the limit or less moves the bytes back to the heap.
+ *
+ * If no temporary file can be created, the buffer keeps growing on the heap
+ * and a warning is logged once.
+ */
+class KvSpillBuffer {
+ private:
+  std::vector<char> memory; /**< Contents while on the heap */
+  char* mapping;            /**< Contents while spilled (null = on the heap) */
+  size_t mapped;            /**< Size of the mapping */
+  int fd;                   /**< Spill file (-1 = none) */
+
+  bool spill(size_t size);
+  void unspill(size_t size);
+
+ public:
+  /**
+   * @brief Creates a heap buffer.
+   *
+   * @param size Initial size in bytes.
+   */
+  explicit KvSpillBuffer(size_t size);
+
+  /** @brief Copies hold the bytes on the heap, or in a spill file of their own. */
+  KvSpillBuffer(const KvSpillBuffer& other);
+  KvSpillBuffer& operator=(const KvSpillBuffer& other);
+
+  /** @brief Unmaps and closes the spill file, if any. */
+  ~KvSpillBuffer();
+
+  /** @name Contents */
+  //@{
+  char* data();
+  const char* data() const;
+  size_t size() const;
+  void resize(size_t size);
+  //@}
+
+  /** @name Process-wide limit */
+  //@{
+  static void setLimit(size_t bytes);
+  static size_t limit();
+  //@}
+};
+
+#endif  // _CLI_SPILL_BUFFER_HPP_
@@ -0,0 +1,87 @@
+/**
+ * @file startup_trace.hpp
+ * @brief Phase timings from process start to the first reply (--startup-trace).
+ */
+
+#ifndef _STARTUP_TRACE_HPP_
+#define _STARTUP_TRACE_HPP_
+
+#include <time.h>
+
+#include <chrono>
+#include <cstdio>
+
+#include "logger.hpp"
+
+namespace StartupTrace {
+
+/** @brief Most phases recorded; later marks are dropped. */
+constexpr size_t MAX_MARKS = 16;
+
+/** @brief A phase and when it ended. */
+struct Mark {
+  const char* phase;
+  std::chrono::steady_clock::time_point at;
+};
+
+/** @brief Recorded marks; marks are always taken, report() only prints when enabled. */
+struct State {
+  Mark marks[MAX_MARKS];
+  size_t count = 0;
+  double preMainMs = 0; /**< CPU time spent before main(): loader, relocations, static init */
+  bool enabled = false;
+};
+
+inline State& state() {
+  static State trace;
+  return trace;
+}
+
+/** @brief Set by --startup-trace. */
+inline bool& enabled() {
+  return state().enabled;
+}
+
+/**
+ * @brief Record the end of a phase.
+ *
+ * @param phase Static name of the phase that just finished.
+ */
+inline void mark(const char* phase) {
+  State& trace = state();
+  if (trace.count < MAX_MARKS) trace.marks[trace.count++] = {phase, std::chrono::steady_clock::now()};
+}
+
+/**
+ * @brief Call first thing in main(); everything before it is reported as
+ *        the CPU time the process had already used.
+ */
+inline void start() {
+  timespec cpu{};
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu);
+  state().preMainMs = static_cast<double>(cpu.tv_sec) * 1e3 + static_cast<double>(cpu.tv_nsec) / 1e6;
+  mark("main");
+}
+
+/** @brief Print each phase's duration, if enabled, whatever the log level. Prints once. */
+inline void report() {
+  State& trace = state();
+  if (!trace.enabled || trace.count == 0) return;
+
+  char line[96];
+  std::snprintf(line, sizeof(line), "startup: %-16s %8.3f ms (cpu)", "before main", trace.preMainMs);
+  Logger::write(Logger::Level::INFO, line);
+  for (size_t i = 1; i < trace.count; ++i) {
+    std::snprintf(line, sizeof(line), "startup: %-16s %8.3f ms", trace.marks[i].phase,
+                  std::chrono::duration<double, std::milli>(trace.marks[i].at - trace.marks[i - 1].at).count());
+    Logger::write(Logger::Level::INFO, line);
+  }
+  std::snprintf(line, sizeof(line), "startup: %-16s %8.3f ms since main", "total",
+                std::chrono::duration<double, std::milli>(trace.marks[trace.count - 1].at - trace.marks[0].at).count());
+  Logger::write(Logger::Level::INFO, line);
+  trace.enabled = false;
+}
+
+}  // namespace StartupTrace
+
+#endif  // _STARTUP_TRACE_HPP_
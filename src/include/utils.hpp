@@ -11,18 +11,33 @@
 // Forward declarations
 class KvClient;
 class KvConnectionInfo;
+class KvCliOptions;
 
 namespace network {
 /**
  * @brief Establishes a connection to the KV server.
  *
- * Parses CLI args (host, port, credentials) and returns a configured client.
+ * Parses CLI args (host, port, credentials, mode flags) and returns a
+ * configured client.
  *
- * @param argc Number of arguments.
- * @param argv Array of argument strings.
+ * @param argc    Number of arguments.
+ * @param argv    Array of argument strings.
+ * @param options Output run mode options parsed from the same args.
  * @return KvClient instance connected (or configured) to the server.
  */
-KvClient connect_to_client(int argc, char* argv[]);
+KvClient connect_to_client(int argc, char* argv[], KvCliOptions& options);
+
+/**
+ * @brief Opens an additional connection from already parsed settings.
+ *
+ * Connects to info.host:info.port and sends AUTH when credentials are set.
+ * Used by modes that need more than the initial connection.
+ *
+ * @param client Unconnected client to configure.
+ * @param info   Connection settings.
+ * @return True if connected (and authenticated when required).
+ */
+bool open_connection(KvClient& client, const KvConnectionInfo& info);
 
 /**
  * @brief Parses a connection URI into its components.
@@ -31,6 +46,9 @@ KvClient connect_to_client(int argc, char* argv[]);
  *   - kv://user:password@host:port
  *   - kv://host:port
  *   - kv://user:password@host
+ *   - kv://[::1]:port (IPv6 literal)
+ *   - unix:///path/to.sock
+ *   - unix://user:password@/path/to.sock
  *
  * @param uri   URI string to parse.
  * @param info  Output connection info struct to populate.
@@ -60,6 +78,42 @@ std::string command_to_lowercase(std::string& input);
  * @return Vector of substrings.
  */
 std::vector<std::string> split(const std::string& s, char separator);
+
+/**
+ * @brief Tells whether a command may safely be sent twice.
+ *
+ * Reads and writes whose repeat leaves the same state (SET, DEL, HSET, ...)
+ * qualify; counters, list pushes/pops and anything unknown do not.
+ *
+ * @param name Command name, any case.
+ * @return True if the command can be replayed after a lost reply.
+ */
+bool is_idempotent(std::string_view name);
+
+/**
+ * @brief Tells whether an encoded request may safely be sent twice.
+ *
+ * Like is_idempotent(), but SET also depends on its options: EX and PX set
+ * a TTL relative to arrival and GET returns the previous value, so SET
+ * with any of them is not replayed. A SET whose arguments cannot be read
+ * from `request` (values referenced outside it) is not replayed either.
+ *
+ * @param request RESP request array, plain or typed dialect.
+ * @return True if the request can be replayed after a lost reply.
+ */
+bool is_idempotent_request(std::string_view request);
+
+/**
+ * @brief Splits a trailing `> file` redirection off a REPL line.
+ *
+ * The `>` must be a word of its own, followed by exactly one word without
+ * quotes, so `ECHO "a > b"` is left alone.
+ *
+ * @param input Command line; the redirection is removed when found.
+ * @param path  Output file name when found.
+ * @return True if the line ended with a redirection.
+ */
+bool split_redirect(std::string& input, std::string& path);
 }  // namespace cmd
 
 #endif  // _CLI_UTILS_HPP_
@@ -7,10 +7,21 @@
  * (encode→send→receive), and performs a graceful shutdown.
  */
 
+#include <fcntl.h>
+
+#include <memory>
+
+#include "include/argument.hpp"
+#include "include/capture.hpp"
 #include "include/client.hpp"
 #include "include/include.hpp"
 #include "include/logger.hpp"
+#include "include/metrics.hpp"
+#include "include/modes.hpp"
+#include "include/read_cache.hpp"
+#include "include/render.hpp"
 #include "include/resp.hpp"
+#include "include/startup_trace.hpp"
 #include "include/utils.hpp"
 
 /**
@@ -24,13 +35,46 @@
  * @return Exit code (0 = success, non-zero = error).
  */
 int main(int argc, char* argv[]) {
+  StartupTrace::start();
+
   // --------------------------------------------------
   //  @INFO Connect and initialize the client
   // --------------------------------------------------
-  KvClient client = network::connect_to_client(argc, argv);
+  KvCliOptions options;
+  KvClient client = network::connect_to_client(argc, argv, options);
   // Fix: Use reference instead of pointer
   const KvConnectionInfo* connection_info = client.getConnectionInfo();
 
+  /// @section Metrics Export
+  /// Rewrites the Prometheus textfile while any mode runs; both files are
+  /// written one last time when main() returns.
+  KvMetricsExporter metrics(options.metricsJson, options.metricsFile, std::chrono::seconds(options.metricsInterval));
+
+  /// @section Traffic Capture
+  /// Every client opened from here on records its frames, in every mode.
+  std::unique_ptr<KvCapture> capture;
+  if (!options.captureFile.empty()) {
+    std::string error;
+    capture = std::make_unique<KvCapture>();
+    if (!capture->open(options.captureFile, error)) {
+      Logger::error(error);
+      client.disconnect();
+      return 1;
+    }
+    KvCapture::install(capture.get());
+  }
+
+  /// @section Sharded Mode
+  /// Several -url values: the REPL and pipe mode spread keys over all of them.
+  /// The other modes run against the first node only.
+  if (!options.shards.empty()) {
+    if (!options.bench && !options.latency && options.importFile.empty() && options.exportFile.empty() && options.replayFile.empty()) {
+      client.disconnect();
+      return mode::sharded(options);
+    }
+    Logger::warn("Only the first of " + std::to_string(options.shards.size()) + " nodes is used in this mode.");
+  }
+
   /// @section Authentication
   /// If credentials were provided, send an AUTH command
   /// and verify the server’s response.
@@ -38,21 +82,14 @@ int main(int argc, char* argv[]) {
     // --------------------------------------------------
     // @INFO Authenticate the client
     // --------------------------------------------------
-    // Create a vector of arguments for the AUTH command
-    std::vector<std::string> auth_args = {connection_info->user, connection_info->password};
-
-    std::string auth_command = resp::encode_command("AUTH", auth_args);
-    if (client.sendCommand(auth_command)) {
-      std::string response = client.receiveResponse();
-      std::string decoded_response = resp::decode(response);
-      if (response == resp::encode_simple_string("OK")) {
-        Logger::success("Authentication successful.");
-      } else {
-        Logger::error("Authentication failed");
-        std::cerr << decoded_response << std::endl;
-        client.disconnect();
-        return 1;
-      }
+    std::string response;
+    if (client.authenticate(response)) {
+      Logger::success("Authentication successful.");
+    } else if (!response.empty()) {
+      Logger::error("Authentication failed");
+      std::cerr << resp::decode(response) << std::endl;
+      client.disconnect();
+      return 1;
     } else {
       Logger::error("Failed to send authentication command.");
       client.disconnect();
@@ -61,15 +98,84 @@ int main(int argc, char* argv[]) {
   } else {
     Logger::warn("Starting an unauthenticated session.");
   }
+  StartupTrace::mark("authenticate");
+
+  /// @section One-Shot Mode
+  /// `cli [flags] SET k v`: one round trip, exit code from the reply type.
+  if (!options.command.empty()) {
+    int status = mode::oneshot(client, options);
+    client.disconnect();
+    return status;
+  }
+  StartupTrace::report();
+
+  /// @section Benchmark Mode
+  /// The load generator opens its own connections from the same settings.
+  if (options.bench) {
+    KvConnectionInfo bench_info = *connection_info;
+    client.disconnect();
+    return mode::bench(bench_info, options);
+  }
+
+  /// @section Replay Mode
+  /// The capture is replayed over connections opened from the same settings.
+  if (!options.replayFile.empty()) {
+    KvConnectionInfo replay_info = *connection_info;
+    client.disconnect();
+    return mode::replay(replay_info, options);
+  }
+
+  /// @section Export Mode
+  /// Values are fetched over pooled connections opened from the same settings.
+  if (!options.exportFile.empty()) {
+    KvConnectionInfo export_info = *connection_info;
+    client.disconnect();
+    return mode::export_snapshot(export_info, options);
+  }
+
+  /// @section Latency Mode
+  /// Sample round trips on this connection until interrupted.
+  if (options.latency) {
+    int status = mode::latency(client, options);
+    client.disconnect();
+    return status;
+  }
+
+  /// @section Import Mode
+  /// Bulk-load a file through a pipeline, then exit.
+  if (!options.importFile.empty()) {
+    int status = mode::import(client, options);
+    client.disconnect();
+    return status;
+  }
+
+  /// @section Pipe Mode
+  /// Non-interactive input is streamed through a pipeline instead of the REPL.
+  if (options.pipe) {
+    int status = mode::pipe(client, options);
+    client.disconnect();
+    return status;
+  }
 
   /// @section REPL Loop
   /// Main interactive loop: read user input, parse and normalize it,
   /// handle special AUTH re-authentication, or encode & send any other command.
   // @INFO buffer to store the commands for each iteration
   std::string input;
+  resp::Buffer resp_command;
+  resp::OutputSink sink;
+  resp::Renderer renderer(sink, options.outputFormat);
+
+  // --cache: repeated reads are answered locally until a write, TTL or eviction
+  std::unique_ptr<KvReadCache> cache;
+  if (options.cache) cache = std::make_unique<KvReadCache>(options.cacheConfig());
+  KvReadCache::Ticket ticket;
+  std::vector<std::string_view> words;
+  std::string out_path;
 
   while (true) {
-    // Prompt for input
+    // Prompt for input, after any log lines still queued
+    Logger::flush();
     std::cout << client.getAddr() + "> ";
     std::getline(std::cin, input);
 
@@ -78,6 +184,12 @@ int main(int argc, char* argv[]) {
     if (cmd.empty()) continue;
     if (cmd == "exit" || cmd == "quit") break;
 
+    /// `:stats` prints the metrics registry instead of going to the server.
+    if (cmd == ":stats") {
+      std::cout << KvMetrics::table(KvMetrics::global().snapshot()) << std::flush;
+      continue;
+    }
+
     /// Handle in-loop AUTH command to reset credentials.
     std::vector<std::string> args = cmd::split(cmd, ' ');
     if (!args.empty() && args.at(0) == "auth") {
@@ -91,6 +203,10 @@ int main(int argc, char* argv[]) {
       // Use the fixed encode_command function directly
       std::string auth_command = resp::encode_command("AUTH", auth_args);
 
+      if (!client.isConnected() && !client.reconnect()) {
+        Logger::error("Not connected; AUTH was not sent.");
+        continue;
+      }
       if (client.sendCommand(auth_command)) {
         std::string response = client.receiveResponse();
         std::string decoded_response = resp::decode(response);
@@ -103,6 +219,8 @@ int main(int argc, char* argv[]) {
           newInfo.setPassword(args.size() > 2 ? args[2] : "");
 
           client.setAuthenticated(true);
+          // Another user may not see the same keys
+          if (cache) cache->clear();
           // Set the updated connection info
           client.setConnectionInfo(newInfo);
 
@@ -124,42 +242,67 @@ int main(int argc, char* argv[]) {
       continue;
     }
 
-    // Encode the command using RESP protocol and send.
-    // Parse the command and arguments with type awareness
-    // Split by space but respect quotes and arrays
-    std::vector<std::string> tokens = resp::tokenize(input);
+    /// `GET key > file` streams a bulk reply into the file instead of printing it.
+    bool redirected = cmd::split_redirect(input, out_path);
 
-    if (tokens.empty()) {
-      continue;
-    }
-
-    std::string command_name = tokens[0];
-
-    // Extract args, skipping the command name
-    std::vector<std::string> new_args(tokens.begin() + 1, tokens.end());
-
-    // Use our enhanced command encoder that applies type detection
-    std::string resp_command = resp::encode(input);
+    // Use our enhanced command encoder that applies type detection.
+    // Large values are sent straight from `input`, and `@path` words
+    // straight from the mapped file, instead of being copied.
+    resp_command.clear();
+    if (!resp::append_encoded(resp_command, input)) continue;  // unreadable @file, already logged
 
     // @INFO Send the command to the server
-    if (resp_command.empty()) {
+    if (resp_command.size() == 0) {
       Logger::error("Failed to encode command: " + input);
       continue;
     }
-    if (client.sendCommand(resp_command)) {
-      std::string response = client.receiveResponse();
-      std::string decoded_response = resp::decode(response);
-      if (response.empty()) {
-        Logger::error("Received empty response from server.");
+    if (redirected) {
+      // The reply bypasses the cache; drop it rather than track what the command writes
+      if (cache) cache->clear();
+      int fd = ::open(out_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+      if (fd < 0) {
+        Logger::error("Cannot open " + out_path + ": " + strerror(errno));
+        continue;
+      }
+      std::string_view reply;
+      int64_t streamed = -1;
+      bool answered = client.requestInto(resp_command, fd, reply, streamed);
+      close(fd);
+      if (streamed >= 0) {
+        Logger::success(std::to_string(streamed) + " bytes written to " + out_path);
+      } else if (answered) {
+        renderer.render(reply);
+        sink.flush();
+      }
+      continue;
+    }
+
+    std::string cached;
+    if (cache) {
+      resp::split_words(input, words);
+      if (cache->begin(words, ticket, cached)) {
+        renderer.render(cached);
+        sink.flush();
         continue;
       }
-      std::cout << decoded_response << std::endl;
+    }
+
+    // Reconnects transparently; only idempotent commands are replayed
+    // if the connection drops before the reply arrives. The reply is
+    // rendered straight from the receive buffer.
+    std::string_view response;
+    bool answered = client.request(resp_command, cmd::is_idempotent_request(resp_command.framing()), response);
+    if (cache) cache->complete(ticket, answered ? response : std::string_view());
+    if (answered) {
+      renderer.render(response);
+      sink.flush();
     }
   }
 
   /// @section Cleanup
   /// Disconnects the client and exit, logging the shutdown.
   client.disconnect();
+  if (cache) Logger::info(cache->summary());
   Logger::warn("Disconnecting from server...");
 
   return 0;
@@ -0,0 +1,286 @@
+/**
+ * @file bench.cpp
+ * @brief Implements mode::bench, the built-in load generator.
+ *
+ * Requests are encoded with resp::encode, exactly like REPL input, so the
+ * server sees the same dialect (including `:` integers and `#t`/`#f`
+ * booleans produced by resp::encode_token).
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <thread>
+
+#include "include/histogram.hpp"
+#include "include/logger.hpp"
+#include "include/metrics.hpp"
+#include "include/modes.hpp"
+#include "include/pool.hpp"
+#include "include/resp.hpp"
+
+namespace mode {
+
+namespace {
+
+/** @brief Commands the load generator can issue. */
+enum BenchCommand { BENCH_SET, BENCH_GET, BENCH_INCR, BENCH_DEL, BENCH_COMMAND_COUNT };
+
+const char* const BENCH_NAMES[BENCH_COMMAND_COUNT] = {"SET", "GET", "INCR", "DEL"};
+
+/** @brief Immutable workload description shared by all workers. */
+struct BenchPlan {
+  uint64_t weights[BENCH_COMMAND_COUNT]; /**< Relative frequency per command */
+  uint64_t weightSum;                    /**< Sum of weights */
+  uint64_t keyspace;                     /**< Number of distinct keys */
+  size_t pipeline;                       /**< Requests in flight per connection */
+  std::string valueElement;              /**< SET value, pre-encoded as a command element */
+};
+
+/** @brief Per-worker results, merged after the threads join. */
+struct BenchResult {
+  KvHistogram latency[BENCH_COMMAND_COUNT]; /**< Round-trip times in nanoseconds */
+  uint64_t errors[BENCH_COMMAND_COUNT] = {}; /**< Error replies per command */
+  bool failed = false;                       /**< A connection failed */
+};
+
+/**
+ * @brief Parse a mix such as "set=3,get=7" or "set,get,incr".
+ *
+ * @param mix  Mix specification.
+ * @param plan Plan whose weights are filled.
+ * @return False if the mix names an unknown command or has no weight.
+ */
+bool parse_mix(const std::string& mix, BenchPlan& plan) {
+  std::fill(plan.weights, plan.weights + BENCH_COMMAND_COUNT, 0);
+  plan.weightSum = 0;
+
+  for (const std::string& entry : cmd::split(mix, ',')) {
+    if (entry.empty()) continue;
+
+    std::vector<std::string> parts = cmd::split(entry, '=');
+    std::string name = cmd::command_to_lowercase(parts[0]);
+    uint64_t weight = parts.size() > 1 ? std::strtoull(parts[1].c_str(), nullptr, 10) : 1;
+
+    int index = -1;
+    for (int i = 0; i < BENCH_COMMAND_COUNT; ++i) {
+      std::string candidate = BENCH_NAMES[i];
+      if (name == cmd::command_to_lowercase(candidate)) index = i;
+    }
+    if (index < 0) {
+      Logger::error("Unknown command in --mix: " + parts[0]);
+      return false;
+    }
+    plan.weights[index] += weight;
+    plan.weightSum += weight;
+  }
+
+  if (plan.weightSum == 0) {
+    Logger::error("--mix must give at least one command a positive weight");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Build the SET value for the requested type.
+ *
+ * The value is raw text; encode_token later turns "111" into an integer and
+ * "true" into a boolean, just as it would for typed REPL input.
+ *
+ * @param type  string, int or bool.
+ * @param size  Requested size in bytes.
+ * @param value Output value text.
+ * @return False for an unknown type.
+ */
+bool make_value(const std::string& type, size_t size, std::string& value) {
+  if (type == "string") {
+    value.assign(size, 'x');
+  } else if (type == "int") {
+    value.assign(std::min<size_t>(size, 18), '1');  // stays within int64
+  } else if (type == "bool") {
+    value = "true";
+  } else {
+    Logger::error("Unknown --value-type: " + type + " (expected string, int or bool)");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Append one request to the outbox.
+ *
+ * Same layout as resp::encode: an array whose elements are encode_token
+ * output wrapped as bulk strings.
+ */
+void append_request(std::string& out, BenchCommand command, uint64_t key, const BenchPlan& plan) {
+  char key_text[32];
+  snprintf(key_text, sizeof(key_text), "%s:%012llu", command == BENCH_INCR ? "counter" : "key", static_cast<unsigned long long>(key));
+
+  resp::append_array_header(out, command == BENCH_SET ? 3 : 2);
+  resp::append_token_element(out, BENCH_NAMES[command]);
+  resp::append_token_element(out, key_text);
+  if (command == BENCH_SET) out += plan.valueElement;
+}
+
+/**
+ * @brief Drive a share of the connections from one thread.
+ *
+ * Each round writes a batch of `pipeline` requests to every connection,
+ * then collects the replies. Latency is measured from the batch write to
+ * the arrival of each reply.
+ */
+void run_worker(KvClientPool& pool, const BenchPlan& plan, size_t connections, uint64_t requests, uint64_t seed, BenchResult& result) {
+  std::vector<KvClientPool::Lease> clients;
+  for (size_t i = 0; i < connections; ++i) {
+    clients.push_back(pool.acquire());
+    if (!clients.back()) {
+      result.failed = true;
+      return;
+    }
+  }
+
+  std::mt19937_64 rng(seed);
+  std::uniform_int_distribution<uint64_t> pick_key(0, plan.keyspace - 1);
+  std::uniform_int_distribution<uint64_t> pick_weight(0, plan.weightSum - 1);
+
+  std::vector<std::vector<BenchCommand>> batches(clients.size());
+  std::vector<std::chrono::steady_clock::time_point> sent_at(clients.size());
+  std::string outbox;
+
+  while (requests > 0) {
+    for (size_t c = 0; c < clients.size() && requests > 0; ++c) {
+      size_t batch = static_cast<size_t>(std::min<uint64_t>(plan.pipeline, requests));
+      requests -= batch;
+      outbox.clear();
+      batches[c].clear();
+
+      for (size_t i = 0; i < batch; ++i) {
+        uint64_t roll = pick_weight(rng);
+        int command = 0;
+        while (roll >= plan.weights[command]) roll -= plan.weights[command++];
+
+        batches[c].push_back(static_cast<BenchCommand>(command));
+        append_request(outbox, static_cast<BenchCommand>(command), pick_key(rng), plan);
+      }
+
+      sent_at[c] = std::chrono::steady_clock::now();
+      if (!clients[c]->sendCommand(outbox)) {
+        clients[c].invalidate();
+        result.failed = true;
+        return;
+      }
+    }
+
+    for (size_t c = 0; c < clients.size(); ++c) {
+      for (BenchCommand command : batches[c]) {
+        std::string_view reply;
+        if (!clients[c]->receiveFrame(reply)) {
+          clients[c].invalidate();
+          result.failed = true;
+          return;
+        }
+        auto elapsed = std::chrono::steady_clock::now() - sent_at[c];
+        KvMetrics::global().reply(BENCH_NAMES[command], elapsed, reply);
+        result.latency[command].record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        if (!reply.empty() && reply[0] == '-') ++result.errors[command];
+      }
+      batches[c].clear();
+    }
+  }
+}
+
+/** @brief Print one report row. */
+void print_row(const std::string& name, const KvHistogram& latency, uint64_t errors, double seconds) {
+  std::cout << std::left << std::setw(6) << name << std::right << std::setw(10) << latency.count() << std::setw(8) << errors << std::setw(12)
+            << std::fixed << std::setprecision(0) << static_cast<double>(latency.count()) / seconds << std::setw(10)
+            << format_ms(static_cast<uint64_t>(latency.mean())) << std::setw(10) << format_ms(latency.percentile(50)) << std::setw(10)
+            << format_ms(latency.percentile(90)) << std::setw(10) << format_ms(latency.percentile(99)) << std::setw(10) << format_ms(latency.percentile(99.9))
+            << std::setw(10) << format_ms(latency.max()) << '\n';
+}
+
+}  // namespace
+
+/**
+ * @brief Run the load generator and print per-command latency percentiles.
+ *
+ * @param info    Connection settings for the benchmark connections.
+ * @param options Parsed run mode options.
+ * @return Exit code (0 = all connections survived the run).
+ */
+int bench(const KvConnectionInfo& info, const KvCliOptions& options) {
+  BenchPlan plan;
+  if (!parse_mix(options.benchMix, plan)) return 1;
+  plan.keyspace = options.benchKeyspace;
+  plan.pipeline = options.benchPipeline;
+
+  std::string value;
+  if (!make_value(options.benchValueType, options.benchValueSize, value)) return 1;
+  resp::append_token_element(plan.valueElement, value);
+
+  size_t clients = options.benchClients;
+  size_t threads = options.benchThreads > 0 ? options.benchThreads : std::max(1u, std::thread::hardware_concurrency());
+  threads = std::min(threads, clients);
+
+  Logger::info("Benchmarking " + std::to_string(options.benchRequests) + " requests over " + std::to_string(clients) + " connections, " +
+               std::to_string(threads) + " threads, pipeline " + std::to_string(plan.pipeline) + ", mix " + options.benchMix);
+
+  // Open and authenticate every connection before the clock starts.
+  KvPoolConfig pool_config;
+  pool_config.minSize = clients;
+  pool_config.maxSize = clients;
+  KvClientPool pool(info, pool_config);
+  if (pool.size() < clients) {
+    Logger::error("Could not open " + std::to_string(clients) + " benchmark connections");
+    return 1;
+  }
+
+  std::vector<BenchResult> results(threads);
+  std::vector<std::thread> workers;
+  auto start = std::chrono::steady_clock::now();
+
+  for (size_t t = 0; t < threads; ++t) {
+    // Spread connections and requests as evenly as possible.
+    size_t connections = clients / threads + (t < clients % threads ? 1 : 0);
+    uint64_t requests = options.benchRequests / threads + (t < options.benchRequests % threads ? 1 : 0);
+    workers.emplace_back(run_worker, std::ref(pool), std::cref(plan), connections, requests, 0x9e3779b97f4a7c15ULL * (t + 1), std::ref(results[t]));
+  }
+  for (std::thread& worker : workers) worker.join();
+
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  BenchResult total;
+  for (const BenchResult& result : results) {
+    total.failed = total.failed || result.failed;
+    for (int c = 0; c < BENCH_COMMAND_COUNT; ++c) {
+      total.latency[c].merge(result.latency[c]);
+      total.errors[c] += result.errors[c];
+    }
+  }
+
+  KvHistogram all;
+  uint64_t all_errors = 0;
+  for (int c = 0; c < BENCH_COMMAND_COUNT; ++c) {
+    all.merge(total.latency[c]);
+    all_errors += total.errors[c];
+  }
+
+  Logger::flush();
+  std::cout << std::left << std::setw(6) << "cmd" << std::right << std::setw(10) << "requests" << std::setw(8) << "errors" << std::setw(12) << "req/s"
+            << std::setw(10) << "avg ms" << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(10) << "p99.9"
+            << std::setw(10) << "max" << '\n';
+  for (int c = 0; c < BENCH_COMMAND_COUNT; ++c) {
+    if (total.latency[c].count() > 0) print_row(BENCH_NAMES[c], total.latency[c], total.errors[c], seconds);
+  }
+  print_row("ALL", all, all_errors, seconds);
+  std::cout.flush();
+
+  if (total.failed) {
+    Logger::error("Benchmark aborted: a connection failed after " + std::to_string(all.count()) + " replies");
+    return 1;
+  }
+  return 0;
+}
+
+}  // namespace mode
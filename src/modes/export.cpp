@@ -0,0 +1,292 @@
+/**
+ * @file export.cpp
+ * @brief Implements mode::export_snapshot, the parallel keyspace exporter.
+ *
+ * One connection walks the keyspace with SCAN and queues batches of keys.
+ * Worker threads, each with its own pooled connection, fetch a batch with
+ * pipelined GETs and write it to the snapshot as one checksummed block.
+ * Keys and values are stored exactly as the server returned them, and
+ * import sends them back as plain bulk strings, so they round-trip byte for
+ * byte.
+ */
+
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "include/logger.hpp"
+#include "include/metrics.hpp"
+#include "include/modes.hpp"
+#include "include/pool.hpp"
+#include "include/resp.hpp"
+#include "include/resp_reader.hpp"
+#include "include/snapshot.hpp"
+
+namespace mode {
+
+namespace {
+
+/** @brief Keys per SCAN call and per snapshot block. */
+constexpr size_t BATCH_KEYS = 1000;
+
+/** @brief Key batches queued per worker before SCAN waits. */
+constexpr size_t QUEUE_DEPTH = 4;
+
+/** @brief Bounded hand-off of key batches from the scanner to the workers. */
+class KeyQueue {
+ private:
+  std::deque<std::vector<std::string>> batches; /**< Batches waiting for a worker */
+  size_t limit;                                 /**< Max queued batches */
+  bool closed;                                  /**< No more batches will come */
+  std::mutex mutex;                             /**< Guards batches and closed */
+  std::condition_variable changed;              /**< Signalled on push, pop and close */
+
+ public:
+  explicit KeyQueue(size_t limit) : limit(limit), closed(false) {}
+
+  /** @brief Queue a batch, waiting while the queue is full; false once closed. */
+  bool push(std::vector<std::string> batch) {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&] { return closed || batches.size() < limit; });
+    if (closed) return false;
+    batches.push_back(std::move(batch));
+    changed.notify_all();
+    return true;
+  }
+
+  /** @brief Take a batch, waiting for one; false when closed and empty. */
+  bool pop(std::vector<std::string>& batch) {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&] { return closed || !batches.empty(); });
+    if (batches.empty()) return false;
+    batch = std::move(batches.front());
+    batches.pop_front();
+    changed.notify_all();
+    return true;
+  }
+
+  /** @brief Wake everyone; queued batches are still handed out. */
+  void close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    changed.notify_all();
+  }
+};
+
+/** @brief Counters shared by the workers. */
+struct ExportStats {
+  std::atomic<uint64_t> vanished{0}; /**< Keys deleted between SCAN and GET */
+  std::atomic<uint64_t> skipped{0};  /**< Keys whose GET failed (not a string) */
+  std::atomic<bool> failed{false};   /**< A connection or the file failed */
+};
+
+/**
+ * @brief Send one GET per key and collect the replies into `block`.
+ *
+ * @return False if the connection failed mid-batch.
+ */
+bool fetch_batch(KvClient& client, const std::vector<std::string>& keys, std::string& outbox, std::string& block, uint32_t& records,
+                 ExportStats& stats) {
+  outbox.clear();
+  block.clear();
+  records = 0;
+  for (const std::string& key : keys) resp::append_command(outbox, "GET", {key});
+  auto sent_at = std::chrono::steady_clock::now();
+  if (!client.sendCommand(outbox)) return false;
+
+  uint64_t vanished = 0;
+  uint64_t skipped = 0;
+  for (const std::string& key : keys) {
+    std::string_view reply;
+    if (!client.receiveFrame(reply)) return false;
+    KvMetrics::global().reply("GET", std::chrono::steady_clock::now() - sent_at, reply);
+
+    std::string_view value;
+    if (resp::read_bulk(reply, value)) {
+      KvSnapshotWriter::appendRecord(block, key, value);
+      ++records;
+    } else if (!reply.empty() && reply[0] == '-') {
+      ++skipped;
+    } else {
+      ++vanished;  // null: deleted or expired since SCAN
+    }
+  }
+  stats.vanished += vanished;
+  stats.skipped += skipped;
+  return true;
+}
+
+/**
+ * @brief Worker: fetch queued batches and write them as blocks.
+ *
+ * GET is idempotent, so a batch interrupted by a dropped connection is
+ * fetched again after reconnecting.
+ */
+void run_worker(KvClientPool& pool, const KvReconnectPolicy& policy, KeyQueue& queue, KvSnapshotWriter& writer, ExportStats& stats) {
+  KvClientPool::Lease client = pool.acquire();
+  if (!client) {
+    stats.failed = true;
+    queue.close();
+    return;
+  }
+  client->setReconnectPolicy(policy);
+
+  std::vector<std::string> keys;
+  std::string outbox;
+  std::string block;
+  uint32_t records = 0;
+
+  while (queue.pop(keys)) {
+    bool fetched = fetch_batch(*client, keys, outbox, block, records, stats);
+    if (!fetched && client->reconnect()) fetched = fetch_batch(*client, keys, outbox, block, records, stats);
+
+    if (!fetched || !writer.writeBlock(block, records)) {
+      if (!fetched) client.invalidate();
+      stats.failed = true;
+      queue.close();
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Walk the keyspace with SCAN and queue the keys in batches.
+ *
+ * Falls back to a single KEYS * when the server has no SCAN.
+ *
+ * @return False if the scan connection failed or the server refused both.
+ */
+bool scan_keys(KvClient& client, KeyQueue& queue, ExportStats& stats) {
+  std::string cursor = "0";
+  std::string count = std::to_string(BATCH_KEYS);
+  std::string command;
+  std::vector<std::string_view> parts;
+  std::vector<std::string_view> elements;
+  bool first = true;
+
+  do {
+    command.clear();
+    resp::append_command(command, "SCAN", {cursor, "COUNT", count});
+    std::string_view reply;
+    if (!client.sendCommand(command) || !client.receiveFrame(reply)) return false;
+
+    std::string_view next;
+    if (!resp::read_array(reply, parts) || parts.size() != 2 || !resp::read_bulk(parts[0], next) || !resp::read_array(parts[1], elements)) {
+      if (!first || reply.empty() || reply[0] != '-') {
+        Logger::error("Unexpected SCAN reply: " + resp::decode(reply));
+        return false;
+      }
+
+      // @INFO No SCAN on this server: list everything at once
+      Logger::warn("SCAN failed (" + resp::decode(reply) + "); listing keys with KEYS *");
+      command.clear();
+      resp::append_command(command, "KEYS", {"*"});
+      if (!client.sendCommand(command) || !client.receiveFrame(reply)) return false;
+      if (!resp::read_array(reply, elements)) {
+        Logger::error("Unexpected KEYS reply: " + resp::decode(reply));
+        return false;
+      }
+      next = "0";
+    }
+    first = false;
+    cursor.assign(next);
+
+    std::vector<std::string> batch;
+    std::string_view key;
+    for (std::string_view element : elements) {
+      if (!resp::read_bulk(element, key)) continue;
+      batch.emplace_back(key);
+      if (batch.size() == BATCH_KEYS) {
+        if (!queue.push(std::move(batch))) return !stats.failed;
+        batch.clear();
+      }
+    }
+    if (!batch.empty() && !queue.push(std::move(batch))) return !stats.failed;
+  } while (cursor != "0");
+
+  return true;
+}
+
+}  // namespace
+
+/**
+ * @brief Export every string key to a snapshot file.
+ *
+ * @param info    Connection settings for the export connections.
+ * @param options Parsed run mode options.
+ * @return Exit code (0 = the snapshot was written).
+ */
+int export_snapshot(const KvConnectionInfo& info, const KvCliOptions& options) {
+  size_t workers = options.exportConnections;
+  Logger::info("Exporting to " + options.exportFile + " over " + std::to_string(workers) + " connections");
+
+  // One extra connection runs the SCAN.
+  KvPoolConfig pool_config;
+  pool_config.minSize = workers + 1;
+  pool_config.maxSize = workers + 1;
+  KvClientPool pool(info, pool_config);
+  if (pool.size() < workers + 1) {
+    Logger::error("Could not open " + std::to_string(workers + 1) + " export connections");
+    return 1;
+  }
+
+  KvSnapshotWriter writer;
+  if (!writer.open(options.exportFile)) return 1;
+
+  KvReconnectPolicy policy;
+  policy.maxAttempts = options.reconnectAttempts;
+
+  KeyQueue queue(workers * QUEUE_DEPTH);
+  ExportStats stats;
+  auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < workers; ++t) {
+    threads.emplace_back(run_worker, std::ref(pool), std::cref(policy), std::ref(queue), std::ref(writer), std::ref(stats));
+  }
+
+  bool scanned = false;
+  {
+    KvClientPool::Lease scanner = pool.acquire();
+    if (scanner) {
+      scanned = scan_keys(*scanner, queue, stats);
+      if (!scanned) scanner.invalidate();
+    }
+  }
+  if (!scanned) stats.failed = true;
+  queue.close();
+  for (std::thread& thread : threads) thread.join();
+
+  if (stats.failed) {
+    writer.abort();
+    Logger::error("Export failed after " + std::to_string(writer.records()) + " keys; no snapshot was written");
+    return 1;
+  }
+  if (!writer.finish()) return 1;
+
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  double rate = seconds > 0 ? static_cast<double>(writer.records()) / seconds : 0.0;
+
+  std::ostringstream summary;
+  summary.setf(std::ios::fixed);
+  summary.precision(3);
+  summary << "exported: " << writer.records() << " keys (" << writer.bytes() << " bytes), skipped: " << stats.skipped << ", vanished: " << stats.vanished
+          << " in " << seconds << "s";
+  summary.precision(0);
+  summary << " (" << rate << " keys/s)";
+
+  if (stats.skipped > 0) {
+    Logger::warn(summary.str());
+    Logger::warn("Skipped keys hold non-string values, which GET cannot read");
+    return 0;
+  }
+  Logger::success(summary.str());
+  return 0;
+}
+
+}  // namespace mode
@@ -0,0 +1,446 @@
+/**
+ * @file import.cpp
+ * @brief Implements mode::import, the memory-mapped bulk loader.
+ *
+ * The input file is mapped and parsed in place: records are located with
+ * memchr over the mapping, encoded straight into the pipeline and never
+ * copied into per-line strings. CSV/TSV rows become `SET key value` with
+ * the same type-aware element encoding as REPL input. Snapshot records are
+ * sent as plain bulk strings, so keys and values round-trip byte for byte.
+ */
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+
+#include "include/logger.hpp"
+#include "include/mapped_file.hpp"
+#include "include/modes.hpp"
+#include "include/pipeline.hpp"
+#include "include/resp.hpp"
+#include "include/resp_reader.hpp"
+#include "include/snapshot.hpp"
+
+namespace mode {
+
+namespace {
+
+/** @brief Supported input layouts. */
+enum ImportFormat { IMPORT_CSV, IMPORT_TSV, IMPORT_COMMANDS, IMPORT_RESP, IMPORT_SNAPSHOT };
+
+/** @brief Error lines printed before the rest are only counted. */
+constexpr uint64_t MAX_REPORTED_ERRORS = 100;
+
+/** @brief Records parsed between progress clock checks. */
+constexpr uint64_t PROGRESS_STRIDE = 16384;
+
+/** @brief True if `path` ends with `suffix`. */
+bool ends_with(const std::string& path, const char* suffix) {
+  size_t n = strlen(suffix);
+  return path.size() >= n && path.compare(path.size() - n, n, suffix) == 0;
+}
+
+/**
+ * @brief Resolve the input format.
+ *
+ * "auto" picks a snapshot by its magic, then goes by file extension (.csv,
+ * .tsv, .resp), then falls back to raw RESP when the file starts with an
+ * array header and to commands otherwise.
+ *
+ * @param name   Format name from the command line.
+ * @param path   Input file path.
+ * @param data   Mapped file contents.
+ * @param format Output format.
+ * @return False for an unknown format name.
+ */
+bool resolve_format(const std::string& name, const std::string& path, std::string_view data, ImportFormat& format) {
+  if (name == "csv") {
+    format = IMPORT_CSV;
+  } else if (name == "tsv") {
+    format = IMPORT_TSV;
+  } else if (name == "commands") {
+    format = IMPORT_COMMANDS;
+  } else if (name == "resp") {
+    format = IMPORT_RESP;
+  } else if (name == "snapshot") {
+    format = IMPORT_SNAPSHOT;
+  } else if (name == "auto") {
+    if (snapshot::is_snapshot(data)) {
+      format = IMPORT_SNAPSHOT;
+    } else if (ends_with(path, ".csv")) {
+      format = IMPORT_CSV;
+    } else if (ends_with(path, ".tsv")) {
+      format = IMPORT_TSV;
+    } else if (ends_with(path, ".resp") || (!data.empty() && data[0] == '*')) {
+      format = IMPORT_RESP;
+    } else {
+      format = IMPORT_COMMANDS;
+    }
+  } else {
+    Logger::error("Unknown --import-format: " + name + " (expected auto, csv, tsv, commands, resp or snapshot)");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Take the next line from `data`, without its line terminator.
+ *
+ * @param data Whole input.
+ * @param pos  Read position; advanced past the newline.
+ * @param line Output line (CR before LF is stripped).
+ */
+void next_line(std::string_view data, size_t& pos, std::string_view& line) {
+  const char* start = data.data() + pos;
+  const char* nl = static_cast<const char*>(std::memchr(start, '\n', data.size() - pos));
+  size_t end = nl != nullptr ? static_cast<size_t>(nl - data.data()) : data.size();
+
+  line = data.substr(pos, end - pos);
+  if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+  pos = nl != nullptr ? end + 1 : end;
+}
+
+/**
+ * @brief A key/value row split out of a CSV or TSV record.
+ *
+ * Fields point into the mapping unless they had to be unescaped, in which
+ * case they point into the matching `unescaped` string.
+ */
+struct Row {
+  std::string_view fields[2]; /**< Key and value */
+  std::string unescaped[2];   /**< Storage for quoted fields with "" escapes */
+  size_t count;               /**< Fields seen, may exceed 2 */
+};
+
+/**
+ * @brief Read one CSV record (RFC 4180 quoting, may span lines).
+ *
+ * @param data  Whole input.
+ * @param pos   Read position; advanced past the record.
+ * @param lines Incremented by the number of newlines consumed.
+ * @param row   Output fields.
+ * @param error Set when the record is malformed.
+ * @return False if the record is malformed.
+ */
+bool read_csv_record(std::string_view data, size_t& pos, uint64_t& lines, Row& row, std::string& error) {
+  row.count = 0;
+  bool ok = true;
+
+  while (true) {
+    size_t index = row.count++;
+    std::string_view field;
+
+    if (pos < data.size() && data[pos] == '"') {
+      size_t start = ++pos;
+      bool escaped = false;
+      while (true) {
+        const char* quote = static_cast<const char*>(std::memchr(data.data() + pos, '"', data.size() - pos));
+        if (quote == nullptr) {
+          lines += std::count(data.begin() + start, data.end(), '\n');
+          pos = data.size();
+          error = "unterminated quoted field";
+          return false;
+        }
+        pos = static_cast<size_t>(quote - data.data()) + 1;
+        if (pos < data.size() && data[pos] == '"') {
+          escaped = true;  // "" inside a quoted field
+          ++pos;
+          continue;
+        }
+        break;
+      }
+
+      field = data.substr(start, pos - 1 - start);
+      lines += std::count(field.begin(), field.end(), '\n');
+      if (escaped && index < 2) {
+        std::string& out = row.unescaped[index];
+        out.clear();
+        for (size_t i = 0; i < field.size(); ++i) {
+          out += field[i];
+          if (field[i] == '"') ++i;  // skip the doubled quote
+        }
+        field = out;
+      }
+
+      if (pos < data.size() && data[pos] != ',' && data[pos] != '\n' && data[pos] != '\r') {
+        error = "unexpected character after closing quote";
+        ok = false;
+      }
+    } else {
+      size_t end = pos;
+      while (end < data.size() && data[end] != ',' && data[end] != '\n') ++end;
+      field = data.substr(pos, end - pos);
+      if (!field.empty() && field.back() == '\r' && (end == data.size() || data[end] == '\n')) field.remove_suffix(1);
+      pos = end;
+    }
+
+    if (index < 2) row.fields[index] = field;
+
+    // Skip to the delimiter; after a bad quote, discard up to the record end.
+    while (pos < data.size() && data[pos] != ',' && data[pos] != '\n') ++pos;
+    if (pos < data.size() && data[pos] == ',') {
+      ++pos;
+      continue;
+    }
+    if (pos < data.size()) ++pos;  // newline
+    ++lines;
+    return ok;
+  }
+}
+
+/**
+ * @brief Split a TSV line into key and value (no quoting, as in most TSV).
+ *
+ * @param line  One line without terminator.
+ * @param row   Output fields.
+ */
+void split_tsv(std::string_view line, Row& row) {
+  row.count = 0;
+  size_t pos = 0;
+  while (true) {
+    size_t tab = line.find('\t', pos);
+    std::string_view field = line.substr(pos, tab == std::string_view::npos ? std::string_view::npos : tab - pos);
+    if (row.count < 2) row.fields[row.count] = field;
+    ++row.count;
+    if (tab == std::string_view::npos) return;
+    pos = tab + 1;
+  }
+}
+
+/** @brief Append `SET key value` in the REPL dialect. */
+void append_set(std::string& out, const Row& row) {
+  resp::append_array_header(out, 3);
+  resp::append_token_element(out, "SET");
+  resp::append_token_element(out, row.fields[0]);
+  resp::append_token_element(out, row.fields[1]);
+}
+
+/**
+ * @brief Progress line on stderr, rewritten in place.
+ *
+ * Only shown when stderr is a terminal so redirected logs stay clean.
+ */
+class Progress {
+ private:
+  bool enabled;                                /**< stderr is a terminal */
+  size_t total;                                /**< Input size in bytes */
+  std::chrono::steady_clock::time_point start; /**< Import start */
+  std::chrono::steady_clock::time_point shown; /**< Last redraw */
+
+ public:
+  explicit Progress(size_t total) : enabled(isatty(STDERR_FILENO)), total(total), start(std::chrono::steady_clock::now()), shown(start) {}
+
+  /** @brief Redraw at most twice a second unless forced. */
+  void update(uint64_t rows, size_t offset, bool force = false) {
+    if (!enabled) return;
+    auto now = std::chrono::steady_clock::now();
+    if (!force && now - shown < std::chrono::milliseconds(500)) return;
+    shown = now;
+
+    double seconds = std::chrono::duration<double>(now - start).count();
+    double percent = total > 0 ? 100.0 * static_cast<double>(offset) / static_cast<double>(total) : 100.0;
+    char text[128];
+    snprintf(text, sizeof(text), "\r%llu rows  %5.1f%%  %.0f rows/s ", static_cast<unsigned long long>(rows), percent,
+             seconds > 0 ? static_cast<double>(rows) / seconds : 0.0);
+    std::cerr << text << std::flush;
+  }
+
+  /** @brief Clear the progress line. */
+  void finish() {
+    if (enabled) std::cerr << "\r\033[K" << std::flush;
+  }
+};
+
+}  // namespace
+
+/**
+ * @brief Bulk-load a memory-mapped file through a KvPipeline.
+ *
+ * @param client  Connected and authenticated client.
+ * @param options Parsed run mode options.
+ * @return Exit code (0 = every row was imported).
+ */
+int import(KvClient& client, const KvCliOptions& options) {
+  KvMappedFile file;
+  if (!file.open(options.importFile)) return 1;
+
+  std::string_view data = file.view();
+  ImportFormat format;
+  if (!resolve_format(options.importFormat, options.importFile, data, format)) return 1;
+
+  // Snapshots are checked before anything is sent; their rows are records.
+  KvSnapshotReader reader;
+  std::string error;
+  if (format == IMPORT_SNAPSHOT && !reader.open(data, error)) {
+    Logger::error(options.importFile + ": " + error);
+    return 1;
+  }
+  const std::string unit = format == IMPORT_SNAPSHOT ? "record " : "line ";
+
+  uint64_t rejected = 0;  // rows that failed to parse locally
+  uint64_t failed = 0;    // rows the server answered with an error
+  uint64_t reported = 0;
+  auto report = [&](uint64_t line, const std::string& message) {
+    if (reported++ < MAX_REPORTED_ERRORS) {
+      Logger::error(unit + std::to_string(line) + ": " + message);
+    } else if (reported == MAX_REPORTED_ERRORS + 1) {
+      Logger::warn("Further row errors are counted but not printed");
+    }
+  };
+
+  // Line numbers of commands in flight, in send order.
+  std::deque<uint64_t> pending_lines;
+  KvPipeline pipeline(client, options.pipeWindow, [&](uint64_t, std::string_view reply) {
+    uint64_t line = pending_lines.front();
+    pending_lines.pop_front();
+    if (!reply.empty() && reply[0] == '-') {
+      ++failed;
+      report(line, resp::decode(reply));
+    }
+  });
+
+  Progress progress(data.size());
+  auto start = std::chrono::steady_clock::now();
+
+  bool healthy = true;
+  size_t pos = 0;
+  uint64_t line_no = 1;  // line of the record being parsed
+  uint64_t rows = 0;
+  Row row;
+  std::string out;
+  size_t block_index = 0;     // next snapshot block
+  std::string_view records;  // unsent records of the current block
+
+  while (healthy && pos < data.size()) {
+    uint64_t record_line = line_no;
+    out.clear();
+    std::string_view command;
+
+    switch (format) {
+      case IMPORT_CSV:
+      case IMPORT_TSV: {
+        bool parsed = true;
+        if (format == IMPORT_CSV) {
+          if (data[pos] == '\n' || (data[pos] == '\r' && pos + 1 < data.size() && data[pos + 1] == '\n')) {
+            pos += data[pos] == '\r' ? 2 : 1;  // blank line
+            ++line_no;
+            continue;
+          }
+          parsed = read_csv_record(data, pos, line_no, row, error);
+        } else {
+          std::string_view line;
+          next_line(data, pos, line);
+          ++line_no;
+          if (line.empty()) continue;
+          split_tsv(line, row);
+        }
+
+        if (parsed && row.count != 2) {
+          error = "expected 2 columns (key, value), found " + std::to_string(row.count);
+          parsed = false;
+        }
+        if (!parsed) {
+          ++rejected;
+          report(record_line, error);
+          continue;
+        }
+        append_set(out, row);
+        command = out;
+        break;
+      }
+
+      case IMPORT_COMMANDS: {
+        std::string_view line;
+        next_line(data, pos, line);
+        ++line_no;
+        if (line.find_first_not_of(" \t\r\f\v") == std::string_view::npos) continue;
+        resp::append_encoded(out, line);
+        command = out;
+        break;
+      }
+
+      case IMPORT_RESP: {
+        size_t length = 0;
+        resp::Reader::Status status = resp::scan_frame(data.substr(pos), length);
+        if (status != resp::Reader::Status::COMPLETE) {
+          ++rejected;
+          report(record_line, status == resp::Reader::Status::INCOMPLETE ? "truncated RESP frame at end of file" : "malformed RESP frame");
+          pos = data.size();  // no way to resynchronise
+          continue;
+        }
+        command = data.substr(pos, length);  // already RESP, sent as is
+        line_no += std::count(command.begin(), command.end(), '\n');
+        pos += length;
+        break;
+      }
+
+      case IMPORT_SNAPSHOT: {
+        if (records.empty()) {
+          if (block_index == reader.blockCount()) {
+            pos = data.size();
+            continue;
+          }
+          size_t block = block_index++;
+          if (!reader.block(block, records, error)) {
+            uint32_t lost = reader.blockRecords(block);
+            rejected += lost;
+            line_no += lost;
+            report(record_line, error + "; skipped its " + std::to_string(lost) + " records");
+          }
+          continue;
+        }
+
+        std::string_view key;
+        std::string_view value;
+        if (!KvSnapshotReader::nextRecord(records, key, value)) {
+          ++rejected;
+          report(record_line, "record runs past the end of its block");
+          records = {};
+          continue;
+        }
+        resp::append_command(out, "SET", {key, value});
+        command = out;
+        ++line_no;
+        pos = static_cast<size_t>(records.data() - data.data());
+        break;
+      }
+    }
+
+    pending_lines.push_back(record_line);
+    healthy = pipeline.push(command);
+    if (++rows % PROGRESS_STRIDE == 0) progress.update(rows, pos);
+  }
+
+  healthy = healthy && pipeline.drain();
+  progress.update(rows, pos, true);
+  progress.finish();
+
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  double rate = seconds > 0 ? static_cast<double>(pipeline.received()) / seconds : 0.0;
+
+  std::ostringstream summary;
+  summary.setf(std::ios::fixed);
+  summary.precision(3);
+  summary << "imported: " << pipeline.received() - failed << ", failed: " << failed << ", rejected: " << rejected << " in " << seconds << "s";
+  if (pipeline.replayed() > 0) summary << ", replayed: " << pipeline.replayed();
+  summary.precision(0);
+  summary << " (" << rate << " rows/s)";
+
+  if (!healthy) {
+    Logger::error("Connection lost with " + std::to_string(pipeline.sent() - pipeline.received()) + " rows unacknowledged");
+    Logger::error(summary.str());
+    return 1;
+  }
+
+  if (failed > 0 || rejected > 0) {
+    Logger::warn(summary.str());
+    return 1;
+  }
+
+  Logger::success(summary.str());
+  return 0;
+}
+
+}  // namespace mode
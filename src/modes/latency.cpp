@@ -0,0 +1,173 @@
+/**
+ * @file latency.cpp
+ * @brief Implements mode::latency, the round-trip latency monitor.
+ *
+ * A PING is sent every few milliseconds over the existing connection and
+ * each round trip is recorded in a KvHistogram (nanoseconds). The monitor
+ * runs until interrupted with Ctrl-C, then prints the overall figures.
+ */
+
+#include <signal.h>
+#include <time.h>
+
+#include <chrono>
+#include <iomanip>
+#include <thread>
+
+#include "include/histogram.hpp"
+#include "include/logger.hpp"
+#include "include/metrics.hpp"
+#include "include/modes.hpp"
+#include "include/resp.hpp"
+
+namespace mode {
+
+namespace {
+
+/** @brief Pause between samples, so the monitor itself adds no load. */
+constexpr std::chrono::milliseconds SAMPLE_PAUSE(10);
+
+/** @brief Heatmap column upper bounds in microseconds; the last is open. */
+constexpr uint64_t HEATMAP_BOUNDS_US[] = {100, 250, 500, 1000, 2000, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000};
+constexpr size_t HEATMAP_COLUMNS = sizeof(HEATMAP_BOUNDS_US) / sizeof(HEATMAP_BOUNDS_US[0]) + 1;
+
+/** @brief Set by SIGINT to end the run. */
+volatile sig_atomic_t g_stop = 0;
+
+void on_interrupt(int) {
+  g_stop = 1;
+}
+
+/** @brief One-line summary of a histogram. */
+std::string summarize(const KvHistogram& latency) {
+  return "min: " + format_ms(latency.min()) + ", avg: " + format_ms(static_cast<uint64_t>(latency.mean())) + ", p50: " + format_ms(latency.percentile(50)) +
+         ", p99: " + format_ms(latency.percentile(99)) + ", p99.9: " + format_ms(latency.percentile(99.9)) + ", max: " + format_ms(latency.max()) + " ms (" +
+         std::to_string(latency.count()) + " samples)";
+}
+
+/** @brief Heatmap column for a sample. */
+size_t heatmap_column(uint64_t ns) {
+  size_t column = 0;
+  while (column < HEATMAP_COLUMNS - 1 && ns / 1000 >= HEATMAP_BOUNDS_US[column]) ++column;
+  return column;
+}
+
+/** @brief Column labels, printed once above the heatmap. */
+void print_heatmap_legend() {
+  std::cout << std::setw(10) << "ms <";
+  for (size_t c = 0; c < HEATMAP_COLUMNS - 1; ++c) {
+    std::ostringstream label;
+    label << static_cast<double>(HEATMAP_BOUNDS_US[c]) / 1000;
+    std::cout << std::setw(6) << label.str();
+  }
+  std::cout << std::setw(6) << "more" << '\n';
+}
+
+/**
+ * @brief Print one heatmap row: a shade per column by share of samples.
+ *
+ * Shades go from blank (none) through light, medium and dark to full
+ * (half or more of the interval's samples).
+ */
+void print_heatmap_row(const uint64_t (&columns)[HEATMAP_COLUMNS], const KvHistogram& latency) {
+  static const char* const SHADES[] = {" ", "░", "▒", "▓", "█"};
+
+  std::time_t now = std::time(nullptr);
+  char stamp[16];
+  std::strftime(stamp, sizeof(stamp), "%H:%M:%S", std::localtime(&now));
+  std::cout << stamp << " |";
+
+  uint64_t total = latency.count();
+  for (uint64_t samples : columns) {
+    double share = total > 0 ? static_cast<double>(samples) / static_cast<double>(total) : 0.0;
+    int shade = samples == 0 ? 0 : share <= 0.01 ? 1 : share <= 0.10 ? 2 : share <= 0.50 ? 3 : 4;
+    std::cout << ' ';
+    for (int i = 0; i < 5; ++i) std::cout << SHADES[shade];
+  }
+  std::cout << " | p99 " << format_ms(latency.percentile(99)) << " ms, " << total << " samples" << std::endl;
+}
+
+}  // namespace
+
+/**
+ * @brief Sample round-trip latency until interrupted.
+ *
+ * @param client  Connected and authenticated client.
+ * @param options Parsed run mode options.
+ * @return Exit code (0 = stopped by the user).
+ */
+int latency(KvClient& client, const KvCliOptions& options) {
+  bool history = options.latencyHistory || options.latencyDist;
+  auto interval = std::chrono::seconds(options.latencyInterval > 0 ? options.latencyInterval : options.latencyDist ? 1 : 15);
+  bool tty = isatty(STDOUT_FILENO);
+
+  struct sigaction action = {};
+  action.sa_handler = on_interrupt;
+  sigemptyset(&action.sa_mask);
+  struct sigaction previous;
+  sigaction(SIGINT, &action, &previous);
+
+  Logger::info("Sampling PING latency every " + std::to_string(SAMPLE_PAUSE.count()) + " ms, Ctrl-C to stop");
+  Logger::flush();
+  if (options.latencyDist) print_heatmap_legend();
+
+  const std::string ping = resp::encode_command("PING", {});
+  KvHistogram total;
+  KvHistogram window;
+  uint64_t columns[HEATMAP_COLUMNS] = {};
+  auto window_start = std::chrono::steady_clock::now();
+  auto shown = window_start;
+  int status = 0;
+
+  while (!g_stop) {
+    auto sent_at = std::chrono::steady_clock::now();
+    std::string_view reply;
+    if (!client.sendCommand(ping) || !client.receiveFrame(reply)) {
+      if (g_stop) break;  // interrupted mid round trip
+      Logger::error("Connection lost while sampling latency");
+      status = 1;
+      break;
+    }
+    auto now = std::chrono::steady_clock::now();
+    KvMetrics::global().reply("PING", now - sent_at, reply);
+
+    if (!reply.empty() && reply[0] == '-') {
+      Logger::error("PING failed: " + resp::decode(reply));
+      status = 1;
+      break;
+    }
+
+    uint64_t elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - sent_at).count());
+    total.record(elapsed);
+    window.record(elapsed);
+    ++columns[heatmap_column(elapsed)];
+
+    if (history && now - window_start >= interval) {
+      if (options.latencyDist) {
+        print_heatmap_row(columns, window);
+      } else {
+        double seconds = std::chrono::duration<double>(now - window_start).count();
+        std::ostringstream range;
+        range << std::fixed << std::setprecision(2) << seconds;
+        std::cout << (tty ? "\r" : "") << summarize(window) << " -- " << range.str() << " seconds range" << std::endl;
+      }
+      window.reset();
+      std::fill(std::begin(columns), std::end(columns), 0);
+      window_start = now;
+    } else if (tty && !options.latencyDist && now - shown >= std::chrono::milliseconds(250)) {
+      std::cout << "\r\033[K" << summarize(history ? window : total) << std::flush;
+      shown = now;
+    }
+
+    std::this_thread::sleep_for(SAMPLE_PAUSE);
+  }
+
+  sigaction(SIGINT, &previous, nullptr);
+  if (tty) std::cout << "\r\033[K";
+  if (total.count() > 0) {
+    Logger::success("Overall " + summarize(total));
+  }
+  return status;
+}
+
+}  // namespace mode
@@ -0,0 +1,144 @@
+/**
+ * @file oneshot.cpp
+ * @brief Implements mode::oneshot, a single command given on the command line.
+ *
+ * Meant to be called from shell scripts many times over, so nothing is
+ * set up beyond what one round trip needs: no read cache, no REPL state
+ * and a small output buffer.
+ */
+
+#include <fcntl.h>
+
+#include "include/logger.hpp"
+#include "include/modes.hpp"
+#include "include/render.hpp"
+#include "include/resp.hpp"
+#include "include/resp_visit.hpp"
+#include "include/startup_trace.hpp"
+#include "include/utils.hpp"
+
+namespace mode {
+
+namespace {
+
+/** @brief Output buffer; larger replies are written straight through. */
+constexpr size_t ONESHOT_SINK_SIZE = 16 * 1024;
+
+/**
+ * @class ReplyKind
+ * @brief Visitor that notes whether the top-level value is an error or a null.
+ */
+class ReplyKind : public resp::Visitor {
+ private:
+  int depth = 0;      /**< Aggregates open around the current value */
+  int attributes = 0; /**< Depth inside attributes, which are skipped */
+  bool seen = false;  /**< The top-level value was reported */
+
+  void note(bool isError, bool isNull) {
+    if (seen || depth > 0 || attributes > 0) return;
+    seen = true;
+    error = isError;
+    null = isNull;
+  }
+
+ public:
+  bool error = false;
+  bool null = false;
+
+  void onString(resp::Type type, std::string_view) { note(type == resp::Type::ERROR || type == resp::Type::BULK_ERROR, false); }
+  void onInteger(int64_t, std::string_view) { note(false, false); }
+  void onDouble(double, std::string_view) { note(false, false); }
+  void onBoolean(bool) { note(false, false); }
+  void onNull(resp::Type) { note(false, true); }
+
+  void onBegin(resp::Type type, int64_t) {
+    if (type == resp::Type::ATTRIBUTE || attributes > 0) {
+      ++attributes;
+      return;
+    }
+    note(false, false);
+    ++depth;
+  }
+
+  void onEnd(resp::Type) {
+    if (attributes > 0) {
+      --attributes;
+    } else {
+      --depth;
+    }
+  }
+};
+
+}  // namespace
+
+/**
+ * @brief Map a reply to the one-shot exit code.
+ *
+ * @param reply Raw reply.
+ * @return 0 value, 1 empty or malformed, 2 error, 3 null.
+ */
+int reply_status(std::string_view reply) {
+  ReplyKind kind;
+  size_t length = 0;
+  if (reply.empty() || resp::visit(reply, kind, length) != resp::Reader::Status::COMPLETE) return 1;
+  if (kind.error) return 2;
+  if (kind.null) return 3;
+  return 0;
+}
+
+/**
+ * @brief Send the command-line command and print its reply.
+ *
+ * With --out, a bulk string reply is streamed into the file (or stdout)
+ * as it arrives, so a value of any size needs no more memory than a small
+ * one. Other replies are printed as usual.
+ *
+ * @param client  Connected and authenticated client.
+ * @param options Parsed run mode options.
+ * @return Exit code from reply_status(), or 1 if no reply arrived.
+ */
+int oneshot(KvClient& client, const KvCliOptions& options) {
+  resp::Buffer command;
+  resp::append_array_header(command.framing(), options.command.size());
+  for (const std::string& word : options.command) {
+    if (!resp::append_token_element(command, word)) return 1;  // unreadable @file, already logged
+  }
+  StartupTrace::mark("encode");
+
+  std::string_view reply;
+  bool answered = false;
+  if (!options.outFile.empty()) {
+    bool to_stdout = options.outFile == "-";
+    int fd = to_stdout ? STDOUT_FILENO : ::open(options.outFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+      Logger::error("Cannot open " + options.outFile + ": " + strerror(errno));
+      return 1;
+    }
+    int64_t streamed = -1;
+    answered = client.requestInto(command, fd, reply, streamed);
+    if (!to_stdout) close(fd);
+    StartupTrace::mark("round trip");
+    if (answered && streamed >= 0) {
+      StartupTrace::report();
+      return 0;
+    }
+  } else {
+    answered = client.request(command, cmd::is_idempotent_request(command.framing()), reply);
+    StartupTrace::mark("round trip");
+  }
+  if (!answered) {
+    Logger::error("No reply to " + options.command[0]);
+    StartupTrace::report();
+    return 1;
+  }
+
+  resp::OutputSink sink(STDOUT_FILENO, ONESHOT_SINK_SIZE);
+  resp::Renderer(sink, options.outputFormat).render(reply);
+  sink.flush();
+  StartupTrace::mark("print");
+  StartupTrace::report();
+
+  return reply_status(reply);
+}
+
+}  // namespace mode
@@ -0,0 +1,160 @@
+/**
+ * @file pipe.cpp
+ * @brief Implements mode::pipe, the pipelined batch mode.
+ */
+
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <memory>
+
+#include "include/logger.hpp"
+#include "include/modes.hpp"
+#include "include/pipeline.hpp"
+#include "include/read_cache.hpp"
+#include "include/render.hpp"
+#include "include/resp.hpp"
+
+namespace mode {
+
+/**
+ * @brief Encode one input line the same way the REPL would.
+ *
+ * AUTH is sent with plain bulk-string arguments; everything else goes
+ * through the type-aware encoder.
+ *
+ * @param line Raw input line.
+ * @param cmd  Lowercased, trimmed copy of the line.
+ * @param out  Reused output buffer; the command is appended.
+ */
+static void encode_line(const std::string& line, const std::string& cmd, std::string& out) {
+  if (cmd.compare(0, 5, "auth ") == 0) {
+    std::vector<std::string> tokens = resp::tokenize(line);
+    std::vector<std::string> auth_args(tokens.begin() + 1, tokens.end());
+    out += resp::encode_command("AUTH", auth_args);
+    return;
+  }
+  resp::append_encoded(out, line);
+}
+
+/**
+ * @brief Stream commands through a KvPipeline and print replies in order.
+ *
+ * @param client  Connected and authenticated client.
+ * @param options Parsed run mode options.
+ * @return Exit code (0 = every command succeeded).
+ */
+int pipe(KvClient& client, const KvCliOptions& options) {
+  std::ifstream file;
+  std::istream* in = &std::cin;
+  if (!options.inputFile.empty()) {
+    file.open(options.inputFile);
+    if (!file) {
+      Logger::error("Cannot open input file: " + options.inputFile);
+      return 1;
+    }
+    in = &file;
+  }
+
+  // Replies are rendered straight into a large stdout buffer that is only
+  // written out when full, not once per line.
+  resp::OutputSink sink;
+  resp::Renderer renderer(sink, options.outputFormat);
+  uint64_t ok = 0;
+  uint64_t errors = 0;
+  auto print = [&](std::string_view reply) {
+    if (!reply.empty() && (reply[0] == '-' || reply[0] == '!')) {
+      ++errors;
+    } else {
+      ++ok;
+    }
+    renderer.render(reply);
+  };
+
+  // With --cache, a hit is printed once every command sent before it has
+  // been answered, so the output stays in input order. `tickets` follows the
+  // pipeline's commands; `hits` holds answers waiting for their turn along
+  // with the number of replies that must be printed first.
+  std::unique_ptr<KvReadCache> cache;
+  if (options.cache) cache = std::make_unique<KvReadCache>(options.cacheConfig());
+  std::deque<KvReadCache::Ticket> tickets;
+  std::deque<std::pair<uint64_t, std::string>> hits;
+  uint64_t pushed = 0;
+  uint64_t answered = 0;
+
+  KvPipeline pipeline(client, options.pipeWindow, [&](uint64_t, std::string_view reply) {
+    if (cache) {
+      cache->complete(tickets.front(), reply);
+      tickets.pop_front();
+    }
+    print(reply);
+    ++answered;
+    while (!hits.empty() && hits.front().first == answered) {
+      print(hits.front().second);
+      hits.pop_front();
+    }
+  });
+
+  auto start = std::chrono::steady_clock::now();
+  bool healthy = true;
+  std::string line;
+  std::string resp_command;
+  std::vector<std::string_view> words;
+  std::string cached;
+
+  while (healthy && std::getline(*in, line)) {
+    std::string cmd = cmd::command_to_lowercase(line);
+    if (cmd.empty()) continue;
+    if (cmd == "exit" || cmd == "quit") break;
+
+    if (cache) {
+      resp::split_words(line, words);
+      tickets.emplace_back();
+      if (cache->begin(words, tickets.back(), cached)) {
+        tickets.pop_back();
+        if (answered == pushed) {
+          print(cached);
+        } else {
+          hits.emplace_back(pushed, std::move(cached));
+        }
+        continue;
+      }
+    }
+
+    resp_command.clear();
+    encode_line(line, cmd, resp_command);
+    ++pushed;
+    healthy = pipeline.push(resp_command);
+  }
+
+  healthy = healthy && pipeline.drain();
+  sink.flush();
+
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  double rate = seconds > 0 ? static_cast<double>(pipeline.received()) / seconds : 0.0;
+
+  std::ostringstream summary;
+  summary.setf(std::ios::fixed);
+  summary.precision(3);
+  summary << "sent: " << pipeline.sent() << ", ok: " << ok << ", errors: " << errors << " in " << seconds << "s";
+  if (pipeline.replayed() > 0) summary << ", replayed: " << pipeline.replayed();
+  summary.precision(0);
+  summary << " (" << rate << " cmd/s)";
+  if (cache) Logger::info(cache->summary());
+
+  if (!healthy) {
+    Logger::error("Connection lost with " + std::to_string(pipeline.sent() - pipeline.received()) + " replies outstanding");
+    Logger::error(summary.str());
+    return 1;
+  }
+
+  if (errors > 0) {
+    Logger::warn(summary.str());
+    return 1;
+  }
+
+  Logger::success(summary.str());
+  return 0;
+}
+
+}  // namespace mode
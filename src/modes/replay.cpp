@@ -0,0 +1,267 @@
+/**
+ * @file replay.cpp
+ * @brief Implements mode::replay, which plays a traffic capture back against a server.
+ *
+ * Every recorded command is sent at its recorded time, scaled by
+ * --replay-speed, from one scheduler thread. The connections are
+ * KvAsyncClients on a single event loop, so a slow reply never holds back
+ * the schedule: latency is measured from the actual send, and the lag
+ * behind the recorded timing is reported separately.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#include "include/async_client.hpp"
+#include "include/capture.hpp"
+#include "include/histogram.hpp"
+#include "include/logger.hpp"
+#include "include/metrics.hpp"
+#include "include/modes.hpp"
+#include "include/render.hpp"
+#include "include/resp.hpp"
+#include "include/resp_reader.hpp"
+
+namespace mode {
+
+namespace {
+
+/** @brief Differing replies described in the report. */
+constexpr size_t MAX_MISMATCH_SAMPLES = 5;
+
+/** @brief One recorded command and the reply it got. */
+struct ReplayRequest {
+  uint64_t at;               /**< Recorded send time, ns after the first recorded send */
+  size_t stream;             /**< Recorded connection, numbered in order of appearance */
+  std::string_view command;  /**< Frame as recorded */
+  std::string_view expected; /**< Recorded reply (empty = none was recorded) */
+};
+
+/** @brief Replay results; only the loop thread touches them until the end. */
+struct ReplayResult {
+  KvHistogram latency;              /**< Round-trip times in nanoseconds */
+  uint64_t replies = 0;             /**< Replies received */
+  uint64_t errors = 0;              /**< Error replies */
+  uint64_t mismatches = 0;          /**< Replies that differ from the recorded ones */
+  uint64_t unchecked = 0;           /**< Replies with no recorded reply to compare */
+  uint64_t failed = 0;              /**< Commands lost to a failed connection */
+  std::vector<std::string> samples; /**< The first few mismatches, described */
+};
+
+/** @brief Commands in flight, shared by the scheduler and the loop thread. */
+struct ReplayFlow {
+  std::mutex mutex;
+  std::condition_variable changed;
+  uint64_t inFlight = 0;
+};
+
+/**
+ * @brief Turn a capture into the commands to send, in recorded order.
+ *
+ * Sent records are split into frames, and each received record is matched
+ * to the oldest unanswered command of its connection. A reply that was
+ * streamed to a file was recorded without its body, so its command is
+ * answered but left unchecked. The redacted AUTH
+ * frames are dropped along with their replies: the replay connections
+ * authenticate with the credentials given on the command line instead.
+ *
+ * @param reader   Open capture.
+ * @param requests Output commands, sorted by send time.
+ * @param streams  Output number of recorded connections.
+ * @return False if the capture holds no commands.
+ */
+bool load_requests(KvCaptureReader& reader, std::vector<ReplayRequest>& requests, size_t& streams) {
+  std::unordered_map<uint32_t, size_t> stream_of;
+  std::vector<std::deque<size_t>> unanswered;
+  std::vector<bool> redacted;
+  uint64_t first_send = 0;
+
+  KvCaptureReader::Record record;
+  while (reader.next(record)) {
+    auto found = stream_of.emplace(record.connection, stream_of.size());
+    size_t stream = found.first->second;
+    if (found.second) unanswered.emplace_back();
+
+    if (record.direction == capture::Direction::RECEIVED) {
+      // Replies to commands sent before the capture started have no match
+      if (unanswered[stream].empty()) continue;
+      size_t length = 0;
+      if (resp::scan_frame(record.payload, length) == resp::Reader::Status::COMPLETE) {
+        requests[unanswered[stream].front()].expected = record.payload;
+      }
+      unanswered[stream].pop_front();
+      continue;
+    }
+    if (record.direction != capture::Direction::SENT) continue;
+
+    if (requests.empty()) first_send = record.stamp;
+    std::string_view payload = record.payload;
+    while (!payload.empty()) {
+      size_t length = 0;
+      if (resp::scan_frame(payload, length) != resp::Reader::Status::COMPLETE) {
+        Logger::warn("Skipping " + std::to_string(payload.size()) + " bytes that are not a complete RESP frame");
+        break;
+      }
+      unanswered[stream].push_back(requests.size());
+      redacted.push_back(payload.substr(0, length) == capture::REDACTED_AUTH);
+      requests.push_back({record.stamp - std::min(record.stamp, first_send), stream, payload.substr(0, length), {}});
+      payload.remove_prefix(length);
+    }
+  }
+  if (reader.isTruncated()) Logger::warn("The capture ends in a partial record; replaying what precedes it.");
+
+  size_t kept = 0;
+  for (size_t i = 0; i < requests.size(); ++i) {
+    if (!redacted[i]) requests[kept++] = requests[i];
+  }
+  requests.resize(kept);
+
+  // Records are written in the order space was reserved, which can differ
+  // slightly from timestamp order across threads; one connection's records
+  // are always in order, and a stable sort keeps them so.
+  std::stable_sort(requests.begin(), requests.end(), [](const ReplayRequest& a, const ReplayRequest& b) { return a.at < b.at; });
+  streams = stream_of.size();
+  return !requests.empty();
+}
+
+/** @brief Describe a reply that differs from the recorded one. */
+std::string describe_mismatch(std::string_view command, std::string_view expected, std::string_view reply) {
+  return std::string(resp::command_name(command)) + ": recorded " + resp::format_reply(expected) + ", got " + resp::format_reply(reply);
+}
+
+}  // namespace
+
+/**
+ * @brief Replay a capture and report latency and differing replies.
+ *
+ * @param info    Connection settings for the replay connections.
+ * @param options Parsed run mode options.
+ * @return Exit code (0 = every reply arrived and matched the recording).
+ */
+int replay(const KvConnectionInfo& info, const KvCliOptions& options) {
+  KvCaptureReader reader;
+  std::string error;
+  if (!reader.open(options.replayFile, error)) {
+    Logger::error(error);
+    return 1;
+  }
+
+  std::vector<ReplayRequest> requests;
+  size_t streams = 0;
+  if (!load_requests(reader, requests, streams)) {
+    Logger::error("No commands to replay in " + options.replayFile);
+    return 1;
+  }
+
+  size_t connections = options.replayConnections > 0 ? options.replayConnections : streams;
+  double speed = options.replaySpeed;
+  std::ostringstream pace;
+  if (speed > 0) {
+    pace << "at " << speed << "x speed";
+  } else {
+    pace << "as fast as possible";
+  }
+  Logger::info("Replaying " + std::to_string(requests.size()) + " commands from " + std::to_string(streams) + " recorded connections over " +
+               std::to_string(connections) + " connections, " + pace.str());
+
+  // Open and authenticate every connection before the clock starts.
+  KvEventLoop loop;
+  loop.start();
+  std::vector<std::unique_ptr<KvAsyncClient>> clients;
+  for (size_t i = 0; i < connections; ++i) {
+    clients.push_back(std::make_unique<KvAsyncClient>(loop, info));
+    if (!clients.back()->connect().get()) {
+      Logger::error("Could not open " + std::to_string(connections) + " replay connections");
+      clients.clear();
+      loop.stop();
+      return 1;
+    }
+  }
+
+  ReplayResult result;
+  ReplayFlow flow;
+  // Without a schedule, only the window keeps the outboxes from holding the whole capture
+  uint64_t window = static_cast<uint64_t>(options.pipeWindow) * connections;
+  std::chrono::steady_clock::duration lag{};
+  auto start = std::chrono::steady_clock::now();
+
+  for (const ReplayRequest& request : requests) {
+    if (speed > 0) {
+      auto due = start + std::chrono::nanoseconds(static_cast<uint64_t>(static_cast<double>(request.at) / speed));
+      std::this_thread::sleep_until(due);
+      lag = std::max(lag, std::chrono::steady_clock::now() - due);
+    }
+    {
+      std::unique_lock<std::mutex> lock(flow.mutex);
+      if (speed <= 0) flow.changed.wait(lock, [&] { return flow.inFlight < window; });
+      ++flow.inFlight;
+    }
+
+    // Every command of a recorded connection goes out on the same replay
+    // connection, which keeps their order.
+    auto sent = std::chrono::steady_clock::now();
+    clients[request.stream % connections]->send(std::string(request.command), [&, sent, request](bool ok, std::string_view reply) {
+      if (!ok) {
+        ++result.failed;
+      } else {
+        auto elapsed = std::chrono::steady_clock::now() - sent;
+        KvMetrics::global().reply(resp::command_name(request.command), elapsed, reply);
+        result.latency.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        ++result.replies;
+        if (!reply.empty() && reply[0] == '-') ++result.errors;
+        if (request.expected.empty()) {
+          ++result.unchecked;
+        } else if (reply != request.expected) {
+          ++result.mismatches;
+          if (result.samples.size() < MAX_MISMATCH_SAMPLES) result.samples.push_back(describe_mismatch(request.command, request.expected, reply));
+        }
+      }
+      std::lock_guard<std::mutex> lock(flow.mutex);
+      --flow.inFlight;
+      flow.changed.notify_all();
+    });
+  }
+  {
+    std::unique_lock<std::mutex> lock(flow.mutex);
+    flow.changed.wait(lock, [&] { return flow.inFlight == 0; });
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  clients.clear();
+  loop.stop();
+
+  const KvHistogram& latency = result.latency;
+  Logger::flush();
+  std::cout << std::right << std::setw(10) << "replies" << std::setw(8) << "errors" << std::setw(8) << "differ" << std::setw(8) << "failed"
+            << std::setw(12) << "req/s" << std::setw(10) << "avg ms" << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99"
+            << std::setw(10) << "p99.9" << std::setw(10) << "max" << '\n';
+  std::cout << std::setw(10) << result.replies << std::setw(8) << result.errors << std::setw(8) << result.mismatches << std::setw(8) << result.failed
+            << std::setw(12) << std::fixed << std::setprecision(0) << static_cast<double>(result.replies) / seconds << std::setw(10)
+            << format_ms(static_cast<uint64_t>(latency.mean())) << std::setw(10) << format_ms(latency.percentile(50)) << std::setw(10)
+            << format_ms(latency.percentile(90)) << std::setw(10) << format_ms(latency.percentile(99)) << std::setw(10) << format_ms(latency.percentile(99.9))
+            << std::setw(10) << format_ms(latency.max()) << '\n';
+  std::cout.flush();
+
+  for (const std::string& sample : result.samples) Logger::warn("Reply differs for " + sample);
+  if (result.unchecked > 0) Logger::info(std::to_string(result.unchecked) + " commands had no recorded reply to compare");
+  if (speed > 0 && lag > std::chrono::milliseconds(1)) {
+    uint64_t lag_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(lag).count());
+    Logger::info("Fell behind the recorded timing by up to " + format_ms(lag_ns) + " ms");
+  }
+
+  if (result.failed > 0) {
+    Logger::error("Replay incomplete: " + std::to_string(result.failed) + " commands were lost to failed connections");
+    return 1;
+  }
+  return result.mismatches > 0 ? 1 : 0;
+}
+
+}  // namespace mode
@@ -0,0 +1,163 @@
+/**
+ * @file sharded.cpp
+ * @brief Implements mode::sharded, the REPL and pipe mode over several servers.
+ */
+
+#include <chrono>
+#include <fstream>
+
+#include "include/logger.hpp"
+#include "include/metrics.hpp"
+#include "include/modes.hpp"
+#include "include/render.hpp"
+#include "include/resp.hpp"
+#include "include/sharded_client.hpp"
+
+namespace mode {
+
+namespace {
+
+/** @brief True for input lines that end the session. */
+bool is_exit(std::string line) {
+  std::string cmd = cmd::command_to_lowercase(line);
+  return cmd == "exit" || cmd == "quit";
+}
+
+/** @brief Interactive loop; each command is its own batch. */
+int repl(KvShardedClient& client, resp::Format format) {
+  std::string prompt = "shards(" + std::to_string(client.size()) + ")> ";
+  std::string input;
+  std::vector<KvShardedClient::Command> batch(1);
+  std::vector<std::string> replies;
+  resp::OutputSink sink;
+  resp::Renderer renderer(sink, format);
+
+  while (true) {
+    Logger::flush();
+    std::cout << prompt;
+    if (!std::getline(std::cin, input) || is_exit(input)) break;
+
+    resp::split_words(input, batch[0]);
+    if (batch[0].empty()) continue;
+    if (batch[0].size() == 1 && batch[0][0] == ":stats") {
+      std::cout << KvMetrics::table(KvMetrics::global().snapshot()) << std::flush;
+      continue;
+    }
+
+    client.execute(batch, replies);
+    renderer.render(replies[0]);
+    sink.flush();
+  }
+
+  Logger::warn("Disconnecting from server...");
+  return 0;
+}
+
+/** @brief Batch loop for piped input, with the pipe mode summary. */
+int run_batches(KvShardedClient& client, std::istream& in, size_t window, resp::Format format) {
+  std::vector<std::string> lines(window);
+  std::vector<KvShardedClient::Command> batch;
+  std::vector<std::string> replies;
+  uint64_t ok = 0;
+  uint64_t errors = 0;
+  bool healthy = true;
+  bool done = false;
+  resp::OutputSink sink;
+  resp::Renderer renderer(sink, format);
+  auto start = std::chrono::steady_clock::now();
+
+  while (!done) {
+    size_t count = 0;
+    while (count < window && std::getline(in, lines[count])) {
+      if (is_exit(lines[count])) {
+        done = true;
+        break;
+      }
+      if (lines[count].find_first_not_of(" \t\r\f\v") != std::string::npos) ++count;
+    }
+    if (count < window) done = true;
+    if (count == 0) break;
+
+    batch.resize(count);
+    for (size_t i = 0; i < count; ++i) resp::split_words(lines[i], batch[i]);
+    healthy = client.execute(batch, replies) && healthy;
+
+    for (const std::string& reply : replies) {
+      if (!reply.empty() && (reply[0] == '-' || reply[0] == '!')) {
+        ++errors;
+      } else {
+        ++ok;
+      }
+      renderer.render(reply);
+    }
+  }
+  sink.flush();
+
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  double rate = seconds > 0 ? static_cast<double>(ok + errors) / seconds : 0.0;
+
+  std::ostringstream summary;
+  summary.setf(std::ios::fixed);
+  summary.precision(3);
+  summary << "sent: " << ok + errors << " to " << client.size() << " shards, ok: " << ok << ", errors: " << errors << " in " << seconds << "s";
+  summary.precision(0);
+  summary << " (" << rate << " cmd/s)";
+
+  if (!healthy || errors > 0) {
+    Logger::warn(summary.str());
+    return 1;
+  }
+  Logger::success(summary.str());
+  return 0;
+}
+
+}  // namespace
+
+/**
+ * @brief Run the REPL or pipe mode against every shard.
+ *
+ * @param options Parsed run mode options.
+ * @return Exit code (0 = every command succeeded).
+ */
+int sharded(const KvCliOptions& options) {
+  KvShardedClient client(options.shards);
+  KvReconnectPolicy policy;
+  policy.maxAttempts = options.reconnectAttempts;
+  client.setReconnectPolicy(policy);
+
+  for (size_t n = 0; n < client.size(); ++n) Logger::info("Shard " + std::to_string(n + 1) + ": " + client.node(n).url);
+  if (!client.connect()) {
+    client.disconnect();
+    return 1;
+  }
+
+  int status = 0;
+  if (!options.command.empty()) {
+    // One-shot: the command goes to the node that owns its key
+    std::vector<KvShardedClient::Command> batch(1);
+    std::vector<std::string> replies;
+    batch[0].assign(options.command.begin(), options.command.end());
+    client.execute(batch, replies);
+    resp::OutputSink sink;
+    resp::Renderer(sink, options.outputFormat).render(replies[0]);
+    sink.flush();
+    status = reply_status(replies[0]);
+  } else if (!options.pipe) {
+    status = repl(client, options.outputFormat);
+  } else if (options.inputFile.empty()) {
+    status = run_batches(client, std::cin, options.pipeWindow, options.outputFormat);
+  } else {
+    std::ifstream file(options.inputFile);
+    if (!file) {
+      Logger::error("Cannot open input file: " + options.inputFile);
+      status = 1;
+    } else {
+      status = run_batches(client, file, options.pipeWindow, options.outputFormat);
+    }
+  }
+
+  client.disconnect();
+  return status;
+}
+
+}  // namespace mode
@@ -3,31 +3,131 @@
  * @brief Implementation of CLI argument parsing.
  */
 
+#include "include/argument.hpp"
 #include "include/client.hpp"
 #include "include/logger.hpp"
+#include "include/spill_buffer.hpp"
+#include "include/startup_trace.hpp"
 #include "include/utils.hpp"
 
 namespace arg {
 
+/**
+ * @brief Reads the positive integer following a flag and skips it.
+ *
+ * Exits if the value is missing or not a positive number.
+ *
+ * @param argc Arg count.
+ * @param argv Arg values.
+ * @param arg  Index of the flag; advanced past the value.
+ * @return Parsed value.
+ */
+static uint64_t positive_value(int argc, char* argv[], int& arg) {
+  if (arg + 1 < argc) {
+    char* end = nullptr;
+    long long value = std::strtoll(argv[arg + 1], &end, 10);
+    if (*end == '\0' && value > 0) {
+      ++arg;  // Skip the next argument
+      return static_cast<uint64_t>(value);
+    }
+  }
+  Logger::error("Error: Positive number not provided after " + std::string(argv[arg]));
+  exit(1);
+}
+
+/**
+ * @brief Reads the byte size following a flag and skips it.
+ *
+ * Accepts a K, M or G suffix (powers of 1024). Exits if the value is
+ * missing or not a positive size.
+ *
+ * @param argc Arg count.
+ * @param argv Arg values.
+ * @param arg  Index of the flag; advanced past the value.
+ * @return Parsed size in bytes.
+ */
+static uint64_t size_value(int argc, char* argv[], int& arg) {
+  if (arg + 1 < argc) {
+    char* end = nullptr;
+    long long value = std::strtoll(argv[arg + 1], &end, 10);
+    int shift = 0;
+    switch (*end) {
+      case 'k':
+      case 'K':
+        shift = 10;
+        break;
+      case 'm':
+      case 'M':
+        shift = 20;
+        break;
+      case 'g':
+      case 'G':
+        shift = 30;
+        break;
+    }
+    if (shift > 0) ++end;
+    if (*end == '\0' && value > 0 && value < (1LL << (62 - shift))) {
+      ++arg;  // Skip the next argument
+      return static_cast<uint64_t>(value) << shift;
+    }
+  }
+  Logger::error("Error: Size in bytes (optionally with K, M or G) not provided after " + std::string(argv[arg]));
+  exit(1);
+}
+
+/**
+ * @brief Reads the string following a flag and skips it.
+ *
+ * Exits if the value is missing.
+ *
+ * @param argc Arg count.
+ * @param argv Arg values.
+ * @param arg  Index of the flag; advanced past the value.
+ * @return The value.
+ */
+static std::string string_value(int argc, char* argv[], int& arg) {
+  if (arg + 1 < argc) {
+    ++arg;  // Skip the next argument
+    return argv[arg];
+  }
+  Logger::error("Error: Value not provided after " + std::string(argv[arg]));
+  exit(1);
+}
+
 /**
  * @brief Parses and validates CLI arguments into connection info.
  *
  * - Sets defaults: localhost:6379, no auth.
  * - On <2 args, prints usage and exits.
- * - Handles flags: -p, -h, -U, -P, -url.
+ * - Handles flags: -p, -h, -s, -U, -P, -url (repeatable, or a comma list).
+ * - Handles output formats: --raw, --csv and --json.
+ * - Handles --connect-timeout, --reconnect-attempts and --no-reconnect.
+ * - Handles --cache, --cache-size, --cache-ttl and --cache-eviction.
+ * - Handles mode flags: --pipe, -f, --pipe-window, --import, --import-format,
+ *   --export, --export-connections,
+ *   --latency, --latency-history, --latency-dist, --interval, --bench and its
+ *   tuning flags.
+ * - Handles --capture, --metrics-file, --metrics-interval, --metrics-json,
+ *   --replay, --replay-speed, --replay-connections, --log-level,
+ *   --startup-trace, --max-reply-bytes and --out.
+ * - Takes the first non-flag argument and the rest as a one-shot command,
+ *   which only logs errors unless --log-level came first.
  * - Constructs info.url if not provided.
+ * - Switches to pipe mode when stdin is not a TTY.
  *
- * @param argc Arg count.
- * @param argv Arg values.
- * @param info  KvConnectionInfo to configure.
+ * @param argc    Arg count.
+ * @param argv    Arg values.
+ * @param info    KvConnectionInfo to configure.
+ * @param options KvCliOptions to configure.
  */
-void parse(int argc, char* argv[], KvConnectionInfo& info) {
+void parse(int argc, char* argv[], KvConnectionInfo& info, KvCliOptions& options) {
   // Set default values
   info.host = "127.0.0.1";
   info.port = 6379;
   info.user = "";
   info.password = "";
   info.url = "";
+  bool level_given = false;
 
   // ---------------------------------------------------
   // @INFO If the user does not provide any arguments,
@@ -61,6 +161,14 @@ void parse(int argc, char* argv[], KvConnectionInfo& info) {
         Logger::error("Error: Host name not provided after -h");
         exit(1);
       }
+    } else if (strcmp(argv[arg], "-s") == 0) {
+      if (arg + 1 < argc) {
+        info.socketPath = argv[arg + 1];
+        ++arg;  // Skip the next argument
+      } else {
+        Logger::error("Error: Socket path not provided after -s");
+        exit(1);
+      }
     } else if (strcmp(argv[arg], "-U") == 0) {
       if (arg + 1 < argc) {
         info.user = argv[arg + 1];
@@ -79,20 +187,166 @@ void parse(int argc, char* argv[], KvConnectionInfo& info) {
       }
     } else if (strcmp(argv[arg], "-url") == 0) {
       if (arg + 1 < argc) {
-        if (!network::parse_connection_uri(argv[arg + 1], info)) {
-          Logger::error("Error: Invalid connection URI format");
-          Logger::error("Format: kv://<user>:<password>@<host>:<port>");
-          Logger::error("Example: kv://user:password@127.0.0.1:6379");
-          exit(1);
+        // @INFO -url may repeat or hold a comma-separated list; each is a shard
+        for (const std::string& uri : cmd::split(argv[arg + 1], ',')) {
+          KvConnectionInfo node;
+          if (uri.empty()) continue;
+          if (!network::parse_connection_uri(uri, node)) {
+            Logger::error("Error: Invalid connection URI format: " + uri);
+            Logger::error("Format: kv://<user>:<password>@<host>:<port> or unix://<user>:<password>@/<path>");
+            Logger::error("Example: kv://user:password@127.0.0.1:6379");
+            exit(1);
+          }
+          node.url = uri;
+          options.shards.push_back(node);
+          if (options.shards.size() == 1) network::parse_connection_uri(uri, info);
         }
         ++arg;  // Skip the next argument
       } else {
         Logger::error("Error: Connection URI not provided after -url");
         exit(1);
       }
+    } else if (strcmp(argv[arg], "--pipe") == 0) {
+      options.pipe = true;
+    } else if (strcmp(argv[arg], "-f") == 0) {
+      if (arg + 1 < argc) {
+        options.inputFile = argv[arg + 1];
+        options.pipe = true;
+        ++arg;  // Skip the next argument
+      } else {
+        Logger::error("Error: Input file not provided after -f");
+        exit(1);
+      }
+    } else if (strcmp(argv[arg], "--pipe-window") == 0) {
+      options.pipeWindow = positive_value(argc, argv, arg);
+    } else if (strcmp(argv[arg], "--raw") == 0 || strcmp(argv[arg], "--csv") == 0 || strcmp(argv[arg], "--json") == 0) {
+      resp::parse_format(argv[arg] + 2, options.outputFormat);
+      // Keep stdout clean for whatever consumes the replies
+      Logger::setOutput(STDERR_FILENO);
+    } else if (strcmp(argv[arg], "--connect-timeout") == 0) {
+      info.connectTimeout = std::chrono::milliseconds(positive_value(argc, argv, arg));
+    } else if (strcmp(argv[arg], "--reconnect-attempts") == 0) {
+      options.reconnectAttempts = positive_value(argc, argv, arg);
+    } else if (strcmp(argv[arg], "--no-reconnect") == 0) {
+      options.reconnectAttempts = 0;
+    } else if (strcmp(argv[arg], "--cache") == 0) {
+      options.cache = true;
+    } else if (strcmp(argv[arg], "--cache-size") == 0) {
+      options.cache = true;
+      options.cacheSize = positive_value(argc, argv, arg);
+    } else if (strcmp(argv[arg], "--cache-ttl") == 0) {
+      options.cache = true;
+      options.cacheTtl = positive_value(argc, argv, arg);
+    } else if (strcmp(argv[arg], "--cache-eviction") == 0) {
+      options.cache = true;
+      options.cacheEviction = string_value(argc, argv, arg);
+      if (options.cacheEviction != "lru" && options.cacheEviction != "clock") {
+        Logger::error("Error: --cache-eviction must be lru or clock");
+        exit(1);
+      }
+    } else if (strcmp(argv[arg], "--import") == 0) {
+      options.importFile = string_value(argc, argv, arg);
+    } else if (strcmp(argv[arg], "--import-format") == 0) {
+      options.importFormat = string_value(argc, argv, arg);
+    } else if (strcmp(argv[arg], "--export") == 0) {
+      options.exportFile = string_value(argc, argv, arg);
+    } else if (strcmp(argv[arg], "--export-connections") == 0) {
+      options.exportConnections = positive_value(argc, argv, arg);
+    } else if (strcmp(argv[arg], "--latency") == 0) {
+      options.latency = true;
+    } else if (strcmp(argv[arg], "--latency-history") == 0) {
+      options.latency = true;
+      options.latencyHistory = true;
+    } else if (strcmp(argv[arg], "--latency-dist") == 0) {
+      options.latency = true;
+      options.latencyDist = true;
+    } else if (strcmp(argv[arg], "--interval") == 0) {
+      options.latencyInterval = positive_value(argc, argv, arg);
+    } else if (strcmp(argv[arg], "--bench") == 0) {
+      options.bench = true;
+    } else if (strcmp(argv[arg], "--clients") == 0) {
+      options.benchClients = positive_value(argc, argv, arg);
+    } else if (strcmp(argv[arg], "--threads") == 0) {
+      options.benchThreads = positive_value(argc, argv, arg);
+    } else if (strcmp(argv[arg], "--requests") == 0) {
+      options.benchRequests = positive_value(argc, argv, arg);
+    } else if (strcmp(argv[arg], "--pipeline") == 0) {
+      options.benchPipeline = positive_value(argc, argv, arg);
+    } else if (strcmp(argv[arg], "--mix") == 0) {
+      options.benchMix = string_value(argc, argv, arg);
+    } else if (strcmp(argv[arg], "--keyspace") == 0) {
+      options.benchKeyspace = positive_value(argc, argv, arg);
+    } else if (strcmp(argv[arg], "--value-size") == 0) {
+      options.benchValueSize = positive_value(argc, argv, arg);
+    } else if (strcmp(argv[arg], "--value-type") == 0) {
+      options.benchValueType = string_value(argc, argv, arg);
+    } else if (strcmp(argv[arg], "--capture") == 0) {
+      options.captureFile = string_value(argc, argv, arg);
+    } else if (strcmp(argv[arg], "--metrics-file") == 0) {
+      options.metricsFile = string_value(argc, argv, arg);
+    } else if (strcmp(argv[arg], "--metrics-interval") == 0) {
+      options.metricsInterval = positive_value(argc, argv, arg);
+    } else if (strcmp(argv[arg], "--metrics-json") == 0) {
+      options.metricsJson = string_value(argc, argv, arg);
+    } else if (strcmp(argv[arg], "--replay") == 0) {
+      options.replayFile = string_value(argc, argv, arg);
+    } else if (strcmp(argv[arg], "--replay-speed") == 0) {
+      std::string speed = string_value(argc, argv, arg);
+      char* end = nullptr;
+      options.replaySpeed = speed == "max" ? 0 : std::strtod(speed.c_str(), &end);
+      if (speed != "max" && *end == 'x' && end != speed.c_str()) ++end;  // "10x" reads as 10
+      if (speed != "max" && (*end != '\0' || !(options.replaySpeed > 0))) {
+        Logger::error("Error: --replay-speed must be a positive factor (e.g. 2 or 2x) or max");
+        exit(1);
+      }
+    } else if (strcmp(argv[arg], "--replay-connections") == 0) {
+      options.replayConnections = positive_value(argc, argv, arg);
+    } else if (strcmp(argv[arg], "--log-level") == 0) {
+      Logger::Level level;
+      if (!Logger::parseLevel(string_value(argc, argv, arg), level)) {
+        Logger::error("Error: --log-level must be debug, info, warn, error or off");
+        exit(1);
+      }
+      Logger::setLevel(level);
+      level_given = true;
+    } else if (strcmp(argv[arg], "--startup-trace") == 0) {
+      StartupTrace::enabled() = true;
+    } else if (strcmp(argv[arg], "--max-reply-bytes") == 0) {
+      KvSpillBuffer::setLimit(size_value(argc, argv, arg));
+    } else if (strcmp(argv[arg], "--out") == 0) {
+      options.outFile = string_value(argc, argv, arg);
+    } else if (argv[arg][0] != '-') {
+      // @INFO `cli [flags] SET k v`: the rest of the line is the command
+      options.command.assign(argv + arg, argv + argc);
+      // Keep stdout for the reply alone, and stderr for errors alone
+      Logger::setOutput(STDERR_FILENO);
+      if (!level_given) Logger::setLevel(Logger::Level::ERROR);
+      break;
     }
   }
 
+  if (!options.outFile.empty() && options.command.empty()) {
+    Logger::error("Error: --out needs a one-shot command, e.g. --out blob.bin GET key");
+    exit(1);
+  }
+
+  // ---------------------------------------------------
+  // @INFO One URL is a plain connection; several make a sharded client
+  // ---------------------------------------------------
+  if (options.shards.size() < 2) {
+    options.shards.clear();
+  }
+  for (KvConnectionInfo& node : options.shards) {
+    node.connectTimeout = info.connectTimeout;
+  }
+
+  // ---------------------------------------------------
+  // @INFO Commands are being piped in, skip the interactive prompt
+  // ---------------------------------------------------
+  if (!isatty(STDIN_FILENO) && options.command.empty() && !options.bench && !options.latency && options.importFile.empty() && options.exportFile.empty() && options.replayFile.empty()) {
+    options.pipe = true;
+  }
+
   // ---------------------------------------------------
   // @INFO Set the URL string for display purposes if it wasn't set via -url
   // ---------------------------------------------------
@@ -112,7 +366,7 @@ void parse(int argc, char* argv[], KvConnectionInfo& info) {
       info.host = "127.0.0.1";
     }
 
-    info.url = "kv://" + credentials + info.host + ":" + std::to_string(info.port);
+    info.url = (info.socketPath.empty() ? "kv://" : "unix://") + credentials + info.endpoint();
   }
 }
 
@@ -0,0 +1,286 @@
+/**
+ * @file capture.cpp
+ * @brief KvCapture implementation.
+ */
+
+#include "include/capture.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "include/logger.hpp"
+
+namespace capture {
+
+/**
+ * @brief Monotonic clock in nanoseconds.
+ *
+ * @return CLOCK_MONOTONIC reading; comparable across the connections of one capture.
+ */
+uint64_t now_ns() {
+  timespec ts{};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+}  // namespace capture
+
+namespace {
+
+/** @brief Address space mapped over the file; a capture cannot grow past it. */
+constexpr size_t RESERVATION = size_t(64) << 30;
+
+/** @brief How far the file is grown at a time. */
+constexpr uint64_t GROW_STEP = uint64_t(64) << 20;
+
+/** @brief Record size with the payload padded to 8 bytes. */
+size_t record_size(size_t payload) {
+  return capture::RECORD_HEADER_SIZE + ((payload + 7) & ~size_t(7));
+}
+
+/** @brief Fill in a record header. */
+void write_header(char* at, uint32_t length, uint32_t connection, uint64_t stamp, capture::Direction direction) {
+  std::memcpy(at, &length, 4);
+  std::memcpy(at + 4, &connection, 4);
+  std::memcpy(at + 8, &stamp, 8);
+  at[16] = static_cast<char>(direction);  // the rest of the header is still zero
+}
+
+}  // namespace
+
+std::atomic<KvCapture*> KvCapture::active(nullptr);
+
+// Constructor
+KvCapture::KvCapture() : fd(-1), base(nullptr), reserved(0), tail(0), allocated(0), full(false), records(0), dropped(0) {}
+
+// Destructor
+KvCapture::~KvCapture() {
+  close();
+}
+
+/**
+ * @brief Create (or truncate) the capture file and write its header.
+ *
+ * @param file  File to write.
+ * @param error Set when false is returned.
+ * @return True if the capture is ready.
+ */
+bool KvCapture::open(const std::string& file, std::string& error) {
+  close();
+
+  path = file;
+  fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    error = "Cannot create capture file " + path + ": " + std::strerror(errno);
+    return false;
+  }
+
+  // Pages past the end of the file are never touched: reserve() grows it first.
+  void* mapping = mmap(nullptr, RESERVATION, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_NORESERVE, fd, 0);
+  if (mapping == MAP_FAILED) {
+    error = "Cannot map capture file " + path + ": " + std::strerror(errno);
+    ::close(fd);
+    fd = -1;
+    return false;
+  }
+  base = static_cast<char*>(mapping);
+  reserved = RESERVATION;
+  tail = 0;
+  allocated = 0;
+  full = false;
+  records = 0;
+  dropped = 0;
+
+  char* header = reserve(capture::HEADER_SIZE);
+  if (header == nullptr) {
+    error = "Cannot grow capture file " + path;
+    close();
+    return false;
+  }
+  uint64_t monotonic = capture::now_ns();
+  timespec real{};
+  clock_gettime(CLOCK_REALTIME, &real);
+  uint64_t realtime = static_cast<uint64_t>(real.tv_sec) * 1000000000ull + static_cast<uint64_t>(real.tv_nsec);
+  std::memcpy(header, capture::MAGIC.data(), capture::MAGIC.size());
+  std::memcpy(header + 8, &monotonic, 8);
+  std::memcpy(header + 16, &realtime, 8);
+  return true;
+}
+
+/**
+ * @brief Uninstall, unmap and trim the file to the bytes written.
+ *
+ * Call once no client is sending or receiving any more. Logs a summary.
+ */
+void KvCapture::close() {
+  if (current() == this) install(nullptr);
+  if (fd < 0) return;
+
+  uint64_t used = std::min<uint64_t>(tail.load(), allocated.load());
+  munmap(base, reserved);
+  if (ftruncate(fd, static_cast<off_t>(used)) != 0) Logger::warn("Cannot trim capture file: " + std::string(std::strerror(errno)));
+  ::close(fd);
+  fd = -1;
+  base = nullptr;
+  reserved = 0;
+
+  Logger::info("Captured " + std::to_string(records.load()) + " records (" + std::to_string(used) + " bytes) to " + path);
+  if (dropped.load() > 0) Logger::warn("Capture full: " + std::to_string(dropped.load()) + " records dropped");
+}
+
+/**
+ * @brief Claim `bytes` at the end of the log.
+ *
+ * @return Where to write them, or null if the capture is full.
+ */
+char* KvCapture::reserve(size_t bytes) {
+  if (full.load(std::memory_order_relaxed)) return nullptr;
+
+  uint64_t offset = tail.fetch_add(bytes, std::memory_order_relaxed);
+  uint64_t end = offset + bytes;
+  if (end > reserved) {
+    full.store(true, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  if (end > allocated.load(std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> lock(growLock);
+    uint64_t size = allocated.load(std::memory_order_relaxed);
+    while (size < end) {
+      uint64_t grown = std::min<uint64_t>(size + GROW_STEP, reserved);
+      // fallocate reserves the blocks now; a sparse file would fault with
+      // SIGBUS on a full disk instead of failing here
+      int status = posix_fallocate(fd, static_cast<off_t>(size), static_cast<off_t>(grown - size));
+      if (status == EOPNOTSUPP || status == EINVAL) status = ftruncate(fd, static_cast<off_t>(grown)) == 0 ? 0 : errno;
+      if (status != 0) {
+        Logger::error("Cannot grow capture file: " + std::string(std::strerror(status)));
+        full.store(true, std::memory_order_relaxed);
+        return nullptr;
+      }
+      size = grown;
+      allocated.store(size, std::memory_order_release);
+    }
+  }
+  return base + offset;
+}
+
+/**
+ * @brief Append one record.
+ *
+ * @param connection Client the bytes belong to.
+ * @param direction  Sent or received.
+ * @param payload    The bytes; empty payloads are not recorded.
+ */
+void KvCapture::record(uint32_t connection, capture::Direction direction, std::string_view payload) {
+  uint64_t stamp = capture::now_ns();
+  if (payload.empty() || payload.size() > UINT32_MAX) return;
+
+  char* at = reserve(record_size(payload.size()));
+  if (at == nullptr) {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  std::memcpy(at + capture::RECORD_HEADER_SIZE, payload.data(), payload.size());
+  write_header(at, static_cast<uint32_t>(payload.size()), connection, stamp, direction);
+  records.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Append one record gathered from several pieces, as writev sends them.
+ *
+ * @param connection Client the bytes belong to.
+ * @param direction  Sent or received.
+ * @param iov        Pieces of the payload, in order.
+ * @param count      Number of pieces.
+ */
+void KvCapture::record(uint32_t connection, capture::Direction direction, const struct iovec* iov, size_t count) {
+  uint64_t stamp = capture::now_ns();
+  size_t length = 0;
+  for (size_t i = 0; i < count; ++i) length += iov[i].iov_len;
+  if (length == 0 || length > UINT32_MAX) return;
+
+  char* at = reserve(record_size(length));
+  if (at == nullptr) {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  char* payload = at + capture::RECORD_HEADER_SIZE;
+  for (size_t i = 0; i < count; ++i) {
+    std::memcpy(payload, iov[i].iov_base, iov[i].iov_len);
+    payload += iov[i].iov_len;
+  }
+  write_header(at, static_cast<uint32_t>(length), connection, stamp, direction);
+  records.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Make `capture` the process-wide capture (null to stop recording).
+ */
+void KvCapture::install(KvCapture* capture) {
+  active.store(capture, std::memory_order_release);
+}
+
+// --------------------------------------------------
+// @INFO KvCaptureReader
+// --------------------------------------------------
+
+// Constructor
+KvCaptureReader::KvCaptureReader() : offset(0), monotonic(0), realtime(0), truncated(false) {}
+
+/**
+ * @brief Map a capture file and check its header.
+ *
+ * @param path  File to read.
+ * @param error Set when false is returned.
+ * @return True if records can be read.
+ */
+bool KvCaptureReader::open(const std::string& path, std::string& error) {
+  if (!file.open(path)) {
+    error = "Cannot read capture file " + path;
+    return false;
+  }
+  std::string_view data = file.view();
+  if (data.size() < capture::HEADER_SIZE || data.substr(0, capture::MAGIC.size()) != capture::MAGIC) {
+    error = path + " is not a capture file";
+    file.close();
+    return false;
+  }
+  std::memcpy(&monotonic, data.data() + 8, 8);
+  std::memcpy(&realtime, data.data() + 16, 8);
+  offset = capture::HEADER_SIZE;
+  truncated = false;
+  return true;
+}
+
+/**
+ * @brief Read the next record.
+ *
+ * @param record Filled in when true is returned.
+ * @return False at the end of the log.
+ */
+bool KvCaptureReader::next(Record& record) {
+  std::string_view data = file.view();
+  if (offset + capture::RECORD_HEADER_SIZE > data.size()) return false;
+
+  const char* at = data.data() + offset;
+  uint32_t length;
+  std::memcpy(&length, at, 4);
+  if (length == 0) return false;
+  if (record_size(length) > data.size() - offset) {
+    truncated = true;
+    return false;
+  }
+
+  std::memcpy(&record.connection, at + 4, 4);
+  std::memcpy(&record.stamp, at + 8, 8);
+  record.direction = static_cast<capture::Direction>(at[16]);
+  record.payload = std::string_view(at + capture::RECORD_HEADER_SIZE, length);
+  offset += record_size(length);
+  return true;
+}
@@ -1,19 +1,58 @@
 /**
  * @file command.cpp
- * @brief Implements cmd::command_to_lowercase and cmd::split.
+ * @brief Implements cmd::command_to_lowercase, cmd::split, cmd::is_idempotent,
+ *        cmd::is_idempotent_request and cmd::split_redirect.
  */
 
 #include "include/utils.hpp"
 
+#include <algorithm>
+#include <cctype>
+
+#include "include/resp.hpp"
+#include "include/resp_reader.hpp"
+
 namespace cmd {
 
 /**
- * @brief Convert and trim input to lowercase using ICU.
+ * @brief Whitespace that ICU's UnicodeString::trim() removes, restricted to ASCII.
+ */
+static bool is_ascii_space(unsigned char c) {
+  return c == ' ' || (c >= '\t' && c <= '\r') || (c >= 0x1c && c <= 0x1f);
+}
+
+/**
+ * @brief Convert and trim input to lowercase.
+ *
+ * Plain ASCII input, which is nearly every command, is handled with a
+ * byte loop; ICU is only used when the input has non-ASCII bytes, so a
+ * run that never sees one never initializes ICU's converters.
  *
  * @param input UTF-8 string to normalize.
  * @return Lowercase, trimmed version (or empty if input empty).
  */
 std::string command_to_lowercase(std::string& input) {
+  bool ascii = true;
+  for (char c : input) {
+    if (static_cast<unsigned char>(c) >= 0x80) {
+      ascii = false;
+      break;
+    }
+  }
+
+  if (ascii) {
+    size_t first = 0;
+    size_t last = input.size();
+    while (first < last && is_ascii_space(static_cast<unsigned char>(input[first]))) ++first;
+    while (last > first && is_ascii_space(static_cast<unsigned char>(input[last - 1]))) --last;
+
+    std::string cmd(input, first, last - first);
+    for (char& c : cmd) {
+      if (c >= 'A' && c <= 'Z') c = static_cast<char>(c + ('a' - 'A'));
+    }
+    return cmd;
+  }
+
   const icu::UnicodeString uni_command(input.c_str(), "UTF-8");
   if (uni_command.isEmpty()) return "";
 
@@ -46,4 +85,99 @@ std::vector<std::string> split(const std::string& s, char separator) {
   return output;
 }
 
+/**
+ * @brief Commands that are safe to replay, upper case and sorted.
+ *
+ * Safe means running a command twice leaves the same final state as
+ * running it once; the reply may still differ (a replayed DEL, HSET or
+ * SADD reports 0). Relative TTLs such as EXPIRE, PEXPIRE and SETEX are
+ * left out, since a late replay pushes the deadline back; for the same
+ * reason is_idempotent_request() refuses SET with EX or PX (or GET, whose
+ * reply is the value being replaced). Anything not listed is treated as
+ * non-idempotent.
+ */
+static const char* const IDEMPOTENT_COMMANDS[] = {
+    "AUTH", "DBSIZE", "DEL", "ECHO", "EXISTS", "EXPIREAT", "GET", "GETRANGE", "HDEL", "HEXISTS", "HGET", "HGETALL", "HKEYS", "HLEN", "HMGET", "HMSET",
+    "HSET", "HVALS", "INFO", "KEYS", "LINDEX", "LLEN", "LRANGE", "MGET", "MSET", "PERSIST", "PING", "PTTL", "SADD", "SCAN", "SCARD", "SELECT", "SET",
+    "SISMEMBER", "SMEMBERS", "SREM", "STRLEN", "TTL", "TYPE", "UNLINK", "ZCARD", "ZRANGE", "ZREM", "ZSCORE",
+};
+
+/**
+ * @brief Case-insensitive lookup in IDEMPOTENT_COMMANDS.
+ *
+ * @param name Command name.
+ * @return True if the command can be replayed.
+ */
+bool is_idempotent(std::string_view name) {
+  char upper[16];
+  if (name.empty() || name.size() >= sizeof(upper)) return false;
+  for (size_t i = 0; i < name.size(); ++i) {
+    upper[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(name[i])));
+  }
+  std::string_view key(upper, name.size());
+
+  return std::binary_search(std::begin(IDEMPOTENT_COMMANDS), std::end(IDEMPOTENT_COMMANDS), key,
+                            [](std::string_view a, std::string_view b) { return a < b; });
+}
+
+/**
+ * @brief Case-insensitive compare of a token with an upper-case word.
+ */
+static bool equals_upper(std::string_view token, std::string_view upper) {
+  if (token.size() != upper.size()) return false;
+  for (size_t i = 0; i < token.size(); ++i) {
+    if (std::toupper(static_cast<unsigned char>(token[i])) != upper[i]) return false;
+  }
+  return true;
+}
+
+/**
+ * @brief is_idempotent() plus a look at the options of SET.
+ *
+ * @param request Encoded request.
+ * @return True if the request can be replayed.
+ */
+bool is_idempotent_request(std::string_view request) {
+  std::string_view name = resp::command_name(request);
+  if (!is_idempotent(name)) return false;
+  if (!equals_upper(name, "SET")) return true;
+
+  std::vector<std::string_view> elements;
+  if (!resp::read_array(request, elements) || elements.size() < 3) return false;
+  for (size_t i = 3; i < elements.size(); ++i) {
+    std::string_view option;
+    if (!resp::read_bulk(elements[i], option)) return false;
+    std::string_view inner;
+    if (resp::read_bulk(option, inner)) option = inner;  // typed dialect wraps each token
+    if (equals_upper(option, "EX") || equals_upper(option, "PX") || equals_upper(option, "GET")) return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Split a trailing `> file` off `input`.
+ *
+ * @param input Command line; truncated before the `>` when found.
+ * @param path  Output file name when found.
+ * @return True if the line ended with a redirection.
+ */
+bool split_redirect(std::string& input, std::string& path) {
+  size_t end = input.size();
+  while (end > 0 && is_ascii_space(input[end - 1])) --end;
+  size_t start = end;
+  while (start > 0 && !is_ascii_space(input[start - 1])) --start;
+  if (start == end || start < 3) return false;
+
+  std::string_view word(input.data() + start, end - start);
+  if (word.find_first_of("\"'") != std::string_view::npos) return false;
+
+  size_t arrow = start;
+  while (arrow > 0 && is_ascii_space(input[arrow - 1])) --arrow;
+  if (arrow == start || arrow < 2 || input[arrow - 1] != '>' || !is_ascii_space(input[arrow - 2])) return false;
+
+  path.assign(word);
+  input.resize(arrow - 1);
+  return true;
+}
+
 }  // namespace cmd
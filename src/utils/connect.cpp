@@ -6,6 +6,8 @@
 #include "include/argument.hpp"
 #include "include/client.hpp"
 #include "include/logger.hpp"
+#include "include/resp.hpp"
+#include "include/startup_trace.hpp"
 #include "include/utils.hpp"
 
 namespace network {
@@ -15,21 +17,27 @@ namespace network {
  *
  * Exits on fatal errors (missing args or connection failure).
  *
- * @param argc CLI argument count.
- * @param argv CLI argument values.
+ * @param argc    CLI argument count.
+ * @param argv    CLI argument values.
+ * @param options Run mode options, filled from the same arguments.
  * @return Configured and connected KvClient.
  */
-KvClient connect_to_client(int argc, char* argv[]) {
+KvClient connect_to_client(int argc, char* argv[], KvCliOptions& options) {
   // --------------------------------------------------
   // @INFO Parse the command line arguments
   // --------------------------------------------------
   KvClient client;
   KvConnectionInfo connection_info;
 
-  arg::parse(argc, argv, connection_info);
+  arg::parse(argc, argv, connection_info, options);
+  StartupTrace::mark("parse arguments");
 
   client.setConnectionInfo(connection_info);
 
+  KvReconnectPolicy policy;
+  policy.maxAttempts = options.reconnectAttempts;
+  client.setReconnectPolicy(policy);
+
   Logger::info("Connecting to " + connection_info.url);
 
   if (connection_info.user.empty() && connection_info.password.empty()) {
@@ -54,7 +62,38 @@ KvClient connect_to_client(int argc, char* argv[]) {
     Logger::error("Failed to connect to the server.");
     exit(1);
   }
+  StartupTrace::mark("connect");
 
   return client;
 }
+
+/**
+ * @brief Connects and authenticates a client from parsed settings.
+ *
+ * Unlike connect_to_client this never exits; failures are logged and
+ * reported through the return value.
+ *
+ * @param client Unconnected client to configure.
+ * @param info   Connection settings.
+ * @return True if the client is ready for commands.
+ */
+bool open_connection(KvClient& client, const KvConnectionInfo& info) {
+  client.setConnectionInfo(info);
+  if (!client.connect(info.host, info.port)) return false;
+
+  if (info.user.empty() && info.password.empty()) {
+    client.setAuthenticated(false);
+    return true;
+  }
+
+  std::string response;
+  if (!client.authenticate(response)) {
+    Logger::error("Authentication failed for " + client.getAddr() + ": " + resp::decode(response));
+    client.disconnect();
+    return false;
+  }
+
+  client.setAuthenticated(true);
+  return true;
+}
 }  // namespace network
@@ -0,0 +1,223 @@
+/**
+ * @file dial.cpp
+ * @brief Implements network::resolve and network::dial.
+ */
+
+#include "include/dial.hpp"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+
+/** @copydoc KvAddress::text */
+std::string KvAddress::text() const {
+  if (family() == AF_UNIX) {
+    return reinterpret_cast<const sockaddr_un*>(&storage)->sun_path;
+  }
+
+  char host[INET6_ADDRSTRLEN] = "?";
+  int port = 0;
+  if (family() == AF_INET6) {
+    const auto* in6 = reinterpret_cast<const sockaddr_in6*>(&storage);
+    inet_ntop(AF_INET6, &in6->sin6_addr, host, sizeof(host));
+    port = ntohs(in6->sin6_port);
+    return "[" + std::string(host) + "]:" + std::to_string(port);
+  }
+  const auto* in4 = reinterpret_cast<const sockaddr_in*>(&storage);
+  inet_ntop(AF_INET, &in4->sin_addr, host, sizeof(host));
+  port = ntohs(in4->sin_port);
+  return std::string(host) + ":" + std::to_string(port);
+}
+
+namespace network {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/** @brief A connect that has been started and not yet resolved. */
+struct Attempt {
+  int fd;
+  size_t address;
+};
+
+/** @brief Start a non-blocking connect; returns the socket or -1 with errno set. */
+int start_connect(const KvAddress& address) {
+  int fd = socket(address.family(), SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0) return -1;
+
+  if (::connect(fd, reinterpret_cast<const sockaddr*>(&address.storage), address.length) < 0 && errno != EINPROGRESS) {
+    int saved = errno;
+    close(fd);
+    errno = saved;
+    return -1;
+  }
+  return fd;
+}
+
+/** @brief Milliseconds from now until `when`, for poll(); never negative. */
+int millis_until(Clock::time_point when) {
+  auto left = std::chrono::duration_cast<std::chrono::milliseconds>(when - Clock::now()).count();
+  return left > 0 ? static_cast<int>(left) + 1 : 0;  // round up so poll does not spin
+}
+
+}  // namespace
+
+/** @copydoc network::resolve */
+bool resolve(const std::string& host, int port, std::vector<KvAddress>& addresses, std::string& error) {
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_protocol = IPPROTO_TCP;
+  hints.ai_flags = AI_NUMERICSERV;
+
+  addrinfo* list = nullptr;
+  std::string service = std::to_string(port);
+  int status = getaddrinfo(host.c_str(), service.c_str(), &hints, &list);
+  if (status != 0) {
+    error = "Cannot resolve " + host + ": " + gai_strerror(status);
+    return false;
+  }
+
+  std::vector<KvAddress> preferred;
+  std::vector<KvAddress> other;
+  for (addrinfo* ai = list; ai != nullptr; ai = ai->ai_next) {
+    if (ai->ai_family != AF_INET && ai->ai_family != AF_INET6) continue;
+    KvAddress address{};
+    std::memcpy(&address.storage, ai->ai_addr, ai->ai_addrlen);
+    address.length = ai->ai_addrlen;
+    (ai->ai_family == list->ai_family ? preferred : other).push_back(address);
+  }
+  freeaddrinfo(list);
+
+  // Alternate families: preferred, other, preferred, ...
+  addresses.clear();
+  for (size_t i = 0; i < preferred.size() || i < other.size(); ++i) {
+    if (i < preferred.size()) addresses.push_back(preferred[i]);
+    if (i < other.size()) addresses.push_back(other[i]);
+  }
+
+  if (addresses.empty()) {
+    error = "No IPv4 or IPv6 address for " + host;
+    return false;
+  }
+  return true;
+}
+
+/** @copydoc network::unix_address */
+bool unix_address(const std::string& path, KvAddress& address, std::string& error) {
+  sockaddr_un un{};
+  if (path.empty() || path.size() >= sizeof(un.sun_path)) {
+    error = "Invalid socket path (1 to " + std::to_string(sizeof(un.sun_path) - 1) + " bytes): " + path;
+    return false;
+  }
+
+  un.sun_family = AF_UNIX;
+  std::memcpy(un.sun_path, path.c_str(), path.size() + 1);
+  address = KvAddress{};
+  std::memcpy(&address.storage, &un, sizeof(un));
+  address.length = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path.size() + 1);
+  return true;
+}
+
+/** @copydoc network::dial_unix */
+int dial_unix(const std::string& path, KvAddress& peer, std::string& error) {
+  if (!unix_address(path, peer, error)) return -1;
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0 || ::connect(fd, reinterpret_cast<const sockaddr*>(&peer.storage), peer.length) < 0) {
+    error = "Connection to " + path + " failed: " + std::strerror(errno);
+    if (fd >= 0) close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/** @copydoc network::dial */
+int dial(const std::string& host, int port, std::chrono::milliseconds timeout, KvAddress& peer, std::string& error) {
+  std::vector<KvAddress> addresses;
+  if (!resolve(host, port, addresses, error)) return -1;
+
+  Clock::time_point deadline = timeout.count() > 0 ? Clock::now() + timeout : Clock::time_point::max();
+  Clock::time_point next_start = Clock::now();
+  std::vector<Attempt> attempts;
+  std::vector<pollfd> fds;
+  size_t next = 0;
+  int last_error = 0;
+  int winner = -1;
+
+  while (winner < 0) {
+    Clock::time_point now = Clock::now();
+
+    // Start the next address when its turn comes or nothing is pending.
+    while (next < addresses.size() && (attempts.empty() || now >= next_start)) {
+      int fd = start_connect(addresses[next]);
+      if (fd < 0) {
+        last_error = errno;
+        ++next;
+        continue;  // failed at once (e.g. no route); try the next address now
+      }
+      attempts.push_back({fd, next++});
+      next_start = now + ATTEMPT_DELAY;
+    }
+
+    if (attempts.empty()) break;  // every address failed
+    if (now >= deadline) {
+      last_error = ETIMEDOUT;
+      break;
+    }
+
+    fds.clear();
+    for (const Attempt& attempt : attempts) fds.push_back({attempt.fd, POLLOUT, 0});
+    Clock::time_point wake = next < addresses.size() ? std::min(next_start, deadline) : deadline;
+    int wait = wake == Clock::time_point::max() ? -1 : millis_until(wake);
+
+    int ready = poll(fds.data(), fds.size(), wait);
+    if (ready < 0) {
+      if (errno == EINTR) continue;
+      last_error = errno;
+      break;
+    }
+
+    for (size_t i = fds.size(); i-- > 0;) {
+      if (fds[i].revents == 0) continue;
+
+      int so_error = 0;
+      socklen_t len = sizeof(so_error);
+      if (getsockopt(fds[i].fd, SOL_SOCKET, SO_ERROR, &so_error, &len) < 0) so_error = errno;
+
+      if (so_error == 0 && winner < 0) {
+        winner = fds[i].fd;
+        peer = addresses[attempts[i].address];
+      } else {
+        last_error = so_error != 0 ? so_error : last_error;
+        close(fds[i].fd);
+        next_start = Clock::now();  // a failure frees the next address at once
+      }
+      attempts.erase(attempts.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+  }
+
+  // Losers are abandoned mid-handshake.
+  for (const Attempt& attempt : attempts) close(attempt.fd);
+
+  if (winner < 0) {
+    std::string target = (host.find(':') != std::string::npos ? "[" + host + "]" : host) + ":" + std::to_string(port);
+    error = "Connection to " + target + " failed: " + std::strerror(last_error != 0 ? last_error : ECONNREFUSED);
+    if (addresses.size() > 1) error += " (" + std::to_string(addresses.size()) + " addresses)";
+    return -1;
+  }
+
+  // The rest of the client uses blocking I/O.
+  fcntl(winner, F_SETFL, fcntl(winner, F_GETFL) & ~O_NONBLOCK);
+  return winner;
+}
+
+}  // namespace network
@@ -0,0 +1,126 @@
+/**
+ * @file histogram.cpp
+ * @brief KvHistogram method implementations.
+ */
+
+#include "include/histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+constexpr int SUB_BITS = 7;                      // 128 sub-buckets per power of two
+constexpr uint64_t SUB_COUNT = 1ULL << SUB_BITS;
+constexpr int MAX_BITS = 48;                     // values above 2^48 are clamped
+constexpr size_t BUCKET_COUNT = (MAX_BITS - SUB_BITS + 1) * SUB_COUNT;
+}  // namespace
+
+// Constructor
+KvHistogram::KvHistogram() : buckets(BUCKET_COUNT, 0), total(0), minValue(UINT64_MAX), maxValue(0), sum(0) {}
+
+/**
+ * @brief Map a value to its bucket.
+ *
+ * Values below 128 get one bucket each; above that, the top 8 significant
+ * bits select the bucket.
+ */
+size_t KvHistogram::indexOf(uint64_t value) {
+  if (value < SUB_COUNT) return static_cast<size_t>(value);
+
+  int msb = 63 - __builtin_clzll(value);
+  if (msb >= MAX_BITS) return BUCKET_COUNT - 1;
+
+  int shift = msb - SUB_BITS;
+  return static_cast<size_t>((shift + 1) * SUB_COUNT + ((value >> shift) - SUB_COUNT));
+}
+
+/** @brief Largest value that maps to `index`. */
+uint64_t KvHistogram::upperBound(size_t index) {
+  if (index < SUB_COUNT) return index;
+
+  uint64_t shift = index / SUB_COUNT - 1;
+  uint64_t sub = index % SUB_COUNT + SUB_COUNT;
+  return ((sub + 1) << shift) - 1;
+}
+
+/** @brief Add one sample. */
+void KvHistogram::record(uint64_t value) {
+  ++buckets[indexOf(value)];
+  ++total;
+  sum += value;
+  minValue = std::min(minValue, value);
+  maxValue = std::max(maxValue, value);
+}
+
+/** @brief Add every sample of another histogram. */
+void KvHistogram::merge(const KvHistogram& other) {
+  for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+    buckets[i] += other.buckets[i];
+  }
+  total += other.total;
+  sum += other.sum;
+  minValue = std::min(minValue, other.minValue);
+  maxValue = std::max(maxValue, other.maxValue);
+}
+
+/** @brief Remove all samples. */
+void KvHistogram::reset() {
+  std::fill(buckets.begin(), buckets.end(), 0);
+  total = 0;
+  sum = 0;
+  minValue = UINT64_MAX;
+  maxValue = 0;
+}
+
+/** @brief Number of samples recorded. */
+uint64_t KvHistogram::count() const {
+  return total;
+}
+
+/** @brief Smallest sample, 0 if empty. */
+uint64_t KvHistogram::min() const {
+  return total == 0 ? 0 : minValue;
+}
+
+/** @brief Largest sample, 0 if empty. */
+uint64_t KvHistogram::max() const {
+  return maxValue;
+}
+
+/** @brief Arithmetic mean, 0 if empty. */
+double KvHistogram::mean() const {
+  return total == 0 ? 0.0 : static_cast<double>(sum / total);
+}
+
+/**
+ * @brief Value at or below which `p` percent of the samples fall.
+ *
+ * @param p Percentile in [0, 100].
+ * @return Upper bound of the matching bucket, capped at the exact max.
+ */
+uint64_t KvHistogram::percentile(double p) const {
+  if (total == 0) return 0;
+
+  uint64_t rank = static_cast<uint64_t>(std::ceil(p / 100.0 * static_cast<double>(total)));
+  rank = std::max<uint64_t>(rank, 1);
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+    seen += buckets[i];
+    if (seen >= rank) return std::min(upperBound(i), maxValue);
+  }
+  return maxValue;
+}
+
+/**
+ * @brief Format a nanosecond sample as milliseconds with three decimals.
+ *
+ * @param ns Nanoseconds.
+ * @return E.g. "1.250".
+ */
+std::string format_ms(uint64_t ns) {
+  char text[32];
+  std::snprintf(text, sizeof(text), "%.3f", static_cast<double>(ns) / 1e6);
+  return text;
+}
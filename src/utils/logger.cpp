@@ -0,0 +1,244 @@
+/**
+ * @file logger.cpp
+ * @brief Background writer behind the Logger functions.
+ *
+ * Lines are handed over through a bounded multi-producer ring (each slot
+ * carries a sequence number, so producers claim slots with one CAS and the
+ * writer never takes a lock to read them). The writer thread formats every
+ * ready line into one buffer and writes it with a single write(2), so lines
+ * from different threads never tear and never interleave mid-line with
+ * other output on the same descriptor.
+ */
+
+#include "include/logger.hpp"
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <condition_variable>
+#include <mutex>
+#include <string_view>
+#include <thread>
+
+namespace {
+
+/** @brief Ring slots; a power of two. Producers wait while all are in use. */
+constexpr size_t RING_SIZE = 4096;
+
+/** @brief Formatted bytes collected before one write(2). */
+constexpr size_t BATCH_BYTES = 64 * 1024;
+
+// ANSI escape codes
+constexpr std::string_view RESET = "\033[0m";
+constexpr std::string_view BOLD = "\033[1m";
+
+constexpr std::string_view RED = "\033[31m";
+constexpr std::string_view GREEN = "\033[32m";
+constexpr std::string_view YELLOW = "\033[33m";
+constexpr std::string_view BLUE = "\033[34m";
+
+/** @brief Tag and color of one level. */
+struct Style {
+  std::string_view tag;
+  std::string_view color;
+  bool newLine;
+};
+
+/** @brief Indexed by Logger::Level. */
+constexpr Style STYLES[] = {
+    {"[DEBUG]  ", GREEN, true},   {"[INFO]   ", BLUE, true}, {"[SUCCESS]", GREEN, true},
+    {"[CLIENT] ", BLUE, false},   {"[WARN]   ", YELLOW, true}, {"[ERROR]  ", RED, true},
+};
+
+/** @brief One queued line. */
+struct Slot {
+  std::atomic<size_t> sequence; /**< == position: free; == position + 1: ready */
+  Logger::Level level;
+  std::string message;
+};
+
+/**
+ * @class LogWriter
+ * @brief The ring and the thread that drains it.
+ */
+class LogWriter {
+ private:
+  Slot slots[RING_SIZE];
+  alignas(64) std::atomic<size_t> head; /**< Next position to claim (producers) */
+  alignas(64) size_t tail;              /**< Next position to write (writer thread) */
+  std::atomic<size_t> written;          /**< Lines written so far */
+  std::atomic<bool> idle;               /**< Writer is waiting for lines */
+  std::atomic<int> fd;                  /**< Destination */
+  std::atomic<bool> color;              /**< Destination is a TTY */
+  bool stopping;                        /**< Guarded by mutex */
+  std::mutex mutex;                     /**< Guards the sleeps below */
+  std::condition_variable wake;         /**< Lines are ready, or stopping */
+  std::condition_variable drained;      /**< `written` advanced */
+  std::thread thread;
+
+  bool ready() const { return slots[tail % RING_SIZE].sequence.load() == tail + 1; }
+
+  /** @brief Append one formatted line to `batch`. */
+  void format(std::string& batch, const Slot& slot) const {
+    const Style& style = STYLES[static_cast<size_t>(slot.level)];
+    if (color.load(std::memory_order_relaxed)) {
+      batch.append(BOLD).append(style.color).append(style.tag).append(RESET);
+    } else {
+      batch.append(style.tag);
+    }
+    batch += ' ';
+    batch += slot.message;
+    if (style.newLine) batch += '\n';
+  }
+
+  /** @brief Write all of `data`, giving up on errors other than EINTR. */
+  void writeAll(std::string_view data) const {
+    int out = fd.load(std::memory_order_relaxed);
+    while (!data.empty()) {
+      ssize_t n = ::write(out, data.data(), data.size());
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) return;
+      data.remove_prefix(static_cast<size_t>(n));
+    }
+  }
+
+  /** @brief Writer thread: drain ready lines in batches, sleep when empty. */
+  void run() {
+    std::string batch;
+    batch.reserve(BATCH_BYTES);
+    while (true) {
+      size_t lines = 0;
+      while (batch.size() < BATCH_BYTES && ready()) {
+        Slot& slot = slots[tail % RING_SIZE];
+        format(batch, slot);
+        slot.message.clear();
+        slot.sequence.store(tail + RING_SIZE, std::memory_order_release);
+        ++tail;
+        ++lines;
+      }
+
+      if (lines > 0) {
+        writeAll(batch);
+        batch.clear();
+        std::lock_guard<std::mutex> lock(mutex);
+        written.fetch_add(lines);
+        drained.notify_all();
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(mutex);
+      idle.store(true);
+      wake.wait(lock, [this] { return stopping || ready(); });
+      idle.store(false);
+      if (stopping && !ready()) return;
+    }
+  }
+
+ public:
+  LogWriter() : head(0), tail(0), written(0), idle(false), fd(STDOUT_FILENO), color(isatty(STDOUT_FILENO)), stopping(false) {
+    for (size_t i = 0; i < RING_SIZE; ++i) slots[i].sequence.store(i, std::memory_order_relaxed);
+    thread = std::thread(&LogWriter::run, this);
+  }
+
+  /** @brief Writes what is still queued, then stops the thread. */
+  ~LogWriter() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+      wake.notify_one();
+    }
+    thread.join();
+  }
+
+  /** @brief Claim a slot, fill it and wake the writer if it sleeps. */
+  void push(Logger::Level level, std::string message) {
+    size_t position = head.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+      slot = &slots[position % RING_SIZE];
+      size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      if (sequence == position) {
+        if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+      } else if (sequence < position) {
+        // Ring full: let the writer catch up
+        std::this_thread::yield();
+        position = head.load(std::memory_order_relaxed);
+      } else {
+        position = head.load(std::memory_order_relaxed);
+      }
+    }
+
+    slot->level = level;
+    slot->message = std::move(message);
+    // Sequentially consistent with the writer's idle flag: either it sees
+    // this line before sleeping, or this thread sees it asleep.
+    slot->sequence.store(position + 1);
+    if (idle.load()) {
+      std::lock_guard<std::mutex> lock(mutex);
+      wake.notify_one();
+    }
+  }
+
+  /** @brief Wait until every line claimed so far is written. */
+  void flush() {
+    size_t target = head.load();
+    if (written.load() >= target) return;
+    std::unique_lock<std::mutex> lock(mutex);
+    drained.wait(lock, [&] { return written.load() >= target; });
+  }
+
+  /** @brief Switch the destination once earlier lines are out. */
+  void setOutput(int out) {
+    flush();
+    fd.store(out);
+    color.store(isatty(out));
+  }
+};
+
+/** @brief Started on first use, stopped (after draining) at exit. */
+LogWriter& writer() {
+  static LogWriter instance;
+  return instance;
+}
+
+}  // namespace
+
+namespace Logger {
+
+/**
+ * @brief Parse a --log-level value.
+ *
+ * @param name  debug, info, warn, error or off.
+ * @param level Set when true is returned.
+ * @return False for an unknown name.
+ */
+bool parseLevel(const std::string& name, Level& level) {
+  if (name == "debug") {
+    level = Level::DEBUG;
+  } else if (name == "info") {
+    level = Level::INFO;
+  } else if (name == "warn") {
+    level = Level::WARN;
+  } else if (name == "error") {
+    level = Level::ERROR;
+  } else if (name == "off") {
+    level = Level::OFF;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void setOutput(int fd) {
+  writer().setOutput(fd);
+}
+
+void write(Level level, std::string message) {
+  writer().push(level, std::move(message));
+}
+
+void flush() {
+  writer().flush();
+}
+
+}  // namespace Logger
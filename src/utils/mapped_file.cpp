@@ -0,0 +1,83 @@
+/**
+ * @file mapped_file.cpp
+ * @brief KvMappedFile method implementations.
+ */
+
+#include "include/mapped_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "include/logger.hpp"
+
+// Constructor
+KvMappedFile::KvMappedFile() : base(nullptr), length(0) {}
+
+// Destructor
+KvMappedFile::~KvMappedFile() {
+  close();
+}
+
+/**
+ * @brief Map `path` read-only.
+ *
+ * An empty file opens successfully with an empty view.
+ *
+ * @param path File to map.
+ * @return False (after logging) if the file cannot be opened or mapped.
+ */
+bool KvMappedFile::open(const std::string& path) {
+  close();
+
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    Logger::error("Cannot open " + path + ": " + strerror(errno));
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    Logger::error("Not a regular file: " + path);
+    ::close(fd);
+    return false;
+  }
+
+  length = static_cast<size_t>(st.st_size);
+  if (length > 0) {
+    void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      Logger::error("Cannot map " + path + ": " + strerror(errno));
+      ::close(fd);
+      length = 0;
+      return false;
+    }
+    madvise(mapping, length, MADV_SEQUENTIAL);
+    base = static_cast<const char*>(mapping);
+  }
+
+  ::close(fd);  // the mapping keeps the file referenced
+  return true;
+}
+
+/** @brief Unmap the file; views handed out before are invalidated. */
+void KvMappedFile::close() {
+  if (base != nullptr) {
+    munmap(const_cast<char*>(base), length);
+  }
+  base = nullptr;
+  length = 0;
+}
+
+/** @brief The whole file contents. */
+std::string_view KvMappedFile::view() const {
+  return std::string_view(base, length);
+}
+
+/** @brief File size in bytes. */
+size_t KvMappedFile::size() const {
+  return length;
+}
@@ -0,0 +1,332 @@
+/**
+ * @file metrics.cpp
+ * @brief KvMetrics and KvMetricsExporter implementations.
+ */
+
+#include "include/metrics.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+#include "include/logger.hpp"
+
+namespace {
+
+/** @brief Longest name kept as its own command. */
+constexpr size_t MAX_NAME = 32;
+
+/** @brief Percentiles reported for every histogram. */
+constexpr double QUANTILES[] = {50, 90, 99, 99.9};
+
+/** @brief This thread's shard, once it has recorded something. */
+thread_local void* t_shard = nullptr;
+
+/**
+ * @brief Upper-case a command name into `out`.
+ *
+ * @return False if the name is empty, too long or has characters a command
+ *         name does not have (it is then counted as OTHER).
+ */
+bool normalize(std::string_view name, char (&out)[MAX_NAME], size_t& length) {
+  if (name.empty() || name.size() > MAX_NAME) return false;
+  for (size_t i = 0; i < name.size(); ++i) {
+    char c = name[i];
+    if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+    bool valid = (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-' || c == '.';
+    if (!valid) return false;
+    out[i] = c;
+  }
+  length = name.size();
+  return true;
+}
+
+/** @brief Shortest text that reads back as the same double. */
+std::string number(double value) {
+  char text[32];
+  std::snprintf(text, sizeof(text), "%.9g", value);
+  return text;
+}
+
+/** @brief Byte count with a binary unit. */
+std::string bytes_text(uint64_t bytes) {
+  const char* units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+  double value = static_cast<double>(bytes);
+  size_t unit = 0;
+  while (value >= 1024 && unit + 1 < sizeof(units) / sizeof(units[0])) {
+    value /= 1024;
+    ++unit;
+  }
+  char text[32];
+  std::snprintf(text, sizeof(text), unit == 0 ? "%.0f %s" : "%.1f %s", value, units[unit]);
+  return text;
+}
+
+/** @brief Append one Prometheus metric family header. */
+void family(std::string& out, const char* name, const char* type, const char* help) {
+  out.append("# HELP ").append(name).append(" ").append(help).append("\n");
+  out.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+}
+
+/** @brief Append a summary family built from one histogram per command. */
+void summary(std::string& out, const KvMetrics::Snapshot& snapshot, const char* name, const char* help, double scale, bool latency) {
+  family(out, name, "summary", help);
+  for (const auto& [command, stats] : snapshot.commands) {
+    const KvHistogram& histogram = latency ? stats.latency : stats.replyBytes;
+    std::string labels = "command=\"" + command + "\"";
+    for (double q : QUANTILES) {
+      out.append(name).append("{").append(labels).append(",quantile=\"").append(number(q / 100)).append("\"} ");
+      out.append(number(static_cast<double>(histogram.percentile(q)) * scale)).append("\n");
+    }
+    out.append(name).append("_sum{").append(labels).append("} ");
+    out.append(number(histogram.mean() * static_cast<double>(histogram.count()) * scale)).append("\n");
+    out.append(name).append("_count{").append(labels).append("} ").append(std::to_string(histogram.count())).append("\n");
+  }
+}
+
+/** @brief Append a counter family with one sample. */
+void counter(std::string& out, const char* name, const char* help, uint64_t value) {
+  family(out, name, "counter", help);
+  out.append(name).append(" ").append(std::to_string(value)).append("\n");
+}
+
+}  // namespace
+
+// --------------------------------------------------
+// @INFO KvMetrics
+// --------------------------------------------------
+
+// Constructor
+KvMetrics::KvMetrics() : started(std::chrono::steady_clock::now()) {}
+
+/** @brief The process-wide registry, created on first use. */
+KvMetrics& KvMetrics::global() {
+  static KvMetrics registry;
+  return registry;
+}
+
+/** @brief This thread's shard, registered on first use. */
+KvMetrics::Shard& KvMetrics::local() {
+  if (t_shard == nullptr) {
+    std::lock_guard<std::mutex> lock(mutex);
+    shards.push_back(std::make_unique<Shard>());
+    t_shard = shards.back().get();
+  }
+  return *static_cast<Shard*>(t_shard);
+}
+
+/** @brief Count one socket send of `bytes`. */
+void KvMetrics::sent(size_t bytes) {
+  Shard& shard = local();
+  shard.bytesOut.fetch_add(bytes, std::memory_order_relaxed);
+  shard.sends.fetch_add(1, std::memory_order_relaxed);
+}
+
+/** @brief Count `bytes` read from a socket. */
+void KvMetrics::received(size_t bytes) {
+  local().bytesIn.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+/** @brief Count one complete reply frame. */
+void KvMetrics::frame() {
+  local().frames.fetch_add(1, std::memory_order_relaxed);
+}
+
+/** @brief Count one successful reconnect. */
+void KvMetrics::reconnected() {
+  local().reconnects.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Record a command's reply.
+ *
+ * @param command Command name as sent (any case).
+ * @param latency Time from the send to the reply.
+ * @param reply   Raw reply; `-` and `!` replies count as errors.
+ */
+void KvMetrics::reply(std::string_view command, std::chrono::steady_clock::duration latency, std::string_view reply) {
+  this->reply(command, latency, !reply.empty() && (reply[0] == '-' || reply[0] == '!'), reply.size());
+}
+
+/**
+ * @brief Record a reply that was not held in memory, e.g. a streamed bulk.
+ *
+ * @param command Command name as sent (any case).
+ * @param latency Time from the send to the end of the reply.
+ * @param error   The reply was an error.
+ * @param bytes   Reply size in bytes.
+ */
+void KvMetrics::reply(std::string_view command, std::chrono::steady_clock::duration latency, bool error, size_t bytes) {
+  char name[MAX_NAME];
+  size_t length = 0;
+  std::string_view key = normalize(command, name, length) ? std::string_view(name, length) : std::string_view("OTHER");
+
+  Shard& shard = local();
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto found = shard.commands.find(key);
+  if (found == shard.commands.end()) {
+    if (shard.commands.size() >= MAX_COMMANDS) key = "OTHER";
+    found = shard.commands.emplace(std::string(key), CommandStats()).first;
+  }
+
+  CommandStats& stats = found->second;
+  ++stats.requests;
+  if (error) ++stats.errors;
+  stats.latency.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count()));
+  stats.replyBytes.record(bytes);
+}
+
+/** @brief Merge every shard into one view. */
+KvMetrics::Snapshot KvMetrics::snapshot() {
+  Snapshot merged;
+  merged.uptime = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  for (const std::unique_ptr<Shard>& shard : shards) {
+    merged.bytesOut += shard->bytesOut.load(std::memory_order_relaxed);
+    merged.bytesIn += shard->bytesIn.load(std::memory_order_relaxed);
+    merged.sends += shard->sends.load(std::memory_order_relaxed);
+    merged.frames += shard->frames.load(std::memory_order_relaxed);
+    merged.reconnects += shard->reconnects.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> shard_lock(shard->mutex);
+    for (const auto& [name, stats] : shard->commands) {
+      CommandStats& total = merged.commands[name];
+      total.requests += stats.requests;
+      total.errors += stats.errors;
+      total.latency.merge(stats.latency);
+      total.replyBytes.merge(stats.replyBytes);
+    }
+  }
+  return merged;
+}
+
+/**
+ * @brief Human-readable table, as printed by `:stats`.
+ *
+ * @param snapshot Merged statistics.
+ * @return One row per command and a totals line.
+ */
+std::string KvMetrics::table(const Snapshot& snapshot) {
+  std::string out;
+  char row[160];
+  std::snprintf(row, sizeof(row), "%-12s %10s %8s %10s %10s %10s %10s %12s\n", "command", "requests", "errors", "avg ms", "p50", "p99", "max",
+                "avg reply");
+  out += row;
+  for (const auto& [name, stats] : snapshot.commands) {
+    std::snprintf(row, sizeof(row), "%-12s %10llu %8llu %10s %10s %10s %10s %12s\n", name.c_str(), static_cast<unsigned long long>(stats.requests),
+                  static_cast<unsigned long long>(stats.errors), format_ms(static_cast<uint64_t>(stats.latency.mean())).c_str(),
+                  format_ms(stats.latency.percentile(50)).c_str(), format_ms(stats.latency.percentile(99)).c_str(), format_ms(stats.latency.max()).c_str(),
+                  bytes_text(static_cast<uint64_t>(stats.replyBytes.mean())).c_str());
+    out += row;
+  }
+  char seconds[32];
+  std::snprintf(seconds, sizeof(seconds), "%.1f", snapshot.uptime);
+  out += "sent " + bytes_text(snapshot.bytesOut) + " in " + std::to_string(snapshot.sends) + " writes, received " + bytes_text(snapshot.bytesIn) +
+         " in " + std::to_string(snapshot.frames) + " replies, " + std::to_string(snapshot.reconnects) + " reconnects, up " +
+         seconds + " s\n";
+  return out;
+}
+
+/**
+ * @brief JSON object of every counter and percentile.
+ *
+ * Command names are restricted by normalize(), so they need no escaping.
+ */
+std::string KvMetrics::json(const Snapshot& snapshot) {
+  std::string out = "{\"uptime_seconds\": " + number(snapshot.uptime) + ", \"bytes_out\": " + std::to_string(snapshot.bytesOut) +
+                    ", \"bytes_in\": " + std::to_string(snapshot.bytesIn) + ", \"sends\": " + std::to_string(snapshot.sends) +
+                    ", \"replies\": " + std::to_string(snapshot.frames) + ", \"reconnects\": " + std::to_string(snapshot.reconnects) +
+                    ", \"commands\": {";
+  bool first = true;
+  for (const auto& [name, stats] : snapshot.commands) {
+    if (!first) out += ", ";
+    first = false;
+    out += "\"" + name + "\": {\"requests\": " + std::to_string(stats.requests) + ", \"errors\": " + std::to_string(stats.errors) +
+           ", \"latency_ms\": {\"avg\": " + format_ms(static_cast<uint64_t>(stats.latency.mean()));
+    for (double q : QUANTILES) out += ", \"p" + number(q) + "\": " + format_ms(stats.latency.percentile(q));
+    out += ", \"max\": " + format_ms(stats.latency.max()) + "}, \"reply_bytes\": {\"avg\": " + number(stats.replyBytes.mean());
+    for (double q : QUANTILES) out += ", \"p" + number(q) + "\": " + std::to_string(stats.replyBytes.percentile(q));
+    out += ", \"max\": " + std::to_string(stats.replyBytes.max()) + "}}";
+  }
+  out += "}}\n";
+  return out;
+}
+
+/**
+ * @brief Prometheus text exposition format.
+ *
+ * Latency and reply size are summaries with 0.5/0.9/0.99/0.999 quantiles,
+ * computed from the client's histograms.
+ */
+std::string KvMetrics::prometheus(const Snapshot& snapshot) {
+  std::string out;
+  family(out, "kvcli_requests_total", "counter", "Replies received, by command.");
+  for (const auto& [name, stats] : snapshot.commands) {
+    out += "kvcli_requests_total{command=\"" + name + "\"} " + std::to_string(stats.requests) + "\n";
+  }
+  family(out, "kvcli_errors_total", "counter", "Error replies, by command.");
+  for (const auto& [name, stats] : snapshot.commands) {
+    out += "kvcli_errors_total{command=\"" + name + "\"} " + std::to_string(stats.errors) + "\n";
+  }
+  summary(out, snapshot, "kvcli_request_duration_seconds", "Time from send to reply, by command.", 1e-9, true);
+  summary(out, snapshot, "kvcli_reply_bytes", "Raw reply size, by command.", 1, false);
+  counter(out, "kvcli_sent_bytes_total", "Bytes written to servers.", snapshot.bytesOut);
+  counter(out, "kvcli_received_bytes_total", "Bytes read from servers.", snapshot.bytesIn);
+  counter(out, "kvcli_sends_total", "Socket writes; a pipelined batch is one.", snapshot.sends);
+  counter(out, "kvcli_replies_total", "Reply frames received.", snapshot.frames);
+  counter(out, "kvcli_reconnects_total", "Connections re-opened after a failure.", snapshot.reconnects);
+  family(out, "kvcli_uptime_seconds", "gauge", "Seconds since the client started.");
+  out += "kvcli_uptime_seconds " + number(snapshot.uptime) + "\n";
+  return out;
+}
+
+// --------------------------------------------------
+// @INFO KvMetricsExporter
+// --------------------------------------------------
+
+// Constructor
+KvMetricsExporter::KvMetricsExporter(std::string jsonFile, std::string textFile, std::chrono::seconds interval)
+    : jsonFile(std::move(jsonFile)), textFile(std::move(textFile)), interval(interval), stopping(false) {
+  KvMetrics::global();  // uptime counts from here
+  if (!this->textFile.empty()) thread = std::thread(&KvMetricsExporter::run, this);
+}
+
+// Destructor
+KvMetricsExporter::~KvMetricsExporter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+    wake.notify_one();
+  }
+  if (thread.joinable()) thread.join();
+
+  if (jsonFile.empty() && textFile.empty()) return;
+  KvMetrics::Snapshot snapshot = KvMetrics::global().snapshot();
+  if (!textFile.empty()) writeFile(textFile, KvMetrics::prometheus(snapshot));
+  if (!jsonFile.empty() && !writeFile(jsonFile, KvMetrics::json(snapshot))) Logger::error("Cannot write metrics to " + jsonFile);
+}
+
+/** @brief Rewrite the textfile every interval until stopped. */
+void KvMetricsExporter::run() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (!stopping) {
+    lock.unlock();
+    if (!writeFile(textFile, KvMetrics::prometheus(KvMetrics::global().snapshot()))) Logger::warn("Cannot write metrics to " + textFile);
+    lock.lock();
+    wake.wait_for(lock, interval, [this] { return stopping; });
+  }
+}
+
+/**
+ * @brief Replace `path` with `contents` through a temporary file and a rename.
+ *
+ * @return False if the file could not be written.
+ */
+bool KvMetricsExporter::writeFile(const std::string& path, const std::string& contents) {
+  std::string temp = path + ".tmp";
+  {
+    std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+    if (!out || !out.write(contents.data(), static_cast<std::streamsize>(contents.size())) || !out.flush()) return false;
+  }
+  return std::rename(temp.c_str(), path.c_str()) == 0;
+}
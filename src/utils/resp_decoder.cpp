@@ -9,9 +9,38 @@
  */
 
 #include "include/include.hpp"
+#include "include/render.hpp"
 #include "include/resp.hpp"
+#include "include/resp_scan.hpp"
 
 namespace resp {
+
+/**
+ * @brief Position of the first CRLF in `str` at or after `from`.
+ *
+ * @return Offset of the '\r', or npos.
+ */
+static size_t crlf_at(std::string_view str, size_t from) {
+  if (from >= str.size()) return std::string_view::npos;
+  const char* cr = find_crlf(str.data() + from, str.data() + str.size());
+  return cr != nullptr ? static_cast<size_t>(cr - str.data()) : std::string_view::npos;
+}
+
+/**
+ * @brief Parses the `<len>\r\n` header that follows the type byte at `pos`.
+ *
+ * @param str  Encoded reply.
+ * @param pos  Offset of the type byte; moved past the header on success.
+ * @param len  Parsed length.
+ * @return False if the header is malformed or incomplete.
+ */
+static bool read_length(std::string_view str, size_t& pos, int64_t& len) {
+  const char* next = nullptr;
+  if (parse_length_line(str.data() + pos + 1, str.data() + str.size(), len, next) != LineStatus::OK) return false;
+  pos = static_cast<size_t>(next - str.data());
+  return true;
+}
+
 /**
  * @brief Decodes a RESP simple string: `+<str>\r\n`.
  *
@@ -20,14 +49,14 @@ namespace resp {
  * @param str The RESP-encoded simple string starting with '+'.
  * @return Human-readable formatted string.
  */
-std::string decode_simple_string(const std::string& str) {
-  size_t end_pos = str.find("\r\n");
-  if (end_pos == std::string::npos || str.size() < 2) {
+std::string decode_simple_string(std::string_view str) {
+  size_t end_pos = crlf_at(str, 1);
+  if (end_pos == std::string_view::npos) {
     return "(string) (invalid input)";
   }
-  std::ostringstream oss;
-  oss << "(string) " << str.substr(1, end_pos - 1);
-  return oss.str();
+  std::string out = "(string) ";
+  out.append(str.substr(1, end_pos - 1));
+  return out;
 }
 
 /**
@@ -38,14 +67,14 @@ std::string decode_simple_string(const std::string& str) {
  * @param str The RESP-encoded integer starting with ':'.
  * @return Human-readable formatted string.
  */
-std::string decode_integer(const std::string& str) {
-  size_t end_pos = str.find("\r\n");
-  if (end_pos == std::string::npos || str.size() < 2) {
+std::string decode_integer(std::string_view str) {
+  size_t end_pos = crlf_at(str, 1);
+  if (end_pos == std::string_view::npos) {
     return "(integer) (invalid input)";
   }
-  std::ostringstream oss;
-  oss << "(integer) " << str.substr(1, end_pos - 1);
-  return oss.str();
+  std::string out = "(integer) ";
+  out.append(str.substr(1, end_pos - 1));
+  return out;
 }
 
 /**
@@ -56,7 +85,7 @@ std::string decode_integer(const std::string& str) {
  * @param str The RESP-encoded boolean starting with '#'.
  * @return Human-readable formatted string.
  */
-std::string decode_boolean(const std::string& str) {
+std::string decode_boolean(std::string_view str) {
   if (str.size() < 2) {
     return "(boolean) (invalid input)";
   }
@@ -74,87 +103,82 @@ std::string decode_boolean(const std::string& str) {
  * @param str The RESP-encoded bulk string starting with '$'.
  * @return Human-readable formatted string.
  */
-std::string decode_bulk_string(const std::string& str) {
-  size_t len_end = str.find("\r\n", 1);
-  if (len_end == std::string::npos || str.size() < 2) {
+std::string decode_bulk_string(std::string_view str) {
+  size_t val_start = 0;
+  int64_t len = 0;
+  if (str.size() < 2 || !read_length(str, val_start, len)) {
     return "(string) (invalid input)";
   }
+  if (len < 0) return "(string) null";  // null bulk string
 
-  int len = std::stoi(str.substr(1, len_end - 1));
-  if (len == -1) return "(string) null";  // null bulk string
-
-  size_t val_start = len_end + 2;
   if (val_start + len > str.size()) {
     return "(string) (incomplete)";
   }
 
-  std::string val = str.substr(val_start, len);
-  std::ostringstream oss;
-  oss << "(string) " << val;
-  return oss.str();
+  std::string out;
+  out.reserve(9 + len);
+  out += "(string) ";
+  out.append(str.substr(val_start, len));
+  return out;
 }
 
 /**
  * @brief Decodes a RESP array: `*<count>\r\n` followed by elements.
  *
- * Recursively parses array elements and formats as "(array) [elem1, elem2, ...]".
- * Currently focuses on bulk string array elements for the CLI use case.
+ * Formats as "(array) [elem1, elem2, ...]". Arrays of bulk strings, the
+ * common case, are formatted here directly; any other element hands the
+ * whole reply to format_reply().
  *
  * @param str The RESP-encoded array starting with '*'.
  * @return Human-readable formatted string.
  */
-std::string decode_array(const std::string& str) {
-  std::ostringstream oss;
-  oss << "(array) [";
-
-  size_t pos = 1;
-  size_t len_end = str.find("\r\n", pos);
-  if (len_end == std::string::npos) return "(array) (invalid input)";
+std::string decode_array(std::string_view str) {
+  size_t pos = 0;
+  int64_t count = 0;
+  if (!read_length(str, pos, count)) return "(array) (invalid input)";
 
-  int count = std::stoi(str.substr(pos, len_end - pos));
-  pos = len_end + 2;
+  // Each element costs at least its value plus quotes and a separator.
+  std::string out;
+  out.reserve(str.size() + 16);
+  out += "(array) [";
 
-  for (int i = 0; i < count; ++i) {
-    if (i > 0) oss << ", ";
+  for (int64_t i = 0; i < count; ++i) {
+    if (i > 0) out += ", ";
 
     if (pos >= str.size()) {
-      oss << "(incomplete)";
+      out += "(incomplete)";
       break;
     }
 
     char type = str[pos];
     if (type == '$') {
-      size_t bulk_len_end = str.find("\r\n", pos + 1);
-      if (bulk_len_end == std::string::npos) {
-        oss << "(invalid)";
+      int64_t bulk_len = 0;
+      if (!read_length(str, pos, bulk_len)) {
+        out += "(invalid)";
         break;
       }
 
-      int bulk_len = std::stoi(str.substr(pos + 1, bulk_len_end - (pos + 1)));
-      size_t val_start = bulk_len_end + 2;
-
-      if (bulk_len == -1) {
-        oss << "null";
-        pos = val_start + 2;
+      if (bulk_len < 0) {
+        out += "null";
         continue;
       }
 
-      if (val_start + bulk_len > str.size()) {
-        oss << "(incomplete)";
+      if (pos + bulk_len > str.size()) {
+        out += "(incomplete)";
         break;
       }
 
-      std::string val = str.substr(val_start, bulk_len);
-      oss << "\"" << val << "\"";
-      pos = val_start + bulk_len + 2;  // skip value + \r\n
+      out += '"';
+      out.append(str.substr(pos, bulk_len));
+      out += '"';
+      pos += bulk_len + 2;  // skip value + \r\n
     } else {
-      oss << "(unknown)";
-      break;
+      return format_reply(str);  // nested or RESP3 elements
     }
   }
 
-  oss << "]";
-  return oss.str();
+  out += "]";
+  return out;
 }
 
 /**
@@ -165,16 +189,42 @@ std::string decode_array(const std::string& str) {
  * @param str The RESP-encoded error starting with '-'.
  * @return Human-readable formatted string.
  */
-std::string decode_error(const std::string& str) {
-  size_t end_pos = str.find("\r\n");
-  if (end_pos == std::string::npos || str.size() < 2) {
+std::string decode_error(std::string_view str) {
+  size_t end_pos = crlf_at(str, 1);
+  if (end_pos == std::string_view::npos) {
     return "(error) (invalid input)";
   }
 
-  std::string message = str.substr(1, end_pos - 1);
-  std::ostringstream oss;
-  oss << "(error) " << message;
-  return oss.str();
+  std::string out = "(error) ";
+  out.append(str.substr(1, end_pos - 1));
+  return out;
+}
+
+/**
+ * @brief Extracts the command name from an encoded request.
+ *
+ * Accepts both plain bulk-string commands (encode_command) and the typed
+ * dialect, where each element is a bulk string wrapping an encoded token.
+ *
+ * @param encoded A RESP request array.
+ * @return The first element's text; empty if it cannot be found.
+ */
+std::string_view command_name(std::string_view encoded) {
+  size_t pos = 0;
+  int64_t count = 0;
+  if (encoded.size() < 2 || encoded[0] != '*' || !read_length(encoded, pos, count) || count < 1) return {};
+
+  std::string_view name;
+  for (int unwrap = 0; unwrap < 2; ++unwrap) {
+    int64_t len = 0;
+    if (pos >= encoded.size() || encoded[pos] != '$' || !read_length(encoded, pos, len) || len < 0) break;
+    if (pos + len > encoded.size()) break;
+
+    name = encoded.substr(pos, len);
+    encoded = name;  // a typed element wraps another bulk string
+    pos = 0;
+  }
+  return name;
 }
 
 /**
@@ -187,7 +237,7 @@ std::string decode_error(const std::string& str) {
  * @param str The RESP-encoded response string.
  * @return Human-readable formatted response.
  */
-std::string decode(const std::string& str) {
+std::string decode(std::string_view str) {
   if (str.empty()) return "(null)";
 
   char prefix = str[0];
@@ -205,7 +255,7 @@ std::string decode(const std::string& str) {
     case '#':
       return decode_boolean(str);
     default:
-      return "(unknown)";
+      return format_reply(str);  // RESP3 types
   }
 }
 
@@ -1,56 +1,431 @@
 /**
  * @file resp_encoder.cpp
  * @brief RESP protocol encoder implementations.
+ *
+ * Every encoder appends to a caller-owned buffer; the std::string returning
+ * encode_* functions are thin wrappers kept for convenience. Numbers are
+ * formatted with std::to_chars and arguments are taken as std::string_view,
+ * so encoding into a reused buffer does not allocate.
  */
 
+#include <cctype>
+#include <charconv>
+
 #include "include/logger.hpp"
 #include "include/resp.hpp"
 
 namespace resp {
 
+namespace {
+
+/** @brief Append a decimal integer. */
+template <typename T>
+void append_number(std::string& out, T value) {
+  char digits[24];
+  auto result = std::to_chars(digits, digits + sizeof(digits), value);
+  out.append(digits, static_cast<size_t>(result.ptr - digits));
+}
+
+/** @brief Number of characters append_number() writes for `value`. */
+template <typename T>
+size_t number_width(T value) {
+  char digits[24];
+  return static_cast<size_t>(std::to_chars(digits, digits + sizeof(digits), value).ptr - digits);
+}
+
+/** @brief Size of `$<len>\r\n<data>\r\n` for a payload of `len` bytes. */
+size_t bulk_size(size_t len) {
+  return 1 + number_width(len) + 2 + len + 2;
+}
+
+/** @brief RESP type chosen for a token by encode_token. */
+enum class TokenType { INTEGER, BOOLEAN, ARRAY, BULK };
+
+/**
+ * @brief Parse an integer token (optional sign) into an int64.
+ *
+ * @return False on overflow, in which case the token is sent as a string.
+ */
+bool parse_integer(std::string_view token, int64_t& value) {
+  if (!token.empty() && token.front() == '+') token.remove_prefix(1);
+  auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+  return result.ec == std::errc() && result.ptr == token.data() + token.size();
+}
+
+/** @brief Decide how a token is encoded, as encode_token does. */
+TokenType classify(std::string_view token, int64_t& number) {
+  if (is_integer(token) && parse_integer(token, number)) return TokenType::INTEGER;
+  if (is_boolean(token)) return TokenType::BOOLEAN;
+  if (is_array(token)) return TokenType::ARRAY;
+  return TokenType::BULK;
+}
+
+/** @brief Call `fn` for each whitespace-separated word, like `stream >> token`. */
+template <typename Fn>
+void for_each_word(std::string_view input, Fn fn) {
+  size_t pos = 0;
+  while (pos < input.size()) {
+    while (pos < input.size() && std::isspace(static_cast<unsigned char>(input[pos]))) ++pos;
+    size_t start = pos;
+    while (pos < input.size() && !std::isspace(static_cast<unsigned char>(input[pos]))) ++pos;
+    if (pos > start) fn(input.substr(start, pos - start));
+  }
+}
+
+}  // namespace
+
+// --------------------------------------------------
+// @INFO Buffer
+// --------------------------------------------------
+
+// Constructor
+Buffer::Buffer(size_t threshold) : sealed(0), threshold(threshold) {}
+
+/**
+ * @brief Reference a payload instead of copying it.
+ *
+ * Payloads below the threshold are copied, since an extra iovec costs more
+ * than the copy.
+ */
+void Buffer::attach(std::string_view payload) {
+  if (payload.size() < threshold) {
+    bytes.append(payload.data(), payload.size());
+    return;
+  }
+  if (bytes.size() > sealed) {
+    pieces.push_back({nullptr, sealed, bytes.size() - sealed});
+    sealed = bytes.size();
+  }
+  pieces.push_back({payload.data(), 0, payload.size()});
+}
+
+/**
+ * @brief Map a file for attach(), keeping the mapping until clear().
+ *
+ * @param path     File to map.
+ * @param contents Output view of the whole file.
+ * @return False (after logging) if the file cannot be mapped.
+ */
+bool Buffer::mapFile(const std::string& path, std::string_view& contents) {
+  auto file = std::make_unique<KvMappedFile>();
+  if (!file->open(path)) return false;
+  contents = file->view();
+  files.push_back(std::move(file));
+  return true;
+}
+
+/** @brief Drop the contents and unmap files, keeping capacity. */
+void Buffer::clear() {
+  bytes.clear();
+  pieces.clear();
+  files.clear();
+  sealed = 0;
+}
+
+/** @brief Total bytes the command occupies on the wire. */
+size_t Buffer::size() const {
+  size_t total = bytes.size() - sealed;
+  for (const Piece& piece : pieces) total += piece.length;
+  return total;
+}
+
+/**
+ * @brief Describe the command as iovecs in send order.
+ *
+ * @param iov Cleared and filled with one entry per piece.
+ */
+void Buffer::gather(std::vector<struct iovec>& iov) const {
+  iov.clear();
+  for (const Piece& piece : pieces) {
+    const char* base = piece.data != nullptr ? piece.data : bytes.data() + piece.offset;
+    iov.push_back({const_cast<char*>(base), piece.length});
+  }
+  if (bytes.size() > sealed) {
+    iov.push_back({const_cast<char*>(bytes.data() + sealed), bytes.size() - sealed});
+  }
+}
+
+/** @brief Flatten into a single string (copies referenced payloads). */
+std::string Buffer::str() const {
+  std::string flat;
+  flat.reserve(size());
+  std::vector<struct iovec> iov;
+  gather(iov);
+  for (const struct iovec& part : iov) flat.append(static_cast<const char*>(part.iov_base), part.iov_len);
+  return flat;
+}
+
+// --------------------------------------------------
+// @INFO Appending encoders
+// --------------------------------------------------
+
+/**
+ * @brief Append a bulk string: `$<len>\r\n<data>\r\n`.
+ */
+void append_bulk_string(std::string& out, std::string_view str) {
+  out += '$';
+  append_number(out, str.size());
+  out += "\r\n";
+  out.append(str.data(), str.size());
+  out += "\r\n";
+}
+
+/**
+ * @brief Append a simple string: `+<str>\r\n`.
+ */
+void append_simple_string(std::string& out, std::string_view str) {
+  out += '+';
+  out.append(str.data(), str.size());
+  out += "\r\n";
+}
+
+/**
+ * @brief Append an error: `-<message>\r\n`.
+ */
+void append_error(std::string& out, std::string_view str) {
+  out += '-';
+  out.append(str.data(), str.size());
+  out += "\r\n";
+}
+
+/**
+ * @brief Append an integer: `:<num>\r\n`.
+ */
+void append_integer(std::string& out, int64_t num) {
+  out += ':';
+  append_number(out, num);
+  out += "\r\n";
+}
+
+/**
+ * @brief Append a boolean: `#t\r\n` or `#f\r\n`.
+ */
+void append_boolean(std::string& out, bool value) {
+  out += value ? "#t\r\n" : "#f\r\n";
+}
+
+/**
+ * @brief Append an array header: `*<count>\r\n`.
+ */
+void append_array_header(std::string& out, size_t count) {
+  out += '*';
+  append_number(out, count);
+  out += "\r\n";
+}
+
+/**
+ * @brief Append a token with its detected RESP type.
+ *
+ * Produces the same bytes as encode_token().
+ */
+void append_token(std::string& out, std::string_view token) {
+  int64_t number = 0;
+  switch (classify(token, number)) {
+    case TokenType::INTEGER:
+      append_integer(out, number);
+      break;
+    case TokenType::BOOLEAN:
+      append_boolean(out, token == "true");
+      break;
+    case TokenType::ARRAY: {
+      std::vector<std::string> elements = parse_array(std::string(token));
+      append_array_header(out, elements.size());
+      for (const auto& element : elements) append_bulk_string(out, element);
+      break;
+    }
+    case TokenType::BULK:
+      append_bulk_string(out, token);
+      break;
+  }
+}
+
+/**
+ * @brief Append a typed token wrapped as a bulk string command element.
+ *
+ * This is the element layout resp::encode uses: the bulk length is the
+ * size of the typed encoding, computed up front so nothing is staged in a
+ * temporary string.
+ */
+void append_token_element(std::string& out, std::string_view token) {
+  int64_t number = 0;
+  size_t inner = 0;
+  switch (classify(token, number)) {
+    case TokenType::INTEGER:
+      inner = 1 + number_width(number) + 2;
+      break;
+    case TokenType::BOOLEAN:
+      inner = 4;
+      break;
+    case TokenType::ARRAY: {
+      std::vector<std::string> elements = parse_array(std::string(token));
+      inner = 1 + number_width(elements.size()) + 2;
+      for (const auto& element : elements) inner += bulk_size(element.size());
+      break;
+    }
+    case TokenType::BULK:
+      inner = bulk_size(token.size());
+      break;
+  }
+
+  out += '$';
+  append_number(out, inner);
+  out += "\r\n";
+  append_token(out, token);
+  out += "\r\n";
+}
+
+/**
+ * @brief Append a whitespace-separated input line as a typed command.
+ *
+ * Produces the same bytes as encode().
+ */
+void append_encoded(std::string& out, std::string_view input) {
+  size_t count = 0;
+  for_each_word(input, [&](std::string_view) { ++count; });
+  append_array_header(out, count);
+  for_each_word(input, [&](std::string_view token) { append_token_element(out, token); });
+}
+
+/**
+ * @brief Append a command whose arguments are plain bulk strings.
+ *
+ * Produces the same bytes as encode_command().
+ */
+void append_command(std::string& out, std::string_view cmd, const std::vector<std::string_view>& args) {
+  append_array_header(out, args.size() + 1);
+  append_bulk_string(out, cmd);
+  for (std::string_view arg : args) append_bulk_string(out, arg);
+}
+
+/**
+ * @brief Buffer form of append_token_element().
+ *
+ * `@path` stands for the contents of a file, sent as a plain string: the
+ * file is mapped and referenced, so it is neither read into memory nor
+ * limited to one input line. `@@text` sends `@text`. Other plain values at
+ * or above the buffer threshold are referenced in `token` rather than
+ * copied; `token` must stay alive until it is sent.
+ *
+ * @return False (after logging) if a file could not be mapped.
+ */
+bool append_token_element(Buffer& out, std::string_view token) {
+  std::string_view payload = token;
+  bool file = false;
+  if (token.size() > 1 && token[0] == '@') {
+    if (token[1] == '@') {
+      token.remove_prefix(1);
+      payload = token;
+    } else if (out.mapFile(std::string(token.substr(1)), payload)) {
+      file = true;  // never type-detected
+    } else {
+      return false;
+    }
+  }
+
+  int64_t number = 0;
+  if (!file && (token.size() < out.zeroCopyThreshold() || classify(token, number) != TokenType::BULK)) {
+    append_token_element(out.framing(), token);
+    return true;
+  }
+
+  // Plain value: frame it here, send the payload from where it lives.
+  std::string& framing = out.framing();
+  framing += '$';
+  append_number(framing, bulk_size(payload.size()));
+  framing += "\r\n$";
+  append_number(framing, payload.size());
+  framing += "\r\n";
+  out.attach(payload);
+  framing += "\r\n\r\n";
+  return true;
+}
+
+/**
+ * @brief Buffer form of append_encoded().
+ *
+ * Words are encoded with the Buffer form of append_token_element(), so
+ * `@path` words send file contents; `input` must stay alive until it is
+ * sent.
+ *
+ * @return False (after logging) if a file could not be mapped.
+ */
+bool append_encoded(Buffer& out, std::string_view input) {
+  size_t count = 0;
+  for_each_word(input, [&](std::string_view) { ++count; });
+  append_array_header(out.framing(), count);
+
+  bool encoded = true;
+  for_each_word(input, [&](std::string_view token) {
+    if (encoded) encoded = append_token_element(out, token);
+  });
+  return encoded;
+}
+
+/**
+ * @brief Buffer form of append_command().
+ *
+ * Large arguments are referenced rather than copied.
+ */
+void append_command(Buffer& out, std::string_view cmd, const std::vector<std::string_view>& args) {
+  append_array_header(out.framing(), args.size() + 1);
+  append_bulk_string(out.framing(), cmd);
+  for (std::string_view arg : args) {
+    std::string& framing = out.framing();
+    framing += '$';
+    append_number(framing, arg.size());
+    framing += "\r\n";
+    out.attach(arg);
+    framing += "\r\n";
+  }
+}
+
+// --------------------------------------------------
+// @INFO String-returning encoders
+// --------------------------------------------------
+
 /**
  * @brief Encode a bulk string: `$<len>\r\n<data>\r\n`.
  */
 std::string encode_bulk_string(const std::string& str) {
-  std::ostringstream oss;
-  oss << "$" << str.length() << "\r\n" << str << "\r\n";
-  return oss.str();
+  std::string out;
+  append_bulk_string(out, str);
+  return out;
 }
 
 /**
  * @brief Encode a simple string: `+<str>\r\n`.
  */
 std::string encode_simple_string(const std::string& str) {
-  std::ostringstream oss;
-  oss << "+" << str << "\r\n";
-  return oss.str();
+  std::string out;
+  append_simple_string(out, str);
+  return out;
 }
 
 /**
  * @brief Encode an error: `-<message>\r\n`.
  */
 std::string encode_error(const std::string& str) {
-  std::ostringstream oss;
-  oss << "-" << str << "\r\n";
-  return oss.str();
+  std::string out;
+  append_error(out, str);
+  return out;
 }
 
 /**
  * @brief Encode an integer: `:<num>\r\n`.
  */
 std::string encode_integer(int64_t num) {
-  std::ostringstream oss;
-  oss << ":" << num << "\r\n";
-  return oss.str();
+  std::string out;
+  append_integer(out, num);
+  return out;
 }
 
 /**
  * @brief Encode a boolean: `#t\r\n` or `#f\r\n`.
  */
 std::string encode_boolean(bool value) {
-  std::ostringstream oss;
-  oss << "#" << (value ? "t" : "f") << "\r\n";
-  return oss.str();
+  std::string out;
+  append_boolean(out, value);
+  return out;
 }
 
 /**
@@ -59,12 +434,10 @@ std::string encode_boolean(bool value) {
  * Formats as `*<count>\r\n` followed by each element.
  */
 std::string encode_array(const std::vector<std::string>& elements) {
-  std::ostringstream oss;
-  oss << "*" << elements.size() << "\r\n";
-  for (const auto& element : elements) {
-    oss << encode_bulk_string(element);
-  }
-  return oss.str();
+  std::string out;
+  append_array_header(out, elements.size());
+  for (const auto& element : elements) append_bulk_string(out, element);
+  return out;
 }
 
 /**
@@ -72,7 +445,7 @@ std::string encode_array(const std::vector<std::string>& elements) {
  * @param str String to check
  * @return true if string is a valid integer
  */
-bool is_integer(const std::string& str) {
+bool is_integer(std::string_view str) {
   if (str.empty()) return false;
 
   size_t start = 0;
@@ -81,7 +454,7 @@ bool is_integer(const std::string& str) {
     start = 1;
   }
 
-  return str.find_first_not_of("0123456789", start) == std::string::npos;
+  return str.find_first_not_of("0123456789", start) == std::string_view::npos;
 }
 
 /**
@@ -89,7 +462,7 @@ bool is_integer(const std::string& str) {
  * @param str String to check
  * @return true if string is a valid boolean representation
  */
-bool is_boolean(const std::string& str) {
+bool is_boolean(std::string_view str) {
   return str == "true" || str == "false";
 }
 
@@ -98,7 +471,7 @@ bool is_boolean(const std::string& str) {
  * @param str String to check
  * @return true if string appears to be an array
  */
-bool is_array(const std::string& str) {
+bool is_array(std::string_view str) {
   return !str.empty() && str.front() == '[' && str.back() == ']';
 }
 
@@ -161,21 +534,23 @@ std::vector<std::string> parse_array(const std::string& str) {
  * @return RESP-encoded string
  */
 std::string encode(const std::string& str) {
-  std::stringstream ssin(str);
-  std::vector<std::string> command_vec;
-
-  while (ssin.good() && !ssin.eof()) {
-    std::string token;
-    ssin >> token;
-
-    // Check for empty tokens
-    if (token.empty()) continue;
-
-    // Encode the token based on its type
-    command_vec.push_back(encode_token(token));
-  }
+  std::string out;
+  append_encoded(out, str);
+  return out;
+}
 
-  return encode_array(command_vec);
+/**
+ * @brief Split a line into the words append_encoded() would send.
+ *
+ * Unlike tokenize() this does not join quoted phrases, so `words[i]` is
+ * exactly the i-th element of the encoded command.
+ *
+ * @param input Input line.
+ * @param words Output views into `input`; cleared first.
+ */
+void split_words(std::string_view input, std::vector<std::string_view>& words) {
+  words.clear();
+  for_each_word(input, [&](std::string_view word) { words.push_back(word); });
 }
 
 /**
@@ -243,63 +618,32 @@ std::vector<std::string> tokenize(const std::string& input) {
 /**
  * @brief Encode a single token with the appropriate RESP data type.
  *
- * Attempts to detect the data type and encode accordingly.
- * Note: For command arguments, even numeric values must be sent as bulk strings
- * according to the RESP protocol specification for commands.
+ * Integers become `:` integers (falling back to a bulk string on overflow),
+ * "true"/"false" become `#t`/`#f`, `[a, b]` becomes an array of bulk
+ * strings and anything else a bulk string.
  *
  * @param token The token to encode
  * @return RESP-encoded string for the token
  */
 std::string encode_token(const std::string& token) {
-  // Try to detect the data type
-  if (is_integer(token)) {
-    try {
-      // Parse as integer for validation, but still encode as bulk string
-      // as required by RESP protocol for command arguments
-      int64_t num = std::stoll(token);
-      // Log for debugging (optional)
-      return encode_integer(num);  // Encode as integer
-    } catch (const std::exception& e) {
-      // Fallback to string if overflow occurs
-      return encode_bulk_string(token);
-    }
-  } else if (is_boolean(token)) {
-    return encode_boolean(token == "true");  // Encode as boolean
-  } else if (is_array(token)) {
-    // Parse the array and encode each element
-    auto elements = parse_array(token);
-    std::vector<std::string> encoded_elements;
-    for (const auto& elem : elements) {
-      encoded_elements.push_back(elem);
-    }
-    return encode_array(encoded_elements);  // Encode as array
-  } else {
-    // Default to string
-    return encode_bulk_string(token);
-  }
+  std::string out;
+  append_token(out, token);
+  return out;
 }
 
 /**
- * @brief Combine command and args, then call `encode_array`.
- *
- * Detects argument types and performs appropriate encoding for each.
+ * @brief Combine command and args, then encode them as bulk strings.
  *
  * @param cmd Command name (e.g., "SET")
  * @param args Vector of argument strings
  * @return RESP-encoded array command
  */
 std::string encode_command(const std::string& cmd, const std::vector<std::string>& args) {
-  std::vector<std::string> all_elements;
-  all_elements.push_back(cmd);
-
-  // Process each argument with type detection
-  for (const auto& arg : args) {
-    // For command arguments, we should always use bulk strings
-    // as required by the RESP protocol for command arguments
-    all_elements.push_back(arg);
-  }
-
-  return encode_array(all_elements);
+  std::string out;
+  append_array_header(out, args.size() + 1);
+  append_bulk_string(out, cmd);
+  for (const auto& arg : args) append_bulk_string(out, arg);
+  return out;
 }
 
 /**
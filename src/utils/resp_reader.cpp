@@ -0,0 +1,368 @@
+/**
+ * @file resp_reader.cpp
+ * @brief resp::Reader method implementations and in-memory frame helpers.
+ *
+ * The reader only finds frame boundaries; turning a frame into text is left
+ * to the decoder in resp_decoder.cpp.
+ */
+
+#include "include/resp_reader.hpp"
+
+#include <cstring>
+
+#include "include/resp_scan.hpp"
+
+namespace resp {
+
+/**
+ * @brief Locate the end of the header line at `line`.
+ *
+ * Aggregate and bulk headers (and plain integers) are parsed in the same
+ * pass; other lines are searched for CRLF with the vector kernel.
+ *
+ * @param line   Start of the line (the type byte).
+ * @param end    End of the buffered data.
+ * @param length Parsed length for `$ ! = * ~ > % |` lines.
+ * @param next   Position after the line's CRLF.
+ * @return COMPLETE, INCOMPLETE or PROTOCOL_ERROR.
+ */
+static Reader::Status scan_header(const char* line, const char* end, int64_t& length, const char*& next) {
+  switch (*line) {
+    case '$':
+    case '!':
+    case '=':
+    case '*':
+    case '~':
+    case '>':
+    case '%':
+    case '|':
+      switch (parse_length_line(line + 1, end, length, next)) {
+        case LineStatus::OK:
+          return Reader::Status::COMPLETE;
+        case LineStatus::INCOMPLETE:
+          return Reader::Status::INCOMPLETE;
+        default:
+          return Reader::Status::PROTOCOL_ERROR;
+      }
+    case ':': {
+      // Integers are almost always plain digits: reuse the fused parser.
+      LineStatus status = parse_length_line(line + 1, end, length, next);
+      if (status == LineStatus::OK) return Reader::Status::COMPLETE;
+      if (status == LineStatus::INCOMPLETE) return Reader::Status::INCOMPLETE;
+      [[fallthrough]];
+    }
+    default: {
+      const char* cr = find_crlf(line + 1, end);
+      if (cr == nullptr) return Reader::Status::INCOMPLETE;
+      next = cr + 2;
+      return Reader::Status::COMPLETE;
+    }
+  }
+}
+
+// Constructor
+Reader::Reader(size_t capacity)
+    : buffer(capacity > 0 ? capacity : 1), initialCapacity(capacity > 0 ? capacity : 1), head(0), tail(0), released(0), cursor(0), bodyEnd(0) {}
+
+/**
+ * @brief Drop the released frame and move unread bytes to the front.
+ *
+ * Views handed out by next() are invalidated. An oversized buffer is shrunk
+ * back to its initial capacity once it holds no data.
+ */
+void Reader::compact() {
+  head += released;
+  released = 0;
+
+  if (head == tail) {
+    head = tail = 0;
+    if (buffer.size() > 4 * initialCapacity && remaining.empty() && cursor == 0) {
+      buffer.resize(initialCapacity);
+    }
+    return;
+  }
+
+  if (head > 0) {
+    std::memmove(buffer.data(), buffer.data() + head, tail - head);
+    tail -= head;
+    head = 0;
+  }
+}
+
+/**
+ * @brief Reserve room for at least `n` more bytes.
+ *
+ * @param n Bytes the caller intends to write.
+ * @return Pointer to write to, followed by commit().
+ */
+char* Reader::prepare(size_t n) {
+  compact();
+
+  if (buffer.size() - tail < n) {
+    buffer.resize(std::max(buffer.size() * 2, tail + n));
+  }
+  return buffer.data() + tail;
+}
+
+/** @brief Mark `n` bytes written after prepare() as received. */
+void Reader::commit(size_t n) {
+  tail += n;
+}
+
+/** @brief Copy `n` bytes into the buffer. */
+void Reader::feed(const char* data, size_t n) {
+  std::memcpy(prepare(n), data, n);
+  commit(n);
+}
+
+/** @brief Bytes received but not yet returned as a frame. */
+size_t Reader::buffered() const {
+  return tail - head - released;
+}
+
+/** @brief Discard buffered data and parser state. */
+void Reader::reset() {
+  head = tail = released = cursor = bodyEnd = 0;
+  remaining.clear();
+}
+
+/**
+ * @brief Bytes received but not yet returned as a frame.
+ *
+ * Only meaningful between frames, i.e. when the last next() returned
+ * COMPLETE (or was never called). Lets a caller consume a reply itself,
+ * e.g. to stream a large bulk body somewhere else.
+ *
+ * @return View valid until the next call to prepare(), feed() or next().
+ */
+std::string_view Reader::peek() const {
+  return std::string_view(buffer.data() + head + released, tail - head - released);
+}
+
+/** @brief Consume `n` bytes returned by peek(). */
+void Reader::skip(size_t n) {
+  released += n;
+}
+
+/**
+ * @brief Account for one complete value in the enclosing aggregates.
+ *
+ * @return True if the value completed the whole frame.
+ */
+bool Reader::finishValue() {
+  while (!remaining.empty()) {
+    if (--remaining.back() > 0) return false;
+    remaining.pop_back();
+  }
+  return true;
+}
+
+/**
+ * @brief Advance the parser over newly received bytes.
+ *
+ * @param frame On COMPLETE, a view of the raw frame. It stays valid until
+ *              the next call to next(), prepare() or feed().
+ * @return COMPLETE, INCOMPLETE (read more and call again) or PROTOCOL_ERROR.
+ */
+Reader::Status Reader::next(std::string_view& frame) {
+  head += released;
+  released = 0;
+
+  const char* base = buffer.data() + head;
+  size_t size = tail - head;
+  bool done = false;
+
+  while (!done) {
+    // A bulk body of known length: wait until it and its CRLF are present.
+    if (bodyEnd > 0) {
+      if (size < bodyEnd) return Status::INCOMPLETE;
+      if (base[bodyEnd - 2] != '\r' || base[bodyEnd - 1] != '\n') return Status::PROTOCOL_ERROR;
+      cursor = bodyEnd;
+      bodyEnd = 0;
+      done = finishValue();
+      continue;
+    }
+
+    if (cursor >= size) return Status::INCOMPLETE;
+
+    const char* line = base + cursor;
+    const char* header_end = nullptr;
+    int64_t length = 0;
+    Status header = scan_header(line, base + size, length, header_end);
+    if (header != Status::COMPLETE) return header;
+
+    size_t next_value = static_cast<size_t>(header_end - base);
+
+    switch (*line) {
+      case '+':
+      case '-':
+      case ':':
+      case '#':
+      case ',':
+      case '(':
+      case '_':
+        cursor = next_value;
+        done = finishValue();
+        break;
+      case '$':
+      case '!':
+      case '=':
+        if (length > MAX_LENGTH) return Status::PROTOCOL_ERROR;
+        if (length < 0) {
+          cursor = next_value;  // null bulk string
+          done = finishValue();
+        } else {
+          bodyEnd = next_value + static_cast<size_t>(length) + 2;
+        }
+        break;
+      case '*':
+      case '~':
+      case '>':
+      case '%':
+      case '|':
+        if (length > MAX_LENGTH) return Status::PROTOCOL_ERROR;
+        if (*line == '%') length *= 2;  // key/value pairs
+        if (*line == '|') length = 2 * length + 1;  // pairs, then the annotated value
+        cursor = next_value;
+        if (length <= 0) {
+          done = finishValue();
+        } else {
+          remaining.push_back(length);
+        }
+        break;
+      default:
+        return Status::PROTOCOL_ERROR;
+    }
+  }
+
+  frame = std::string_view(base, cursor);
+  released = cursor;
+  cursor = 0;
+  return Status::COMPLETE;
+}
+
+/**
+ * @brief Measure the first complete frame of an in-memory RESP stream.
+ *
+ * @param data   Bytes starting at a frame boundary.
+ * @param length On COMPLETE, the frame length in bytes.
+ * @return COMPLETE, INCOMPLETE or PROTOCOL_ERROR.
+ */
+Reader::Status scan_frame(std::string_view data, size_t& length) {
+  const char* base = data.data();
+  size_t size = data.size();
+  size_t cursor = 0;
+  std::vector<int64_t> remaining;
+
+  // Same bookkeeping as Reader::finishValue().
+  auto finish_value = [&remaining] {
+    while (!remaining.empty()) {
+      if (--remaining.back() > 0) return false;
+      remaining.pop_back();
+    }
+    return true;
+  };
+
+  bool done = false;
+  while (!done) {
+    if (cursor >= size) return Reader::Status::INCOMPLETE;
+
+    const char* line = base + cursor;
+    const char* header_end = nullptr;
+    int64_t value_length = 0;
+    Reader::Status header = scan_header(line, base + size, value_length, header_end);
+    if (header != Reader::Status::COMPLETE) return header;
+
+    size_t next_value = static_cast<size_t>(header_end - base);
+
+    switch (*line) {
+      case '+':
+      case '-':
+      case ':':
+      case '#':
+      case ',':
+      case '(':
+      case '_':
+        cursor = next_value;
+        done = finish_value();
+        break;
+      case '$':
+      case '!':
+      case '=':
+        if (value_length > MAX_LENGTH) return Reader::Status::PROTOCOL_ERROR;
+        cursor = next_value;
+        if (value_length >= 0) {
+          cursor += static_cast<size_t>(value_length) + 2;
+          if (cursor > size) return Reader::Status::INCOMPLETE;
+          if (base[cursor - 2] != '\r' || base[cursor - 1] != '\n') return Reader::Status::PROTOCOL_ERROR;
+        }
+        done = finish_value();
+        break;
+      case '*':
+      case '~':
+      case '>':
+      case '%':
+      case '|':
+        if (value_length > MAX_LENGTH) return Reader::Status::PROTOCOL_ERROR;
+        if (*line == '%') value_length *= 2;  // key/value pairs
+        if (*line == '|') value_length = 2 * value_length + 1;  // pairs, then the annotated value
+        cursor = next_value;
+        if (value_length <= 0) {
+          done = finish_value();
+        } else {
+          remaining.push_back(value_length);
+        }
+        break;
+      default:
+        return Reader::Status::PROTOCOL_ERROR;
+    }
+  }
+
+  length = cursor;
+  return Reader::Status::COMPLETE;
+}
+
+/**
+ * @brief Payload of a `$` bulk string frame.
+ *
+ * @param frame   One complete frame.
+ * @param payload Output view into `frame`.
+ * @return False for anything else, including a null bulk string.
+ */
+bool read_bulk(std::string_view frame, std::string_view& payload) {
+  int64_t length = 0;
+  const char* next = nullptr;
+  if (frame.size() < 2 || frame[0] != '$' || parse_length_line(frame.data() + 1, frame.data() + frame.size(), length, next) != LineStatus::OK ||
+      length < 0 || static_cast<size_t>(next - frame.data()) + static_cast<size_t>(length) > frame.size()) {
+    return false;
+  }
+  payload = std::string_view(next, static_cast<size_t>(length));
+  return true;
+}
+
+/**
+ * @brief Split a `*` array frame into its raw element frames.
+ *
+ * @param frame    One complete frame.
+ * @param elements Output views into `frame`; cleared first.
+ * @return False if `frame` is not an array or an element is incomplete.
+ */
+bool read_array(std::string_view frame, std::vector<std::string_view>& elements) {
+  elements.clear();
+  int64_t count = 0;
+  const char* next = nullptr;
+  if (frame.size() < 2 || frame[0] != '*' || parse_length_line(frame.data() + 1, frame.data() + frame.size(), count, next) != LineStatus::OK) {
+    return false;
+  }
+
+  size_t pos = static_cast<size_t>(next - frame.data());
+  for (int64_t i = 0; i < count; ++i) {
+    size_t length = 0;
+    if (scan_frame(frame.substr(pos), length) != Reader::Status::COMPLETE) return false;
+    elements.push_back(frame.substr(pos, length));
+    pos += length;
+  }
+  return true;
+}
+
+}  // namespace resp
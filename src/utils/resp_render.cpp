@@ -0,0 +1,426 @@
+/**
+ * @file resp_render.cpp
+ * @brief OutputSink and Renderer implementations.
+ *
+ * The renderer walks replies with resp::visit() and produces the human
+ * format of resp_decoder.cpp, extended to every RESP3 type, plus raw, CSV
+ * and JSON, without building a string per reply.
+ */
+
+#include "include/render.hpp"
+
+#include <cerrno>
+#include <cmath>
+
+#include "include/logger.hpp"
+#include "include/resp_visit.hpp"
+
+namespace resp {
+
+namespace {
+
+/**
+ * @class StringOut
+ * @brief Minimal sink appending to a std::string, for format_reply().
+ */
+class StringOut {
+ private:
+  std::string& text;
+
+ public:
+  explicit StringOut(std::string& text) : text(text) {}
+  void write(std::string_view data) { text.append(data); }
+  void put(char c) { text.push_back(c); }
+};
+
+/** @brief What an empty reply prints as. */
+std::string_view empty_reply(Format format) {
+  return format == Format::HUMAN ? "(null)" : format == Format::JSON ? "null" : format == Format::CSV ? "NULL" : "";
+}
+
+/**
+ * @brief Write a string value, quoted and escaped as the format needs.
+ *
+ * CSV doubles embedded quotes. JSON escapes quotes, backslashes and
+ * control characters; other bytes are passed through, so UTF-8 stays
+ * intact. HUMAN and RAW write the bytes unchanged.
+ */
+template <typename Out>
+void write_text(Out& out, Format format, std::string_view data) {
+  if (format == Format::CSV) {
+    out.put('"');
+    size_t quote;
+    while ((quote = data.find('"')) != std::string_view::npos) {
+      out.write(data.substr(0, quote + 1));
+      out.put('"');
+      data.remove_prefix(quote + 1);
+    }
+    out.write(data);
+    out.put('"');
+    return;
+  }
+
+  if (format != Format::JSON) {
+    out.write(data);
+    return;
+  }
+
+  static const char HEX[] = "0123456789abcdef";
+  out.put('"');
+  size_t run = 0;  // start of the bytes not yet written
+  for (size_t i = 0; i < data.size(); ++i) {
+    unsigned char c = static_cast<unsigned char>(data[i]);
+    if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+    out.write(data.substr(run, i - run));
+    run = i + 1;
+    out.put('\\');
+    switch (c) {
+      case '"':
+      case '\\':
+        out.put(static_cast<char>(c));
+        break;
+      case '\n':
+        out.put('n');
+        break;
+      case '\r':
+        out.put('r');
+        break;
+      case '\t':
+        out.put('t');
+        break;
+      default:
+        out.write("u00");
+        out.put(HEX[c >> 4]);
+        out.put(HEX[c & 0xf]);
+        break;
+    }
+  }
+  out.write(data.substr(run));
+  out.put('"');
+}
+
+/**
+ * @class Formatter
+ * @brief Visitor that writes each value as it is reported.
+ *
+ * HUMAN prints the type before a top-level value and quotes nested
+ * strings. CSV puts every scalar, at any depth, on the reply's one line.
+ * RAW ends every scalar with a newline. Attributes are skipped. The
+ * format is a template parameter so its branches fold away per value.
+ */
+template <typename Out, Format format>
+class Formatter : public Visitor {
+ private:
+  /** @brief An aggregate being printed. */
+  struct Level {
+    Type type;
+    int64_t index; /**< Values printed so far */
+  };
+
+  Out& out;
+  Level levels[MAX_VISIT_DEPTH + 1]; /**< +1: an empty aggregate opens past the deepest full one */
+  int depth;
+  int skipping; /**< Depth inside attributes (and JSON aggregate keys), which print nothing */
+  bool first;   /**< CSV: no separator before the next value */
+
+  /**
+   * @brief Write the separator that goes before the next value.
+   *
+   * @return True if the value is a MAP key.
+   */
+  bool next() {
+    if (depth == 0) return false;
+    Level& level = levels[depth - 1];
+    bool key = level.type == Type::MAP && level.index % 2 == 0;
+    bool value = level.type == Type::MAP && !key;
+    if (level.index++ > 0) {
+      if (format == Format::HUMAN) out.write(value ? ": " : ", ");
+      if (format == Format::JSON) out.put(value ? ':' : ',');
+    }
+    return key;
+  }
+
+  /** @brief CSV: comma before every scalar but the first. */
+  void cell() {
+    if (format != Format::CSV) return;
+    if (!first) out.put(',');
+    first = false;
+  }
+
+  /** @brief Start a scalar. */
+  bool scalar() {
+    bool key = next();
+    cell();
+    return key;
+  }
+
+  /** @brief Finish a scalar. */
+  void done() {
+    if (format == Format::RAW) out.put('\n');
+  }
+
+  /** @brief `(type) ` label of a top-level HUMAN value. */
+  void label(const char* name) {
+    if (format == Format::HUMAN && depth == 0) out.write(name);
+  }
+
+  /** @brief Write bare text; JSON keys must be strings, so quote it there. */
+  void bare(std::string_view text, bool key) {
+    if (format == Format::JSON && key) {
+      write_text(out, format, text);
+    } else {
+      out.write(text);
+    }
+  }
+
+ public:
+  explicit Formatter(Out& out) : out(out), depth(0), skipping(0), first(true) {}
+
+  void onString(Type type, std::string_view value) {
+    if (skipping > 0) return;
+    bool key = scalar();
+    bool error = type == Type::ERROR || type == Type::BULK_ERROR;
+
+    if (format == Format::HUMAN) {
+      if (error) {
+        out.write("(error) ");
+        out.write(value);
+      } else if (depth == 0) {
+        out.write(type == Type::VERBATIM ? "(verbatim) " : type == Type::BIG_NUMBER ? "(bignum) " : "(string) ");
+        out.write(value);
+      } else if (type == Type::BIG_NUMBER) {
+        out.write(value);
+      } else {
+        out.put('"');
+        out.write(value);
+        out.put('"');
+      }
+    } else if (format == Format::RAW) {
+      out.write(value);
+    } else if (error && !key) {
+      out.write(format == Format::JSON ? "{\"error\":" : "ERROR,");
+      write_text(out, format, value);
+      if (format == Format::JSON) out.put('}');
+    } else if (type == Type::BIG_NUMBER) {
+      bare(value, key);
+    } else {
+      write_text(out, format, value);
+    }
+    done();
+  }
+
+  void onInteger(int64_t, std::string_view text) {
+    if (skipping > 0) return;
+    bool key = scalar();
+    label("(integer) ");
+    bare(text, key);
+    done();
+  }
+
+  void onDouble(double value, std::string_view text) {
+    if (skipping > 0) return;
+    bool key = scalar();
+    label("(double) ");
+    // JSON has no inf or nan
+    bare(text, key || (format == Format::JSON && !std::isfinite(value)));
+    done();
+  }
+
+  void onBoolean(bool value) {
+    if (skipping > 0) return;
+    bool key = scalar();
+    label("(boolean) ");
+    bare(value ? "true" : "false", key);
+    done();
+  }
+
+  void onNull(Type type) {
+    if (skipping > 0) return;
+    bool key = scalar();
+    if (format == Format::HUMAN) {
+      out.write(depth > 0 ? "null" : type == Type::BULK_STRING ? "(string) null" : type == Type::ARRAY ? "(array) null" : "(nil)");
+    } else if (format == Format::JSON) {
+      out.write(key ? "\"null\"" : "null");
+    } else if (format == Format::CSV) {
+      out.write("NULL");
+    }
+    done();
+  }
+
+  void onBegin(Type type, int64_t) {
+    if (skipping > 0 || type == Type::ATTRIBUTE) {
+      ++skipping;
+      return;
+    }
+    if (next() && format == Format::JSON) {
+      out.write("\"(aggregate)\"");  // a JSON key cannot be an array or object
+      ++skipping;
+      return;
+    }
+
+    if (format == Format::HUMAN && depth == 0) {
+      out.write(type == Type::MAP ? "(map) " : type == Type::SET ? "(set) " : type == Type::PUSH ? "(push) " : "(array) ");
+    }
+    if (format == Format::HUMAN || format == Format::JSON) out.put(type == Type::MAP ? '{' : '[');
+    levels[depth++] = {type, 0};
+  }
+
+  void onEnd(Type type) {
+    if (skipping > 0) {
+      --skipping;
+      return;
+    }
+    --depth;
+    if (format == Format::HUMAN || format == Format::JSON) out.put(type == Type::MAP ? '}' : ']');
+  }
+
+  /**
+   * @brief Format one reply.
+   *
+   * A malformed or truncated reply prints what was valid, a placeholder,
+   * and closes the aggregates still open.
+   */
+  void run(std::string_view reply) {
+    size_t length = 0;
+    if (visit(reply, *this, length) == Reader::Status::COMPLETE) return;
+
+    if (skipping == 0) {
+      scalar();
+      out.write(format == Format::JSON ? "null" : format == Format::CSV ? "NULL" : "(invalid input)");
+      done();
+    }
+    while (depth > 0) {
+      skipping = 0;
+      onEnd(levels[depth - 1].type);
+    }
+  }
+};
+
+/** @brief Format one reply with the Formatter for `format`. */
+template <typename Out>
+void run(Out& out, Format format, std::string_view reply) {
+  switch (format) {
+    case Format::HUMAN:
+      Formatter<Out, Format::HUMAN>(out).run(reply);
+      break;
+    case Format::RAW:
+      Formatter<Out, Format::RAW>(out).run(reply);
+      break;
+    case Format::CSV:
+      Formatter<Out, Format::CSV>(out).run(reply);
+      break;
+    case Format::JSON:
+      Formatter<Out, Format::JSON>(out).run(reply);
+      break;
+  }
+}
+
+}  // namespace
+
+/**
+ * @brief Parses a format name (human, raw, csv or json).
+ *
+ * @param name   Format name.
+ * @param format Output; set on success.
+ * @return False if the name is unknown.
+ */
+bool parse_format(std::string_view name, Format& format) {
+  if (name == "human") {
+    format = Format::HUMAN;
+  } else if (name == "raw") {
+    format = Format::RAW;
+  } else if (name == "csv") {
+    format = Format::CSV;
+  } else if (name == "json") {
+    format = Format::JSON;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// --------------------------------------------------
+// @INFO OutputSink
+// --------------------------------------------------
+
+// Constructor
+OutputSink::OutputSink(int fd, size_t capacity)
+    : fd(fd), buf(new char[capacity > 0 ? capacity : 1]), used(0), capacity(capacity > 0 ? capacity : 1), failed(false) {}
+
+// Destructor
+OutputSink::~OutputSink() {
+  flush();
+}
+
+/**
+ * @brief Write out the buffered bytes.
+ *
+ * @return False if this or an earlier write failed.
+ */
+bool OutputSink::flush() {
+  if (used > 0) {
+    writeAll(std::string_view(buf.get(), used));
+    used = 0;
+  }
+  return !failed;
+}
+
+/**
+ * @brief write(2) until everything is out, retrying on EINTR and short writes.
+ *
+ * Log lines queued before this output are written first.
+ */
+void OutputSink::writeAll(std::string_view data) {
+  Logger::flush();
+  while (!failed && !data.empty()) {
+    ssize_t written = ::write(fd, data.data(), data.size());
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      failed = true;  // e.g. the reader of a pipe went away
+      return;
+    }
+    data.remove_prefix(static_cast<size_t>(written));
+  }
+}
+
+// --------------------------------------------------
+// @INFO Renderer
+// --------------------------------------------------
+
+// Constructor
+Renderer::Renderer(OutputSink& out, Format format) : out(out), format(format) {}
+
+/**
+ * @brief Print one reply followed by a newline.
+ *
+ * @param reply Raw, frame-complete RESP reply.
+ */
+void Renderer::render(std::string_view reply) {
+  if (reply.empty()) {
+    out.write(empty_reply(format));
+    out.put('\n');
+    return;
+  }
+
+  run<OutputSink>(out, format, reply);
+  if (format != Format::RAW) out.put('\n');
+}
+
+/**
+ * @brief Format one reply into a string, without a trailing newline.
+ *
+ * @param reply  Raw RESP reply.
+ * @param format Output format.
+ * @return The formatted reply.
+ */
+std::string format_reply(std::string_view reply, Format format) {
+  if (reply.empty()) return std::string(empty_reply(format));
+
+  std::string text;
+  StringOut out(text);
+  run<StringOut>(out, format, reply);
+  return text;
+}
+
+}  // namespace resp
@@ -0,0 +1,160 @@
+/**
+ * @file resp_scan.cpp
+ * @brief CRLF search kernels with runtime dispatch and fused length parsing.
+ *
+ * The vector kernels compare 64-byte blocks against '\r' and only look at
+ * the following byte for the (rare) CR hits. Tails shorter than a block, and
+ * anything past VECTOR_SPAN, go to the scalar kernel.
+ */
+
+#include "include/resp_scan.hpp"
+
+#include <cstddef>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RESP_SCAN_X86 1
+#endif
+
+namespace resp {
+
+namespace {
+
+/** @brief Portable kernel: memchr for '\r', then check the following byte. */
+const char* find_crlf_scalar(const char* first, const char* last) {
+  while (first < last) {
+    const char* cr = static_cast<const char*>(std::memchr(first, '\r', static_cast<size_t>(last - first)));
+    if (cr == nullptr || cr + 1 >= last) return nullptr;
+    if (cr[1] == '\n') return cr;
+    first = cr + 1;
+  }
+  return nullptr;
+}
+
+#ifdef RESP_SCAN_X86
+
+/**
+ * @brief Bytes the vector kernels scan before handing over to memchr.
+ *
+ * RESP lines are short, and there the inline kernels beat a libc call.
+ * Past this point glibc's memchr, with aligned and wider loads, is faster.
+ */
+constexpr ptrdiff_t VECTOR_SPAN = 256;
+
+/**
+ * @brief Resolve a 64-bit mask of '\r' positions starting at `block`.
+ *
+ * @return The first CR of the mask that is followed by LF, or nullptr.
+ */
+inline const char* first_crlf_in(const char* block, uint64_t mask, const char* last) {
+  while (mask != 0) {
+    const char* cr = block + __builtin_ctzll(mask);
+    if (cr + 1 < last && cr[1] == '\n') return cr;
+    mask &= mask - 1;
+  }
+  return nullptr;
+}
+
+const char* find_crlf_sse2(const char* first, const char* last) {
+  const __m128i cr = _mm_set1_epi8('\r');
+  const char* stop = last - first > VECTOR_SPAN ? first + VECTOR_SPAN : last;
+
+  while (stop - first >= 64) {
+    uint64_t mask = 0;
+    for (int lane = 0; lane < 4; ++lane) {
+      __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + 16 * lane));
+      mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, cr)))) << (16 * lane);
+    }
+    if (mask != 0) {
+      const char* found = first_crlf_in(first, mask, last);
+      if (found != nullptr) return found;
+    }
+    first += 64;
+  }
+  return find_crlf_scalar(first, last);
+}
+
+__attribute__((target("avx2"))) const char* find_crlf_avx2(const char* first, const char* last) {
+  const __m256i cr = _mm256_set1_epi8('\r');
+  const char* stop = last - first > VECTOR_SPAN ? first + VECTOR_SPAN : last;
+
+  while (stop - first >= 64) {
+    __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+    __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + 32));
+    uint64_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, cr))) |
+                    static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, cr)))) << 32;
+    if (mask != 0) {
+      const char* found = first_crlf_in(first, mask, last);
+      if (found != nullptr) return found;
+    }
+    first += 64;
+  }
+  return find_crlf_scalar(first, last);
+}
+
+#endif
+
+using CrlfKernel = const char* (*)(const char*, const char*);
+
+/** @brief Pick the widest kernel this CPU supports. */
+CrlfKernel select_kernel(const char*& name) {
+#ifdef RESP_SCAN_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    name = "avx2";
+    return find_crlf_avx2;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    name = "sse2";
+    return find_crlf_sse2;
+  }
+#endif
+  name = "scalar";
+  return find_crlf_scalar;
+}
+
+const char* g_kernel_name = "scalar";
+
+/** @brief Resolved once at load time; calls never pay for a guard. */
+const CrlfKernel g_kernel = select_kernel(g_kernel_name);
+
+constexpr int MAX_DIGITS = 18;  // always fits in int64_t
+
+}  // namespace
+
+const char* find_crlf(const char* first, const char* last) {
+  return g_kernel(first, last);
+}
+
+const char* scan_kernel() {
+  return g_kernel_name;
+}
+
+LineStatus parse_length_line(const char* first, const char* last, int64_t& value, const char*& next) {
+  const char* pos = first;
+  bool negative = pos < last && *pos == '-';
+  if (negative) ++pos;
+
+  const char* digits_start = pos;
+  uint64_t result = 0;
+
+  // Lengths are short, so a fused loop that stops at the first non-digit
+  // beats both a CRLF search followed by a parse and 8-byte SWAR parsing.
+  while (pos < last && *pos >= '0' && *pos <= '9') {
+    if (pos - digits_start >= MAX_DIGITS) return LineStatus::MALFORMED;
+    result = result * 10 + static_cast<uint64_t>(*pos - '0');
+    ++pos;
+  }
+
+  if (pos >= last) return LineStatus::INCOMPLETE;
+  if (pos == digits_start || *pos != '\r') return LineStatus::MALFORMED;
+  if (pos + 1 >= last) return LineStatus::INCOMPLETE;
+  if (pos[1] != '\n') return LineStatus::MALFORMED;
+
+  value = negative ? -static_cast<int64_t>(result) : static_cast<int64_t>(result);
+  next = pos + 2;
+  return LineStatus::OK;
+}
+
+}  // namespace resp
@@ -0,0 +1,233 @@
+/**
+ * @file resp_tree.cpp
+ * @brief Arena, Node and Document implementations.
+ */
+
+#include "include/resp_tree.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace resp {
+
+// --------------------------------------------------
+// @INFO Arena
+// --------------------------------------------------
+
+// Constructor
+Arena::Arena(size_t blockSize) : blockSize(blockSize > 0 ? blockSize : 1), current(0), offset(0) {}
+
+/**
+ * @brief Carve `bytes` aligned to `align` out of the current block.
+ *
+ * Moves on to the next kept block, or allocates a new one, when the
+ * current block is full. Requests larger than blockSize get a block of
+ * their own size.
+ *
+ * @return Uninitialized memory valid until reset().
+ */
+void* Arena::allocate(size_t bytes, size_t align) {
+  while (current < blocks.size()) {
+    uintptr_t base = reinterpret_cast<uintptr_t>(blocks[current].get());
+    size_t start = ((base + offset + align - 1) & ~(uintptr_t)(align - 1)) - base;
+    if (start + bytes <= sizes[current]) {
+      offset = start + bytes;
+      return blocks[current].get() + start;
+    }
+    ++current;
+    offset = 0;
+  }
+
+  // new[] memory is aligned for any fundamental type
+  size_t size = std::max(blockSize, bytes);
+  blocks.emplace_back(new char[size]);
+  sizes.push_back(size);
+  current = blocks.size() - 1;
+  offset = bytes;
+  return blocks.back().get();
+}
+
+/** @brief Forget every allocation; the blocks are kept for reuse. */
+void Arena::reset() {
+  current = 0;
+  offset = 0;
+}
+
+/** @brief Total bytes held in blocks. */
+size_t Arena::capacity() const {
+  size_t total = 0;
+  for (size_t size : sizes) total += size;
+  return total;
+}
+
+// --------------------------------------------------
+// @INFO Node
+// --------------------------------------------------
+
+/**
+ * @brief Linear lookup of a string key in a MAP.
+ *
+ * @param key Key to find.
+ * @return The value, or null if this is not a MAP or the key is absent.
+ */
+const Node* Node::find(std::string_view key) const {
+  if (type != Type::MAP) return nullptr;
+  for (uint32_t i = 0; i + 1 < count; i += 2) {
+    const Node& candidate = children[i];
+    if ((candidate.type == Type::BULK_STRING || candidate.type == Type::SIMPLE_STRING || candidate.type == Type::VERBATIM) && candidate.text == key) {
+      return &children[i + 1];
+    }
+  }
+  return nullptr;
+}
+
+// --------------------------------------------------
+// @INFO Document
+// --------------------------------------------------
+
+namespace {
+
+/**
+ * @brief Visitor that fills Nodes in place.
+ *
+ * Each aggregate's children are allocated in one piece when it opens, so
+ * the arena is touched once per aggregate, not once per value. The counts
+ * in aggregate headers are checked against the reply size first: every
+ * value takes at least 3 bytes, so a header promising more elements than
+ * the remaining bytes can hold is incomplete or bogus, and building stops
+ * there instead of allocating for it.
+ */
+class TreeBuilder : public Visitor {
+ private:
+  /** @brief An aggregate being filled. */
+  struct Level {
+    Node* children;
+    uint32_t next;
+  };
+
+  Arena& arena;
+  Node& root;
+  Level levels[MAX_VISIT_DEPTH + 1]; /**< +1: an empty aggregate opens past the deepest full one */
+  int depth;
+  int skipping;  /**< Depth inside attributes, which are dropped */
+  size_t budget; /**< Children the rest of the reply can still hold */
+
+  /** @brief The node the next value goes into. */
+  Node& slot() { return depth == 0 ? root : levels[depth - 1].children[levels[depth - 1].next++]; }
+
+  /** @brief Start a leaf node. */
+  Node& leaf(Type type) {
+    Node& node = slot();
+    node.type = type;
+    node.boolean = false;
+    node.count = 0;
+    node.integer = 0;
+    node.number = 0;
+    node.text = std::string_view();
+    node.children = nullptr;
+    return node;
+  }
+
+ public:
+  bool tooLarge; /**< An aggregate announced more elements than fit; nothing more is built */
+
+  /** @brief Smallest encoding of any value (`_\r\n`). */
+  static constexpr size_t MIN_VALUE_BYTES = 3;
+
+  TreeBuilder(Arena& arena, Node& root, size_t replyBytes)
+      : arena(arena), root(root), depth(0), skipping(0), budget(replyBytes / MIN_VALUE_BYTES), tooLarge(false) {}
+
+  void onString(Type type, std::string_view value) {
+    if (skipping > 0) return;
+    leaf(type).text = value;
+  }
+
+  void onInteger(int64_t value, std::string_view text) {
+    if (skipping > 0) return;
+    Node& node = leaf(Type::INTEGER);
+    node.integer = value;
+    node.text = text;
+  }
+
+  void onDouble(double value, std::string_view text) {
+    if (skipping > 0) return;
+    Node& node = leaf(Type::DOUBLE);
+    node.number = value;
+    node.text = text;
+  }
+
+  void onBoolean(bool value) {
+    if (skipping > 0) return;
+    leaf(Type::BOOLEAN).boolean = value;
+  }
+
+  void onNull(Type) {
+    if (skipping > 0) return;
+    leaf(Type::NIL);
+  }
+
+  void onBegin(Type type, int64_t count) {
+    if (skipping > 0 || type == Type::ATTRIBUTE) {
+      ++skipping;
+      return;
+    }
+
+    int64_t elements = count > static_cast<int64_t>(UINT32_MAX) ? count : type == Type::MAP ? 2 * count : count;
+    if (elements > static_cast<int64_t>(UINT32_MAX) || static_cast<uint64_t>(elements) > budget) {
+      tooLarge = true;
+      return;
+    }
+    budget -= static_cast<size_t>(elements);
+    Node* children = elements > 0 ? arena.allocate<Node>(static_cast<size_t>(elements)) : nullptr;
+    Node& node = leaf(type);
+    node.count = static_cast<uint32_t>(elements);
+    node.children = children;
+    levels[depth++] = {children, 0};
+  }
+
+  void onEnd(Type) {
+    if (skipping > 0) {
+      --skipping;
+      return;
+    }
+    --depth;
+  }
+
+  /** @brief Ends the walk once an aggregate was refused. */
+  bool stopped() const { return tooLarge; }
+};
+
+}  // namespace
+
+// Constructor
+Document::Document(size_t blockSize) : arena(blockSize) {
+  top.type = Type::NIL;
+  top.boolean = false;
+  top.count = 0;
+  top.integer = 0;
+  top.number = 0;
+  top.children = nullptr;
+}
+
+/**
+ * @brief Parse one reply into the tree, replacing the previous one.
+ *
+ * @param reply Raw reply; must outlive the tree.
+ * @return COMPLETE, INCOMPLETE or PROTOCOL_ERROR. root() is only
+ *         meaningful after COMPLETE.
+ */
+Reader::Status Document::parse(std::string_view reply) {
+  arena.reset();
+  TreeBuilder builder(arena, top, reply.size());
+  size_t length = 0;
+  Reader::Status status = visit(reply, builder, length);
+  if (builder.tooLarge) {
+    // The walk stopped at the refused header; the scanner tells a
+    // truncated reply from a bogus one without building anything.
+    status = scan_frame(reply, length);
+    return status == Reader::Status::COMPLETE ? Reader::Status::PROTOCOL_ERROR : status;
+  }
+  return status;
+}
+
+}  // namespace resp
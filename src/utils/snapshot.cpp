@@ -0,0 +1,387 @@
+/**
+ * @file snapshot.cpp
+ * @brief CRC-32C kernels, KvSnapshotWriter and KvSnapshotReader method implementations.
+ */
+
+#include "include/snapshot.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include "include/logger.hpp"
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#define SNAPSHOT_CRC_X86 1
+#endif
+
+namespace {
+
+/** @brief Slicing-by-8 tables for the reflected Castagnoli polynomial. */
+using CrcTables = std::array<std::array<uint32_t, 256>, 8>;
+
+CrcTables make_tables() {
+  CrcTables tables{};
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; ++bit) crc = (crc >> 1) ^ (0x82f63b78U & (0U - (crc & 1U)));
+    tables[0][i] = crc;
+  }
+  for (uint32_t i = 0; i < 256; ++i) {
+    for (size_t t = 1; t < 8; ++t) tables[t][i] = (tables[t - 1][i] >> 8) ^ tables[0][tables[t - 1][i] & 0xff];
+  }
+  return tables;
+}
+
+const CrcTables g_tables = make_tables();
+
+/** @brief Portable kernel: eight bytes per step through the tables. */
+uint32_t crc32c_table(const unsigned char* p, size_t size, uint32_t crc) {
+  while (size >= 8) {
+    uint64_t word;
+    std::memcpy(&word, p, 8);
+    word ^= crc;  // little-endian: the CRC folds into the low bytes
+    crc = g_tables[7][word & 0xff] ^ g_tables[6][(word >> 8) & 0xff] ^ g_tables[5][(word >> 16) & 0xff] ^ g_tables[4][(word >> 24) & 0xff] ^
+          g_tables[3][(word >> 32) & 0xff] ^ g_tables[2][(word >> 40) & 0xff] ^ g_tables[1][(word >> 48) & 0xff] ^ g_tables[0][word >> 56];
+    p += 8;
+    size -= 8;
+  }
+  while (size-- > 0) crc = (crc >> 8) ^ g_tables[0][(crc ^ *p++) & 0xff];
+  return crc;
+}
+
+#ifdef SNAPSHOT_CRC_X86
+
+__attribute__((target("sse4.2"))) uint32_t crc32c_sse42(const unsigned char* p, size_t size, uint32_t crc) {
+  uint64_t wide = crc;
+  while (size >= 8) {
+    uint64_t word;
+    std::memcpy(&word, p, 8);
+    wide = _mm_crc32_u64(wide, word);
+    p += 8;
+    size -= 8;
+  }
+  crc = static_cast<uint32_t>(wide);
+  while (size-- > 0) crc = _mm_crc32_u8(crc, *p++);
+  return crc;
+}
+
+#endif
+
+using CrcKernel = uint32_t (*)(const unsigned char*, size_t, uint32_t);
+
+/** @brief Use the crc32 instruction when this CPU has it. */
+CrcKernel select_kernel() {
+#ifdef SNAPSHOT_CRC_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse4.2")) return crc32c_sse42;
+#endif
+  return crc32c_table;
+}
+
+/** @brief Resolved once at load time. */
+const CrcKernel g_kernel = select_kernel();
+
+void put_u32(char* out, uint32_t value) {
+  for (int i = 0; i < 4; ++i) out[i] = static_cast<char>(value >> (8 * i));
+}
+
+void put_u64(char* out, uint64_t value) {
+  for (int i = 0; i < 8; ++i) out[i] = static_cast<char>(value >> (8 * i));
+}
+
+uint32_t get_u32(const char* in) {
+  uint32_t value = 0;
+  for (int i = 0; i < 4; ++i) value |= static_cast<uint32_t>(static_cast<unsigned char>(in[i])) << (8 * i);
+  return value;
+}
+
+uint64_t get_u64(const char* in) {
+  uint64_t value = 0;
+  for (int i = 0; i < 8; ++i) value |= static_cast<uint64_t>(static_cast<unsigned char>(in[i])) << (8 * i);
+  return value;
+}
+
+}  // namespace
+
+namespace snapshot {
+
+uint32_t crc32c(const void* data, size_t size, uint32_t crc) {
+  return ~g_kernel(static_cast<const unsigned char*>(data), size, ~crc);
+}
+
+bool is_snapshot(std::string_view data) {
+  return data.substr(0, MAGIC.size()) == MAGIC;
+}
+
+}  // namespace snapshot
+
+// ---------------------------------------------------
+// @INFO KvSnapshotWriter
+// ---------------------------------------------------
+
+// Constructor
+KvSnapshotWriter::KvSnapshotWriter() : fd(-1), offset(0), recordCount(0) {}
+
+// Destructor
+KvSnapshotWriter::~KvSnapshotWriter() {
+  abort();
+}
+
+/** @brief Write all of `data`, retrying short writes. */
+bool KvSnapshotWriter::writeAll(const char* data, size_t size) {
+  while (size > 0) {
+    ssize_t n = ::write(fd, data, size);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      Logger::error("Cannot write " + tempPath + ": " + strerror(errno));
+      return false;
+    }
+    data += n;
+    size -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+/**
+ * @brief Create `path`.tmp and write the header.
+ *
+ * @param path Final snapshot path.
+ * @return False (after logging) if the file cannot be created.
+ */
+bool KvSnapshotWriter::open(const std::string& path) {
+  abort();
+  this->path = path;
+  tempPath = path + ".tmp";
+
+  fd = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    Logger::error("Cannot create " + tempPath + ": " + strerror(errno));
+    return false;
+  }
+
+  offset = 0;
+  recordCount = 0;
+  index.clear();
+  if (!writeAll(snapshot::MAGIC.data(), snapshot::MAGIC.size())) return false;
+  offset = snapshot::MAGIC.size();
+  return true;
+}
+
+/**
+ * @brief Append a finished block; safe to call from several threads.
+ *
+ * The checksum is computed before the lock is taken.
+ *
+ * @param block   Records built with appendRecord().
+ * @param records Number of records in `block`.
+ * @return False if the write failed.
+ */
+bool KvSnapshotWriter::writeBlock(std::string_view block, uint32_t records) {
+  if (records == 0) return true;
+  uint32_t crc = snapshot::crc32c(block.data(), block.size());
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (fd < 0 || !writeAll(block.data(), block.size())) return false;
+  index.push_back({offset, block.size(), records, crc});
+  offset += block.size();
+  recordCount += records;
+  return true;
+}
+
+/**
+ * @brief Write the index and trailer, sync, and move the file into place.
+ *
+ * @return False (after logging) if any step failed; the file is removed.
+ */
+bool KvSnapshotWriter::finish() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (fd < 0) return false;
+
+  std::string tail(index.size() * snapshot::INDEX_ENTRY_SIZE + snapshot::TRAILER_SIZE, '\0');
+  char* out = tail.data();
+  for (const Block& block : index) {
+    put_u64(out, block.offset);
+    put_u64(out + 8, block.length);
+    put_u32(out + 16, block.records);
+    put_u32(out + 20, block.crc);
+    out += snapshot::INDEX_ENTRY_SIZE;
+  }
+
+  size_t index_size = index.size() * snapshot::INDEX_ENTRY_SIZE;
+  put_u64(out, offset);
+  put_u64(out + 8, recordCount);
+  put_u32(out + 16, static_cast<uint32_t>(index.size()));
+  put_u32(out + 20, snapshot::crc32c(tail.data(), index_size));
+  std::memcpy(out + 24, snapshot::TRAILER_MAGIC.data(), snapshot::TRAILER_MAGIC.size());
+
+  bool ok = writeAll(tail.data(), tail.size());
+  if (ok && fsync(fd) != 0) {
+    Logger::error("Cannot sync " + tempPath + ": " + strerror(errno));
+    ok = false;
+  }
+  ::close(fd);
+  fd = -1;
+
+  if (ok && rename(tempPath.c_str(), path.c_str()) != 0) {
+    Logger::error("Cannot rename " + tempPath + " to " + path + ": " + strerror(errno));
+    ok = false;
+  }
+  if (!ok) unlink(tempPath.c_str());
+  return ok;
+}
+
+/** @brief Close and remove an unfinished file. */
+void KvSnapshotWriter::abort() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (fd < 0) return;
+  ::close(fd);
+  fd = -1;
+  unlink(tempPath.c_str());
+}
+
+/** @brief Append one length-prefixed record to a block under construction. */
+void KvSnapshotWriter::appendRecord(std::string& block, std::string_view key, std::string_view value) {
+  char header[snapshot::RECORD_HEADER_SIZE];
+  put_u32(header, static_cast<uint32_t>(key.size()));
+  put_u32(header + 4, static_cast<uint32_t>(value.size()));
+  block.append(header, sizeof(header));
+  block.append(key);
+  block.append(value);
+}
+
+/** @brief Records written so far. */
+uint64_t KvSnapshotWriter::records() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return recordCount;
+}
+
+/** @brief Bytes written so far. */
+uint64_t KvSnapshotWriter::bytes() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return offset;
+}
+
+// ---------------------------------------------------
+// @INFO KvSnapshotReader
+// ---------------------------------------------------
+
+// Constructor
+KvSnapshotReader::KvSnapshotReader() : recordCount(0) {}
+
+/**
+ * @brief Check the header, trailer and index, and locate every block.
+ *
+ * @param data  Whole snapshot file; must outlive the reader.
+ * @param error Set when the file is not a complete, intact snapshot.
+ * @return False if the file cannot be used.
+ */
+bool KvSnapshotReader::open(std::string_view data, std::string& error) {
+  blocks.clear();
+  recordCount = 0;
+
+  if (!snapshot::is_snapshot(data)) {
+    error = "not a snapshot file";
+    return false;
+  }
+  if (data.size() < snapshot::MAGIC.size() + snapshot::TRAILER_SIZE ||
+      data.substr(data.size() - snapshot::TRAILER_MAGIC.size()) != snapshot::TRAILER_MAGIC) {
+    error = "snapshot is truncated (no trailer)";
+    return false;
+  }
+
+  const char* trailer = data.data() + data.size() - snapshot::TRAILER_SIZE;
+  uint64_t index_offset = get_u64(trailer);
+  uint64_t records = get_u64(trailer + 8);
+  uint32_t count = get_u32(trailer + 16);
+  uint32_t index_crc = get_u32(trailer + 20);
+
+  uint64_t index_end = data.size() - snapshot::TRAILER_SIZE;
+  if (index_offset < snapshot::MAGIC.size() || index_offset > index_end ||
+      index_end - index_offset != static_cast<uint64_t>(count) * snapshot::INDEX_ENTRY_SIZE) {
+    error = "snapshot index is out of bounds";
+    return false;
+  }
+  if (snapshot::crc32c(data.data() + index_offset, index_end - index_offset) != index_crc) {
+    error = "snapshot index checksum mismatch";
+    return false;
+  }
+
+  uint64_t total = 0;
+  for (uint32_t i = 0; i < count; ++i) {
+    const char* entry = data.data() + index_offset + i * snapshot::INDEX_ENTRY_SIZE;
+    uint64_t offset = get_u64(entry);
+    uint64_t length = get_u64(entry + 8);
+    if (offset < snapshot::MAGIC.size() || offset > index_offset || length > index_offset - offset) {
+      error = "snapshot block " + std::to_string(i) + " is out of bounds";
+      return false;
+    }
+    blocks.push_back({data.substr(offset, length), get_u32(entry + 16), get_u32(entry + 20)});
+    total += blocks.back().records;
+  }
+
+  if (total != records) {
+    error = "snapshot index lists " + std::to_string(total) + " records, trailer says " + std::to_string(records);
+    return false;
+  }
+  recordCount = records;
+  return true;
+}
+
+/**
+ * @brief Records of a block, after checking its checksum.
+ *
+ * @param index   Block number.
+ * @param records Output block bytes, to be walked with nextRecord().
+ * @param error   Set on a checksum mismatch.
+ * @return False if the block is damaged.
+ */
+bool KvSnapshotReader::block(size_t index, std::string_view& records, std::string& error) const {
+  const Block& block = blocks[index];
+  if (snapshot::crc32c(block.data.data(), block.data.size()) != block.crc) {
+    error = "snapshot block " + std::to_string(index) + " checksum mismatch";
+    return false;
+  }
+  records = block.data;
+  return true;
+}
+
+/**
+ * @brief Take the next record off the front of a block.
+ *
+ * @param records Remaining block bytes; advanced past the record.
+ * @param key     Output key.
+ * @param value   Output value.
+ * @return False if the block ends inside a record.
+ */
+bool KvSnapshotReader::nextRecord(std::string_view& records, std::string_view& key, std::string_view& value) {
+  if (records.size() < snapshot::RECORD_HEADER_SIZE) return false;
+  uint64_t key_size = get_u32(records.data());
+  uint64_t value_size = get_u32(records.data() + 4);
+  if (records.size() - snapshot::RECORD_HEADER_SIZE < key_size + value_size) return false;
+
+  key = records.substr(snapshot::RECORD_HEADER_SIZE, key_size);
+  value = records.substr(snapshot::RECORD_HEADER_SIZE + key_size, value_size);
+  records.remove_prefix(snapshot::RECORD_HEADER_SIZE + key_size + value_size);
+  return true;
+}
+
+/** @brief Number of blocks. */
+size_t KvSnapshotReader::blockCount() const {
+  return blocks.size();
+}
+
+/** @brief Records in a block according to the index. */
+uint32_t KvSnapshotReader::blockRecords(size_t index) const {
+  return blocks[index].records;
+}
+
+/** @brief Records in the whole snapshot. */
+uint64_t KvSnapshotReader::records() const {
+  return recordCount;
+}
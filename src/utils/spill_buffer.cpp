@@ -0,0 +1,179 @@
+/**
+ * @file spill_buffer.cpp
+ * @brief KvSpillBuffer method implementations.
+ */
+
+#include "include/spill_buffer.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "include/logger.hpp"
+
+namespace {
+
+/** @brief Heap bytes a buffer may hold before it spills (0 = no limit). */
+std::atomic<size_t> g_limit(0);
+
+/** @brief Set once a failed spill has been reported. */
+std::atomic<bool> g_warned(false);
+
+/**
+ * @brief Create an already unlinked file in $TMPDIR or /tmp.
+ *
+ * @return Descriptor, or -1 with errno set.
+ */
+int open_spill_file() {
+  const char* dir = std::getenv("TMPDIR");
+  std::string path = std::string(dir != nullptr && *dir != '\0' ? dir : "/tmp") + "/kvcli-reply-XXXXXX";
+  int fd = mkostemp(path.data(), O_CLOEXEC);
+  if (fd >= 0) unlink(path.c_str());
+  return fd;
+}
+
+}  // namespace
+
+// Constructor
+KvSpillBuffer::KvSpillBuffer(size_t size) : memory(size), mapping(nullptr), mapped(0), fd(-1) {}
+
+// Copy constructor
+KvSpillBuffer::KvSpillBuffer(const KvSpillBuffer& other) : mapping(nullptr), mapped(0), fd(-1) {
+  *this = other;
+}
+
+// Copy assignment
+KvSpillBuffer& KvSpillBuffer::operator=(const KvSpillBuffer& other) {
+  if (this != &other) {
+    resize(other.size());
+    if (other.size() > 0) std::memcpy(data(), other.data(), other.size());
+  }
+  return *this;
+}
+
+// Destructor
+KvSpillBuffer::~KvSpillBuffer() {
+  if (mapping != nullptr) munmap(mapping, mapped);
+  if (fd >= 0) close(fd);
+}
+
+/**
+ * @brief Move the contents into the spill file, or resize the file.
+ *
+ * Blocks are reserved with posix_fallocate before they are mapped, so a
+ * full disk fails here rather than with SIGBUS on a later write.
+ *
+ * @param size New size in bytes.
+ * @return False, with errno set, if the file could not be made that large.
+ */
+bool KvSpillBuffer::spill(size_t size) {
+  if (mapping != nullptr) {
+    int error = size > mapped ? posix_fallocate(fd, static_cast<off_t>(mapped), static_cast<off_t>(size - mapped)) : ftruncate(fd, static_cast<off_t>(size));
+    if (error != 0) {
+      if (error > 0) errno = error;
+      return false;
+    }
+    void* moved = mremap(mapping, mapped, size, MREMAP_MAYMOVE);
+    if (moved == MAP_FAILED) return false;
+    mapping = static_cast<char*>(moved);
+    mapped = size;
+    return true;
+  }
+
+  int file = open_spill_file();
+  if (file < 0) return false;
+  int error = posix_fallocate(file, 0, static_cast<off_t>(size));
+  void* region = error == 0 ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0) : MAP_FAILED;
+  if (region == MAP_FAILED) {
+    if (error != 0) errno = error;
+    int saved = errno;
+    close(file);
+    errno = saved;
+    return false;
+  }
+
+  std::memcpy(region, memory.data(), std::min(size, memory.size()));
+  std::vector<char>().swap(memory);
+  mapping = static_cast<char*>(region);
+  mapped = size;
+  fd = file;
+  KV_LOG(DEBUG, "Receive buffer spilled to a temporary file at " + std::to_string(size) + " bytes");
+  return true;
+}
+
+/** @brief Copy the first `size` bytes back to the heap and drop the file. */
+void KvSpillBuffer::unspill(size_t size) {
+  std::vector<char> heap(size);
+  std::memcpy(heap.data(), mapping, std::min(size, mapped));
+  munmap(mapping, mapped);
+  close(fd);
+  mapping = nullptr;
+  mapped = 0;
+  fd = -1;
+  memory.swap(heap);
+}
+
+/** @brief Start of the contents; invalidated by resize(). */
+char* KvSpillBuffer::data() {
+  return mapping != nullptr ? mapping : memory.data();
+}
+
+/** @copydoc KvSpillBuffer::data() */
+const char* KvSpillBuffer::data() const {
+  return mapping != nullptr ? mapping : memory.data();
+}
+
+/** @brief Size in bytes. */
+size_t KvSpillBuffer::size() const {
+  return mapping != nullptr ? mapped : memory.size();
+}
+
+/**
+ * @brief Grow or shrink, keeping the first min(old, new) bytes.
+ *
+ * Shrinking on the heap releases the memory, not just the size.
+ *
+ * @param size New size in bytes.
+ */
+void KvSpillBuffer::resize(size_t size) {
+  size_t cap = limit();
+  if (cap > 0 && size > cap) {
+    if (spill(size)) return;
+    if (!g_warned.exchange(true)) {
+      Logger::warn("Cannot spill a large reply to a temporary file (" + std::string(strerror(errno)) + "); keeping it in memory");
+    }
+  }
+
+  if (mapping != nullptr) {
+    unspill(size);
+  } else if (size < memory.size()) {
+    std::vector<char> smaller(size);
+    std::memcpy(smaller.data(), memory.data(), size);
+    memory.swap(smaller);
+  } else {
+    memory.resize(size);
+  }
+}
+
+/**
+ * @brief Set the heap bytes a buffer may hold before it spills.
+ *
+ * Applies to every buffer's next resize().
+ *
+ * @param bytes Limit in bytes (0 = never spill).
+ */
+void KvSpillBuffer::setLimit(size_t bytes) {
+  g_limit.store(bytes, std::memory_order_relaxed);
+}
+
+/** @brief The current limit (0 = never spill). */
+size_t KvSpillBuffer::limit() {
+  return g_limit.load(std::memory_order_relaxed);
+}
@@ -6,40 +6,104 @@
 #include "include/client.hpp"
 #include "include/utils.hpp"
 
+#include <cctype>
+#include <charconv>
+
 namespace network {
 
+namespace {
+
+/** @brief `\w` of the old regex: ASCII letters, digits and underscore. */
+bool is_word(char c) {
+  return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+/** @brief Strip `prefix` from the front of `text`. */
+bool consume(std::string_view& text, std::string_view prefix) {
+  if (text.substr(0, prefix.size()) != prefix) return false;
+  text.remove_prefix(prefix.size());
+  return true;
+}
+
+/**
+ * @brief Strip an optional `user:password@` (both `\w+`) from the front.
+ *
+ * Leaves `text` and the credentials untouched if it is not there.
+ */
+void consume_credentials(std::string_view& text, KvConnectionInfo& info) {
+  size_t colon = 0;
+  while (colon < text.size() && is_word(text[colon])) ++colon;
+  if (colon == 0 || colon == text.size() || text[colon] != ':') return;
+
+  size_t at = colon + 1;
+  while (at < text.size() && is_word(text[at])) ++at;
+  if (at == colon + 1 || at == text.size() || text[at] != '@') return;
+
+  info.user = std::string(text.substr(0, colon));
+  info.password = std::string(text.substr(colon + 1, at - colon - 1));
+  text.remove_prefix(at + 1);
+}
+
+}  // namespace
+
 /**
  * @brief Parses a KV connection URI into host, port, and optional credentials.
  *
- * Uses regex to extract user, password, host, and port.
+ * A hand-written scanner; compiling a std::regex on every start cost more
+ * than the rest of argument parsing. IPv6 literals are written in
+ * brackets, e.g. kv://[::1]:6379. unix:///path/to.sock (optionally with
+ * user:password@ before the path) selects a Unix domain socket instead.
  * Converts "localhost" to "127.0.0.1".
  *
  * @param uri  Connection URI string.
- * @param info KvConnectionInfo to populate.
+ * @param info KvConnectionInfo to populate; untouched on failure.
  * @return True if URI matched expected pattern; false otherwise.
  */
 bool parse_connection_uri(const std::string& uri, KvConnectionInfo& info) {
-  // @INFO Regular expression to match the connection URI
-  std::regex uri_regex(R"(kv://(?:(\w+):(\w+)@)?([^:]+):(\d+))");
-  std::smatch match;
-
-  if (std::regex_match(uri, match, uri_regex)) {
-    if (match.size() == 5) {
-      info.user = match[1].str();
-      info.password = match[2].str();
-
-      // @INFO convert localhost to an actual IPv4 address
-      if (match[3].str() == "localhost") {
-        info.host = "127.0.0.1";
-      } else {
-        info.host = match[3].str();
-      }
-
-      info.port = std::stoi(match[4].str());
-      return true;
+  KvConnectionInfo parsed;
+  std::string_view rest(uri);
+
+  // @INFO unix:///path/to.sock selects a Unix domain socket
+  if (consume(rest, "unix://")) {
+    consume_credentials(rest, parsed);
+    if (rest.size() < 2 || rest.front() != '/') return false;
+    info.user = parsed.user;
+    info.password = parsed.password;
+    info.socketPath = std::string(rest);
+    return true;
+  }
+
+  if (!consume(rest, "kv://")) return false;
+  consume_credentials(rest, parsed);
+
+  // @INFO host is a bracketed IPv6 literal or anything without : [ ]
+  std::string_view host;
+  if (!rest.empty() && rest.front() == '[') {
+    size_t close = rest.find(']');
+    if (close == std::string_view::npos || close == 1) return false;
+    for (char c : rest.substr(1, close - 1)) {
+      if (!std::isxdigit(static_cast<unsigned char>(c)) && c != ':' && c != '.') return false;
     }
+    host = rest.substr(1, close - 1);
+    rest.remove_prefix(close + 1);
+  } else {
+    size_t end = rest.find_first_of(":[]");
+    if (end == 0 || end == std::string_view::npos) return false;
+    host = rest.substr(0, end);
+    rest.remove_prefix(end);
   }
 
-  return false;
+  // @INFO :port, digits only, to the end
+  if (!consume(rest, ":") || rest.empty()) return false;
+  int port = 0;
+  auto result = std::from_chars(rest.data(), rest.data() + rest.size(), port);
+  if (result.ec != std::errc() || result.ptr != rest.data() + rest.size() || rest.front() == '-' || rest.front() == '+') return false;
+
+  info.user = parsed.user;
+  info.password = parsed.password;
+  // @INFO convert localhost to an actual IPv4 address
+  info.host = host == "localhost" ? "127.0.0.1" : std::string(host);
+  info.port = port;
+  return true;
 }
 }  // namespace network
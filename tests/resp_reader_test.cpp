@@ -0,0 +1,81 @@
+/**
+ * @file resp_reader_test.cpp
+ * @brief Regression checks for resp::Reader::next() and resp::scan_frame().
+ *
+ * Each case feeds one input to both splitters and compares the status.
+ * Exits 1 if any case fails; run through ctest.
+ */
+
+#include <iostream>
+#include <string>
+
+#include "include/resp_reader.hpp"
+
+namespace {
+
+using Status = resp::Reader::Status;
+
+/** @brief Name of a status, for failure messages. */
+const char* status_name(Status status) {
+  switch (status) {
+    case Status::COMPLETE:
+      return "COMPLETE";
+    case Status::INCOMPLETE:
+      return "INCOMPLETE";
+    default:
+      return "PROTOCOL_ERROR";
+  }
+}
+
+/** @brief One input and the status both splitters must return for it. */
+struct Case {
+  const char* name;
+  std::string input;
+  Status expected;
+};
+
+/** @brief Run `c` through Reader::next() and scan_frame(); false on a mismatch. */
+bool check(const Case& c) {
+  bool ok = true;
+
+  resp::Reader reader;
+  reader.feed(c.input.data(), c.input.size());
+  std::string_view frame;
+  Status streamed = reader.next(frame);
+  if (streamed != c.expected || (streamed == Status::COMPLETE && frame.size() != c.input.size())) {
+    std::cerr << "FAIL " << c.name << ": Reader::next returned " << status_name(streamed) << ", expected " << status_name(c.expected) << '\n';
+    ok = false;
+  }
+
+  size_t length = 0;
+  Status scanned = resp::scan_frame(c.input, length);
+  if (scanned != c.expected || (scanned == Status::COMPLETE && length != c.input.size())) {
+    std::cerr << "FAIL " << c.name << ": scan_frame returned " << status_name(scanned) << ", expected " << status_name(c.expected) << '\n';
+    ok = false;
+  }
+
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  const Case cases[] = {
+      {"small integer", ":5\r\n", Status::COMPLETE},
+      {"integer above MAX_LENGTH", ":1000000000\r\n", Status::COMPLETE},
+      {"large negative integer", ":-9000000000\r\n", Status::COMPLETE},
+      {"large integer in an array", "*2\r\n:1\r\n:600000000\r\n", Status::COMPLETE},
+      {"bulk length above MAX_LENGTH", "$900000000000000000\r\n", Status::PROTOCOL_ERROR},
+      {"array count above MAX_LENGTH", "*600000000\r\n", Status::PROTOCOL_ERROR},
+      {"map count above MAX_LENGTH", "%600000000\r\n", Status::PROTOCOL_ERROR},
+      {"bulk body still arriving", "$5\r\nhel", Status::INCOMPLETE},
+  };
+
+  int failures = 0;
+  for (const Case& c : cases) {
+    if (!check(c)) ++failures;
+  }
+
+  std::cout << (sizeof(cases) / sizeof(cases[0])) - failures << "/" << sizeof(cases) / sizeof(cases[0]) << " cases passed" << std::endl;
+  return failures == 0 ? 0 : 1;
+}